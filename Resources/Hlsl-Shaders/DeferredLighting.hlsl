@@ -11,10 +11,16 @@
 [[vk::binding(8, 0)]] SamplerState TexSampler;
 [[vk::binding(9, 0)]] SamplerState EnvMapSampler;
 [[vk::binding(10, 0)]] StructuredBuffer<SceneLightGPUData> LightsBuffer;
+[[vk::binding(11, 0)]] StructuredBuffer<uint2> ClusterRangesBuffer;
+[[vk::binding(12, 0)]] StructuredBuffer<uint> ClusterLightIndicesBuffer;
 
 struct LightingConstants {
 
     uint EnvMapNumMips;
+    uint ClusterTilesX;
+    uint ClusterTilesY;
+    float ClusterSliceScale;
+    float ClusterSliceBias;
     float Padding0[3];
 }; [[vk::push_constant]] LightingConstants Resources;
 
@@ -29,6 +35,19 @@ float3 DepthToWorld(float2 screenPos, float depth) {
     return worldSpacePos.xyz;
 }
 
+// same layout as LightClusterGrid, slices follow the log of the view depth
+uint GetClusterIndex(float2 pixel, float3 position) {
+
+    float viewDepth = -mul(SceneDataBuffer.View, float4(position, 1.0f)).z;
+    float slice = floor(log2(max(viewDepth, 0.0001f)) * Resources.ClusterSliceScale + Resources.ClusterSliceBias);
+
+    uint z = uint(clamp(slice, 0.0f, float(LIGHT_CLUSTER_SLICES - 1)));
+    uint x = min(uint(pixel.x) / LIGHT_CLUSTER_TILE_SIZE, Resources.ClusterTilesX - 1);
+    uint y = min(uint(pixel.y) / LIGHT_CLUSTER_TILE_SIZE, Resources.ClusterTilesY - 1);
+
+    return (z * Resources.ClusterTilesY + y) * Resources.ClusterTilesX + x;
+}
+
 struct Material
 {
     float3 Albedo;
@@ -243,9 +262,12 @@ float4 PSMain(VSOutput input) : SV_TARGET0 {
 
     float3 color = GetIBLcontribution(pbrInfo, iblInfo, material);
     color += CalculateSunLight(normal, view, material, pbrInfo);
-    for (uint i = 0u; i < SceneDataBuffer.LightsCount; i++) {
 
-        SceneLightGPUData light = LightsBuffer[i];
+    // only lights binned into the pixel's cluster can reach it
+    uint2 range = ClusterRangesBuffer[GetClusterIndex(input.VertexPos.xy, position)];
+    for (uint i = 0u; i < range.y; i++) {
+
+        SceneLightGPUData light = LightsBuffer[ClusterLightIndicesBuffer[range.x + i]];
         color += CalculatePointLight(light, normal, view, material, pbrInfo, position);
     }
 
@@ -27,29 +27,33 @@ struct VSOutput {
 };
 
 VSOutput VSMain(VSInput input) {
-    SceneObjectGPUData objectData = ObjectsBuffer[input.InstanceID];
+    // instance ids start at the group's offset into the compacted visible list
+    SceneObjectGPUData objectData = ObjectsBuffer[VisibleInstancesBuffer[input.InstanceID]];
+    SceneInstanceGroupGPUData groupData = GroupsBuffer[objectData.GroupIndex];
 
-    uint vIndex = vk::RawBufferLoad<uint>(objectData.IndexBufferAddress + ((input.VertexIndex + objectData.FirstIndex) * sizeof(uint)), 4);
-    Vertex v = vk::RawBufferLoad<Vertex>(objectData.VertexBufferAddress + (vIndex * sizeof(Vertex)), 8);
+    // vertex ids start at the first index of the lod the command draws
+    uint vIndex = vk::RawBufferLoad<uint>(groupData.IndexBufferAddress + (input.VertexIndex * sizeof(uint)), 4);
+    Vertex v = vk::RawBufferLoad<Vertex>(groupData.VertexBufferAddress + (vIndex * sizeof(Vertex)), 8);
 
     VSOutput output;
 
-    float4 fragPos = mul(objectData.GlobalTransform, float4(v.Position[0], v.Position[1], v.Position[2], 1.0f));
-    output.VertexPos = mul(SceneDataBuffer.ViewProj, fragPos);
+    float3x4 transform = GetObjectTransform(objectData);
+    float3 fragPos = mul(transform, float4(v.Position[0], v.Position[1], v.Position[2], 1.0f));
+    output.VertexPos = mul(SceneDataBuffer.ViewProj, float4(fragPos, 1.0f));
     output.TexCoord = v.UV0;
 
-    float4x4 transposeInverseTransform = transpose(objectData.InverseTransform);
+    float3x3 normalMatrix = GetObjectNormalMatrix(transform);
 
     float4 unpackedTan = UnpackHalfToSignedVec4(v.Tangent);
     float4 unpackedNormal = UnpackHalfToSignedVec4(v.Normal);
 
-    float3 tangent = normalize(mul(transposeInverseTransform, float4(unpackedTan.xyz, 0.0f)).xyz);
-    output.Normal = normalize(mul(transposeInverseTransform, float4(unpackedNormal.xyz, 0.0f)).xyz);
+    float3 tangent = normalize(mul(normalMatrix, unpackedTan.xyz));
+    output.Normal = normalize(mul(normalMatrix, unpackedNormal.xyz));
     tangent = normalize(tangent - dot(tangent, output.Normal) * output.Normal);
 
     output.Tangent = float4(tangent, unpackedTan.w);
     output.Color = UnpackUintToUnsignedVec4(v.Color);
-    output.MaterialDataIndex = objectData.MaterialBufferIndex;
+    output.MaterialDataIndex = groupData.MaterialBufferIndex;
 
     return output;
 }
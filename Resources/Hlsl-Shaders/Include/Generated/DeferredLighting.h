@@ -1,4 +1,8 @@
 struct alignas(16) DeferredLightingPushData {
     uint32_t EnvMapNumMips;
+    uint32_t ClusterTilesX;
+    uint32_t ClusterTilesY;
+    float ClusterSliceScale;
+    float ClusterSliceBias;
     float Padding0[3];
 };
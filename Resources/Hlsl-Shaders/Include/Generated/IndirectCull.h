@@ -1,6 +1,14 @@
 struct alignas(16) IndirectCullPushData {
     uint32_t IsPrepass;
-    uint32_t PyramidSize;
-    float CullZNear;
+    uint32_t Stage;
+    uint32_t ObjectsCount;
+    uint32_t GroupsCount;
+    uint32_t InstancesStride;
+    uint32_t GroupLodsStride;
+    uint32_t VisibilityStride;
+    uint32_t DrawCountsStride;
+    uint32_t MeshletCommandsStride;
+    uint32_t MeshletVisibilityStride;
+    uint32_t BatchesCapacity;
     float Padding0;
 };
@@ -0,0 +1,6 @@
+struct alignas(16) LightClustersPushData {
+    Vec4 ViewRows[3];
+    uint32_t TilesXY;
+    uint32_t MaxLightIndices;
+    float Padding0[2];
+};
@@ -0,0 +1,6 @@
+struct alignas(16) SceneScatterPushData {
+    uint32_t RecordCount;
+    uint32_t RecordWords;
+    uint32_t PayloadOffset;
+    uint32_t ThreadStride;
+};
@@ -8,24 +8,90 @@ struct DrawIndirectCommand {
 	uint FirstInstance; 
 };
 
+// a view of the shared cull pass, mirrors ViewCullGPUData
+struct CullViewGPUData {
+
+	float4x4 View;
+	float4 CameraPos;
+	float4 FrustumPlanes[6];
+
+	float P00;
+	float P11;
+	float CullZNear;
+	float LodErrorScale;
+
+	uint PyramidSize;
+	uint ViewMask;
+	uint ViewIndex;
+	float Padding0;
+};
+
+#define MAX_RENDER_VIEWS 4u
+
 [[vk::binding(0, 0)]] RWStructuredBuffer<DrawIndirectCommand> DrawCommandsBuffer;
 [[vk::binding(1, 0)]] RWByteAddressBuffer DrawCountsBuffer;
 [[vk::binding(2, 0)]] StructuredBuffer<uint> BatchOffsetsBuffer;
 [[vk::binding(3, 0)]] RWStructuredBuffer<uint> VisibilityBuffer;
 //[[vk::binding(4, 0)]] RWStructuredBuffer<uint> CurrentVisibilityBuffer;
-[[vk::binding(4, 0)]] Texture2D<float> DepthPyramid;
+[[vk::binding(4, 0)]] Texture2D<float> DepthPyramids[MAX_RENDER_VIEWS];
 [[vk::binding(5, 0)]] SamplerState PyramidSampler;
 [[vk::binding(6, 0)]] StructuredBuffer<SceneObjectGPUData> ObjectsBuffer;
-[[vk::binding(7, 0)]] ConstantBuffer<SceneGPUData> SceneDataBuffer;
+[[vk::binding(7, 0)]] StructuredBuffer<CullViewGPUData> ViewsBuffer;
+[[vk::binding(8, 0)]] StructuredBuffer<SceneInstanceGroupGPUData> GroupsBuffer;
+[[vk::binding(9, 0)]] RWStructuredBuffer<uint> GroupCountsBuffer;
+[[vk::binding(10, 0)]] RWStructuredBuffer<uint> VisibleInstancesBuffer;
+[[vk::binding(11, 0)]] RWStructuredBuffer<uint> InstanceSlotsBuffer;
+[[vk::binding(12, 0)]] RWStructuredBuffer<DrawIndirectCommand> MeshletCommandsBuffer;
+[[vk::binding(13, 0)]] RWStructuredBuffer<uint> MeshletQueueBuffer;
+[[vk::binding(14, 0)]] RWByteAddressBuffer MeshletDispatchBuffer;
+[[vk::binding(15, 0)]] RWStructuredBuffer<uint> MeshletVisibilityBuffer;
 
 struct CullConstants {
 
 	uint IsPrepass;
-	uint PyramidSize;
-	float CullZNear;
+	uint Stage;
+	uint ObjectsCount;
+	uint GroupsCount;
+
+	// sizes of a view's slice in the per view buffers
+	uint InstancesStride;
+	uint GroupLodsStride;
+	uint VisibilityStride;
+	uint DrawCountsStride;
+	uint MeshletCommandsStride;
+	uint MeshletVisibilityStride;
+
+	// meshlet draws of a batch come after all whole draws in the batch offsets and in the draw counts
+	uint BatchesCapacity;
 	float Padding0;
 }; [[vk::push_constant]] CullConstants Resources;
 
+#define STAGE_CULL 0u // culls instances and picks their lods
+#define STAGE_EMIT 1u // one draw command per group and lod with visible instances
+#define STAGE_COMPACT 2u // writes visible instances into the ranges of their commands
+#define STAGE_MESHLETS 3u // culls the meshlets of queued instances, a dispatch group per instance
+
+#define CULL_GROUP_SIZE 256u
+
+// visibility keeps the lod in the bits above the visible one
+#define VISIBILITY_LOD_SHIFT 1u
+
+// lod and the place within the group's lod, an instance slot per object
+#define INVALID_INSTANCE_SLOT 0xFFFFFFFFu
+#define SLOT_LOD_SHIFT 24u
+#define SLOT_INDEX_MASK 0x00FFFFFFu
+#define SLOT_LOD_MASK 0x7Fu
+
+// the instance was drawn by the prepass, its meshlets visible last frame are drawn already, kept in its meshlet queue entry
+#define SLOT_PREPASS_BIT 0x80000000u
+
+// dispatch arguments of the meshlet stage, then the queue size of every view
+#define MESHLET_QUEUE_COUNTS_OFFSET 16u
+#define MAX_MESHLET_DISPATCH_GROUPS 65535u
+
+// a lod is only switched once its error is clearly under or over a pixel, objects at the boundary don't flicker
+#define LOD_HYSTERESIS 0.25f
+
 // 2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere
 // https://jcgt.org/published/0002/02/05/
 bool TryCalculateSphereBounds(float3 center, float radius, float zNear, float P00, float P11, out float4 AABB)
@@ -52,90 +118,323 @@ bool TryCalculateSphereBounds(float3 center, float radius, float zNear, float P0
 	return true;
 }
 
-bool IsVisible(uint objectID, bool prepass) {
-	SceneObjectGPUData objectData = ObjectsBuffer[objectID];
+void GetWorldBounds(SceneObjectGPUData objectData, SceneInstanceGroupGPUData groupData, out float3 boundsCenter, out float boundsRadius) {
+	float3x4 transform = GetObjectTransform(objectData);
+
+	boundsCenter = mul(transform, float4(groupData.BoundsOrigin.xyz, 1.f));
+
+	// the radius grows with the largest axis scale
+	float3 scaleSq = float3(
+		dot(transform._m00_m10_m20, transform._m00_m10_m20),
+		dot(transform._m01_m11_m21, transform._m01_m11_m21),
+		dot(transform._m02_m12_m22, transform._m02_m12_m22));
+	boundsRadius = groupData.BoundsOrigin.w * sqrt(max(scaleSq.x, max(scaleSq.y, scaleSq.z)));
+}
+
+bool IsInFrustum(CullViewGPUData view, float3 center, float radius) {
+	for (uint i = 0u; i < 6u; i++) {
+
+		float4 plane = view.FrustumPlanes[i];
+		float d = dot(plane.xyz, center) + plane.w;
+
+		if (d < -radius) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// tests the sphere against the depth pyramid of the view, spheres crossing the near plane are never occluded
+bool IsOccluded(CullViewGPUData view, uint viewSlot, float3 center, float radius) {
+	float3 centerViewSpace = mul(view.View, float4(center, 1.0f)).xyz;
+	float zNear = view.CullZNear;
+	float4 AABB;
+
+	if (TryCalculateSphereBounds(centerViewSpace, radius, zNear, view.P00, view.P11, AABB))
+	{
+		float boundsWidth = (AABB.z - AABB.x) * float(view.PyramidSize);
+		float boundsHeight = (AABB.w - AABB.y) * float(view.PyramidSize);
+		float mipIndex = floor(log2(max(boundsWidth, boundsHeight)));
 
-	float3 boundsCenter = objectData.BoundsOrigin.xyz;
-	boundsCenter = mul(objectData.GlobalTransform, float4(boundsCenter, 1.f)).xyz;
-	float boundsRadius = objectData.BoundsOrigin.w;
+		// the slot is the same for the whole dispatch row
+		float occluderDepth = DepthPyramids[viewSlot].SampleLevel(PyramidSampler, 0.5f * (AABB.xy + AABB.zw), mipIndex).x;
+		float nearestBoundsDepth = zNear / (-centerViewSpace.z - radius);
 
-    uint lastVisibility = VisibilityBuffer[objectData.VisibilityIdx];
-	bool visible = prepass ? lastVisibility == 1 : true;
+		const float eps = 0.000025f;
+		return occluderDepth >= nearestBoundsDepth + eps;
+	}
+
+	return false;
+}
+
+bool IsVisible(CullViewGPUData view, uint viewSlot, SceneObjectGPUData objectData, float3 boundsCenter, float boundsRadius, bool prepass) {
+    uint lastVisibility = VisibilityBuffer[view.ViewIndex * Resources.VisibilityStride + objectData.VisibilityIdx];
+	bool visible = prepass ? (lastVisibility & 1u) == 1u : true;
+
+	// instances outside of the view's layers are never drawn by it
+	if ((objectData.LayerMask & view.ViewMask) == 0) {
+		visible = false;
+	}
 
 	if (visible) {
+		visible = IsInFrustum(view, boundsCenter, boundsRadius);
+	}
+
+	// occlusion culling
+	if (!prepass && visible) {
+		visible = !IsOccluded(view, viewSlot, boundsCenter, boundsRadius);
+	}
+
+	return visible;
+}
+
+// the finest lod of groups with meshlets is drawn by the meshlet stage instead of a command of its own
+bool UsesMeshlets(SceneInstanceGroupGPUData groupData, uint lod) {
+	return lod == 0 && groupData.MeshletCount > 0;
+}
 
-		for (uint i = 0u; i < 6u; i++) {
+// every triangle of the meshlet faces away from the camera, see MeshUtils::ClusterBounds
+bool IsConeBackFacing(float3 cameraPos, float3 center, float radius, float3 axis, float cutoff) {
+	float3 offset = center - cameraPos;
+	return dot(offset, axis) >= cutoff * (length(offset) + radius) + radius;
+}
 
-		    float4 plane = SceneDataBuffer.FrustumPlanes[i];
-		    float d = dot(plane.xyz, boundsCenter) + plane.w;
+// starts from last frame's lod, errors are projected with the sphere size and compared in pixels
+uint SelectLod(CullViewGPUData view, SceneInstanceGroupGPUData groupData, float3 boundsCenter, float boundsRadius, uint lastLod) {
+	float distance = max(length(boundsCenter - view.CameraPos.xyz), 0.0001f);
+	// P11 is negative with the flipped y of the projection
+	float screenSize = boundsRadius / distance * abs(view.P11);
+	float errorScale = screenSize * view.LodErrorScale;
 
-		    if (d < -boundsRadius) {
+	uint lod = min(lastLod, groupData.LodCount - 1);
 
-			    visible = false;
-			    break;
-		    } 
+	while (lod + 1 < groupData.LodCount && groupData.LodErrors[lod + 1] * errorScale < 1.f - LOD_HYSTERESIS) {
+		lod++;
+	}
+	while (lod > 0 && groupData.LodErrors[lod] * errorScale > 1.f + LOD_HYSTERESIS) {
+		lod--;
+	}
+
+	return lod;
+}
+
+void EmitGroupCommands(CullViewGPUData view, uint groupIndex) {
+	SceneInstanceGroupGPUData groupData = GroupsBuffer[groupIndex];
+
+	bool hasBatch = groupData.DrawBatchID != INVALID_BATCH_INDEX;
+	uint batchOffset = hasBatch ? BatchOffsetsBuffer[groupData.DrawBatchID] : 0;
+
+	// lods split the group's instance range in their order, ranges of a view are within its slice
+	uint instanceOffset = view.ViewIndex * Resources.InstancesStride + groupData.InstanceOffset;
+	uint groupLodsOffset = view.ViewIndex * Resources.GroupLodsStride;
+
+	for (uint lod = 0; lod < groupData.LodCount; lod++) {
+		uint countIndex = groupLodsOffset + groupIndex * MESH_MAX_LODS + lod;
+		uint visibleCount = GroupCountsBuffer[countIndex];
+
+		// counts become offsets for the compaction stage
+		GroupCountsBuffer[countIndex] = instanceOffset;
+
+		if (visibleCount > 0 && hasBatch && !UsesMeshlets(groupData, lod)) {
+			uint localIndex;
+			DrawCountsBuffer.InterlockedAdd((view.ViewIndex * Resources.DrawCountsStride + groupData.DrawBatchID) * 4, 1, localIndex);
+
+			DrawIndirectCommand command;
+			command.VertexCount = groupData.LodIndexCount[lod];
+			command.InstanceCount = visibleCount;
+			command.FirstVertex = groupData.LodFirstIndex[lod];
+			command.FirstInstance = instanceOffset;
+
+			DrawCommandsBuffer[groupLodsOffset + batchOffset + localIndex] = command;
 		}
+
+		instanceOffset += visibleCount;
 	}
+}
 
-	// occlusion culling
-	if (!prepass) {
+void CullInstance(CullViewGPUData view, uint viewSlot, uint objectIndex) {
+	bool prepass = Resources.IsPrepass == 1;
+	SceneObjectGPUData objectData = ObjectsBuffer[objectIndex];
+
+	uint slotIndex = view.ViewIndex * Resources.InstancesStride + objectIndex;
+
+	// instances without a group aren't drawn, their visibility stays as it was
+	if (objectData.GroupIndex == INVALID_GROUP_INDEX) {
+		InstanceSlotsBuffer[slotIndex] = INVALID_INSTANCE_SLOT;
+		return;
+	}
+
+	SceneInstanceGroupGPUData groupData = GroupsBuffer[objectData.GroupIndex];
+
+	float3 boundsCenter;
+	float boundsRadius;
+	GetWorldBounds(objectData, groupData, boundsCenter, boundsRadius);
 
-		if (visible) {
+	bool visible = IsVisible(view, viewSlot, objectData, boundsCenter, boundsRadius, prepass);
 
-		    float3 centerViewSpace = mul(SceneDataBuffer.View, float4(boundsCenter, 1.0f)).xyz;
-		    float zNear = Resources.CullZNear;
-		    float4 AABB;
+	uint visibilityIndex = view.ViewIndex * Resources.VisibilityStride + objectData.VisibilityIdx;
+	uint lastVisibility = VisibilityBuffer[visibilityIndex];
+	bool lastVisible = (lastVisibility & 1u) == 1u;
 
-		    if (TryCalculateSphereBounds(centerViewSpace, boundsRadius, zNear, SceneDataBuffer.P00, SceneDataBuffer.P11, AABB))
-		    {
-			    float boundsWidth = (AABB.z - AABB.x) * float(Resources.PyramidSize);
-			    float boundsHeight = (AABB.w - AABB.y) * float(Resources.PyramidSize);
-			    float mipIndex = floor(log2(max(boundsWidth, boundsHeight)));
+	// both passes pick the same lod from last frame's one, only the second pass keeps it
+	uint lod = SelectLod(view, groupData, boundsCenter, boundsRadius, lastVisibility >> VISIBILITY_LOD_SHIFT);
 
-			    float occluderDepth = DepthPyramid.SampleLevel(PyramidSampler, 0.5f * (AABB.xy + AABB.zw), mipIndex).x;
-			    float nearestBoundsDepth = zNear / (-centerViewSpace.z - boundsRadius);
+	// instances drawn by meshlets go to the meshlet stage in both passes, it leaves out what the prepass drew
+	bool drawMesh = prepass ? visible : visible && (!lastVisible || UsesMeshlets(groupData, lod));
+	uint slot = INVALID_INSTANCE_SLOT;
 
-				const float eps = 0.000025f;
-			    bool bOcclusionCulled = occluderDepth >= nearestBoundsDepth + eps;
-			    visible = !bOcclusionCulled;
-		    }
-	    }
+	if (drawMesh) {
+		uint localIndex;
+		InterlockedAdd(GroupCountsBuffer[view.ViewIndex * Resources.GroupLodsStride + objectData.GroupIndex * MESH_MAX_LODS + lod], 1, localIndex);
+
+		slot = (lod << SLOT_LOD_SHIFT) | localIndex;
+		if (!prepass && lastVisible) {
+			slot |= SLOT_PREPASS_BIT;
+		}
 	}
 
-	return visible;
+	InstanceSlotsBuffer[slotIndex] = slot;
+
+	if (!prepass) {
+		VisibilityBuffer[visibilityIndex] = (lod << VISIBILITY_LOD_SHIFT) | (visible ? 1u : 0u);
+	}
 }
 
-[numthreads(256, 1, 1)]
-void CSMain(uint3 threadID : SV_DispatchThreadID) {
-    if (threadID.x < SceneDataBuffer.ObjectsCount) {
+void CompactInstance(CullViewGPUData view, uint viewSlot, uint objectIndex) {
+	uint slot = InstanceSlotsBuffer[view.ViewIndex * Resources.InstancesStride + objectIndex];
+	if (slot == INVALID_INSTANCE_SLOT) return;
 
-        bool prepass = Resources.IsPrepass == 1;
-        bool visible = IsVisible(threadID.x, prepass);
+	uint groupIndex = ObjectsBuffer[objectIndex].GroupIndex;
+	uint lod = (slot >> SLOT_LOD_SHIFT) & SLOT_LOD_MASK;
+	uint lodOffset = GroupCountsBuffer[view.ViewIndex * Resources.GroupLodsStride + groupIndex * MESH_MAX_LODS + lod];
 
-        uint localDataIndex = threadID.x;
-        SceneObjectGPUData objectData = ObjectsBuffer[localDataIndex];
+	uint visibleSlot = lodOffset + (slot & SLOT_INDEX_MASK);
+	VisibleInstancesBuffer[visibleSlot] = objectIndex;
 
-        uint lastVisibility = VisibilityBuffer[objectData.VisibilityIdx];
-        bool drawMesh = prepass ? visible : visible && lastVisibility == 0;
+	if (!UsesMeshlets(GroupsBuffer[groupIndex], lod)) return;
 
-        if (drawMesh) {
-            uint batchOffset = BatchOffsetsBuffer[objectData.DrawBatchID];
+	uint queueIndex;
+	MeshletDispatchBuffer.InterlockedAdd(MESHLET_QUEUE_COUNTS_OFFSET + view.ViewIndex * 4, 1, queueIndex);
+	MeshletQueueBuffer[view.ViewIndex * Resources.InstancesStride + queueIndex] = visibleSlot | (slot & SLOT_PREPASS_BIT);
 
-            uint localIndex;
-			DrawCountsBuffer.InterlockedAdd(objectData.DrawBatchID * 4, 1, localIndex);
-            uint localDrawCommandIndex = localIndex + batchOffset;
+	// a group per queued instance up to the dispatch limit, the groups loop over the rest, a row per view
+	MeshletDispatchBuffer.InterlockedMax(0, min(queueIndex + 1, MAX_MESHLET_DISPATCH_GROUPS));
+	MeshletDispatchBuffer.InterlockedMax(4, viewSlot + 1);
+	MeshletDispatchBuffer.InterlockedMax(8, 1);
+}
+
+// the prepass draws meshlets visible last frame, the second pass draws the rest of the visible ones and keeps their bits
+void CullMeshlets(CullViewGPUData view, uint viewSlot, uint queueIndex, uint threadIndex) {
+	bool prepass = Resources.IsPrepass == 1;
+
+	uint entry = MeshletQueueBuffer[view.ViewIndex * Resources.InstancesStride + queueIndex];
+	uint visibleSlot = entry & ~SLOT_PREPASS_BIT;
+	bool drawnInPrepass = (entry & SLOT_PREPASS_BIT) != 0;
+
+	SceneObjectGPUData objectData = ObjectsBuffer[VisibleInstancesBuffer[visibleSlot]];
+	SceneInstanceGroupGPUData groupData = GroupsBuffer[objectData.GroupIndex];
+
+	float3x4 transform = GetObjectTransform(objectData);
+	float3 scaleSq = float3(
+		dot(transform._m00_m10_m20, transform._m00_m10_m20),
+		dot(transform._m01_m11_m21, transform._m01_m11_m21),
+		dot(transform._m02_m12_m22, transform._m02_m12_m22));
+	float maxScale = sqrt(max(scaleSq.x, max(scaleSq.y, scaleSq.z)));
+
+	// cones only keep their angle under uniform scale, mirrored transforms flip the facing
+	float3x3 normalMatrix = GetObjectNormalMatrix(transform);
+	float determinant = dot(transform._m00_m10_m20, cross(transform._m01_m11_m21, transform._m02_m12_m22));
+	bool uniformScale = max(scaleSq.x, max(scaleSq.y, scaleSq.z)) - min(scaleSq.x, min(scaleSq.y, scaleSq.z)) <= 0.001f * scaleSq.x;
+	bool coneCulling = groupData.MeshletConeCulling != MESHLET_CONES_OFF && uniformScale && determinant > 0.f;
+	// counter clockwise pipelines see the other side of the triangles the cones were built from
+	float coneSign = groupData.MeshletConeCulling == MESHLET_CONES_MIRRORED ? -1.f : 1.f;
+
+	bool hasBatch = groupData.DrawBatchID != INVALID_BATCH_INDEX;
+	uint commandsOffset = view.ViewIndex * Resources.MeshletCommandsStride + (hasBatch ? BatchOffsetsBuffer[Resources.BatchesCapacity + groupData.DrawBatchID] : 0);
+	uint countAddress = (view.ViewIndex * Resources.DrawCountsStride + Resources.BatchesCapacity + groupData.DrawBatchID) * 4;
+
+	bool hasHistory = objectData.MeshletVisibilityOffset != INVALID_MESHLET_VISIBILITY;
+	uint historyOffset = view.ViewIndex * Resources.MeshletVisibilityStride + objectData.MeshletVisibilityOffset;
+
+	for (uint i = threadIndex; i < groupData.MeshletCount; i += CULL_GROUP_SIZE) {
+		MeshletGPUData meshlet = vk::RawBufferLoad<MeshletGPUData>(groupData.MeshletBufferAddress + i * sizeof(MeshletGPUData), 16);
+
+		float3 center = mul(transform, float4(meshlet.Sphere.xyz, 1.f));
+		float radius = meshlet.Sphere.w * maxScale;
+
+		bool visible = IsInFrustum(view, center, radius);
+		if (visible && coneCulling && meshlet.Cone.w < 1.f) {
+			float3 axis = normalize(mul(normalMatrix, meshlet.Cone.xyz)) * coneSign;
+			visible = !IsConeBackFacing(view.CameraPos.xyz, center, radius, axis, meshlet.Cone.w);
+		}
+
+		uint bit = 1u << (i & 31u);
+		uint historyIndex = historyOffset + (i >> 5);
+		bool lastVisible = hasHistory && (MeshletVisibilityBuffer[historyIndex] & bit) != 0;
+
+		bool draw;
+		if (prepass) {
+			draw = visible && lastVisible;
+		}
+		else {
+			visible = visible && !IsOccluded(view, viewSlot, center, radius);
+			draw = visible && !(drawnInPrepass && lastVisible);
+
+			if (hasHistory) {
+				if (visible) {
+					InterlockedOr(MeshletVisibilityBuffer[historyIndex], bit);
+				}
+				else {
+					InterlockedAnd(MeshletVisibilityBuffer[historyIndex], ~bit);
+				}
+			}
+		}
+
+		if (draw && hasBatch) {
+			uint localIndex;
+			DrawCountsBuffer.InterlockedAdd(countAddress, 1, localIndex);
+
+			DrawIndirectCommand command;
+			command.VertexCount = meshlet.IndexCount;
+			command.InstanceCount = 1;
+			command.FirstVertex = meshlet.FirstIndex;
+			command.FirstInstance = visibleSlot;
+
+			MeshletCommandsBuffer[commandsOffset + localIndex] = command;
+		}
+	}
+}
+
+// a row of the dispatch per view, every view culls into its own slice of the buffers
+[numthreads(CULL_GROUP_SIZE, 1, 1)]
+void CSMain(uint3 threadID : SV_DispatchThreadID, uint3 groupID : SV_GroupID, uint threadIndex : SV_GroupIndex) {
+	uint viewSlot = threadID.y;
+	CullViewGPUData view = ViewsBuffer[viewSlot];
+
+	if (Resources.Stage == STAGE_MESHLETS) {
 
-            DrawIndirectCommand command;
-            command.VertexCount = objectData.IndexCount;
-            command.InstanceCount = 1;
-            command.FirstVertex = 0;
-            command.FirstInstance = localDataIndex;
+		// the dispatch is sized by the longest queue, rows of shorter ones have groups without work
+		uint queueCount = MeshletDispatchBuffer.Load(MESHLET_QUEUE_COUNTS_OFFSET + view.ViewIndex * 4);
+		uint groupStride = MeshletDispatchBuffer.Load(0);
+
+		for (uint item = groupID.x; item < queueCount; item += groupStride) {
+			CullMeshlets(view, viewSlot, item, threadIndex);
+		}
+	}
+	else if (Resources.Stage == STAGE_EMIT) {
 
-            DrawCommandsBuffer[localDrawCommandIndex] = command;
-        }
+		if (threadID.x < Resources.GroupsCount) {
+			EmitGroupCommands(view, threadID.x);
+		}
+	}
+	else if (threadID.x < Resources.ObjectsCount) {
 
-        if (!prepass) {
-            VisibilityBuffer[objectData.VisibilityIdx] = visible ? 1 : 0;
-        }
-    }
-}
\ No newline at end of file
+		if (Resources.Stage == STAGE_CULL) {
+			CullInstance(view, viewSlot, threadID.x);
+		}
+		else {
+			CompactInstance(view, viewSlot, threadID.x);
+		}
+	}
+}
@@ -0,0 +1,125 @@
+#include "ShaderCommon.hlsli"
+
+[[vk::binding(0, 0)]] ConstantBuffer<SceneGPUData> SceneDataBuffer;
+[[vk::binding(1, 0)]] StructuredBuffer<SceneLightGPUData> LightsBuffer;
+[[vk::binding(2, 0)]] StructuredBuffer<LightClusterBounds> ClusterBoundsBuffer;
+[[vk::binding(3, 0)]] RWStructuredBuffer<uint2> ClusterRangesBuffer;
+[[vk::binding(4, 0)]] RWStructuredBuffer<uint> ClusterLightIndicesBuffer;
+[[vk::binding(5, 0)]] RWByteAddressBuffer ClusterCounterBuffer;
+
+struct LightClustersConstants {
+
+    float4 ViewRows[3];
+
+    uint TilesXY;
+    uint MaxLightIndices;
+    float Padding0[2];
+}; [[vk::push_constant]] LightClustersConstants Resources;
+
+#define THREADS_PER_CLUSTER 64u
+
+groupshared uint ClusterLights[MAX_LIGHTS_PER_CLUSTER];
+groupshared uint ClusterLightCount;
+groupshared uint ChunkMask[2];
+groupshared uint ClusterOffset;
+
+// LightClusterGrid::BinLights mirrors these, precise keeps the operations in order and without contraction
+float3 LightToView(float4 position) {
+    precise float x = ((Resources.ViewRows[0].x * position.x + Resources.ViewRows[0].y * position.y) + Resources.ViewRows[0].z * position.z) + Resources.ViewRows[0].w;
+    precise float y = ((Resources.ViewRows[1].x * position.x + Resources.ViewRows[1].y * position.y) + Resources.ViewRows[1].z * position.z) + Resources.ViewRows[1].w;
+    precise float z = ((Resources.ViewRows[2].x * position.x + Resources.ViewRows[2].y * position.y) + Resources.ViewRows[2].z * position.z) + Resources.ViewRows[2].w;
+    return float3(x, y, z);
+}
+
+bool SphereIntersectsCluster(LightClusterBounds bounds, float3 center, float radius) {
+    precise float dx = max(max(bounds.Min.x - center.x, center.x - bounds.Max.x), 0.f);
+    precise float dy = max(max(bounds.Min.y - center.y, center.y - bounds.Max.y), 0.f);
+    precise float dz = max(max(bounds.Min.z - center.z, center.z - bounds.Max.z), 0.f);
+
+    precise float distSq = (dx * dx + dy * dy) + dz * dz;
+    precise float radiusSq = radius * radius;
+    return distSq <= radiusSq;
+}
+
+// a group per cluster, lights are tested in chunks and kept in light order, then the list gets its place in the global one
+[numthreads(THREADS_PER_CLUSTER, 1, 1)]
+void CSMain(uint3 groupID : SV_GroupID, uint threadIndex : SV_GroupIndex) {
+
+    uint cluster = groupID.y * Resources.TilesXY + groupID.x;
+    LightClusterBounds bounds = ClusterBoundsBuffer[cluster];
+
+    if (threadIndex == 0) {
+        ClusterLightCount = 0;
+    }
+
+    for (uint base = 0; base < SceneDataBuffer.LightsCount; base += THREADS_PER_CLUSTER) {
+
+        // the same thread reads the masks at the end of the chunk, so nothing else has to wait for it
+        if (threadIndex == 0) {
+            ChunkMask[0] = 0;
+            ChunkMask[1] = 0;
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        uint lightIndex = base + threadIndex;
+        bool hit = false;
+
+        if (lightIndex < SceneDataBuffer.LightsCount) {
+            SceneLightGPUData light = LightsBuffer[lightIndex];
+            hit = SphereIntersectsCluster(bounds, LightToView(light.Position), light.Range);
+        }
+
+        if (hit) {
+            InterlockedOr(ChunkMask[threadIndex >> 5], 1u << (threadIndex & 31u));
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        // lights before this one in the chunk give its place, so the order doesn't depend on scheduling
+        if (hit) {
+            uint rank = countbits(ChunkMask[threadIndex >> 5] & ((1u << (threadIndex & 31u)) - 1u));
+            if (threadIndex >= 32u) {
+                rank += countbits(ChunkMask[0]);
+            }
+
+            uint slot = ClusterLightCount + rank;
+            if (slot < MAX_LIGHTS_PER_CLUSTER) {
+                ClusterLights[slot] = lightIndex;
+            }
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if (threadIndex == 0) {
+            ClusterLightCount += countbits(ChunkMask[0]) + countbits(ChunkMask[1]);
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint count = min(ClusterLightCount, MAX_LIGHTS_PER_CLUSTER);
+
+    if (threadIndex == 0) {
+        uint offset = 0;
+        if (count > 0) {
+            ClusterCounterBuffer.InterlockedAdd(0, count, offset);
+        }
+
+        // lists past the capacity are cut, only happens with far more lights than the average per cluster
+        uint stored = offset < Resources.MaxLightIndices ? min(count, Resources.MaxLightIndices - offset) : 0;
+
+        ClusterOffset = offset;
+        ClusterRangesBuffer[cluster] = uint2(offset, stored);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint i = threadIndex; i < count; i += THREADS_PER_CLUSTER) {
+
+        uint index = ClusterOffset + i;
+        if (index < Resources.MaxLightIndices) {
+            ClusterLightIndicesBuffer[index] = ClusterLights[i];
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#include "ShaderCommon.hlsli"
+
+// record offsets first, then the records themselves
+[[vk::binding(0, 0)]] ByteAddressBuffer UploadBuffer;
+[[vk::binding(1, 0)]] RWByteAddressBuffer SceneBuffer;
+
+struct ScatterConstants {
+
+    uint RecordCount;
+    uint RecordWords;
+    uint PayloadOffset;
+    uint ThreadStride;
+}; [[vk::push_constant]] ScatterConstants Resources;
+
+// every thread copies single words, so consecutive threads touch consecutive memory
+[numthreads(64, 1, 1)]
+void CSMain(uint3 threadID : SV_DispatchThreadID) {
+
+    uint wordCount = Resources.RecordCount * Resources.RecordWords;
+
+    for (uint i = threadID.x; i < wordCount; i += Resources.ThreadStride) {
+
+        uint record = i / Resources.RecordWords;
+        uint word = i - record * Resources.RecordWords;
+
+        uint dstRecord = UploadBuffer.Load(record * 4);
+        uint value = UploadBuffer.Load(Resources.PayloadOffset + i * 4);
+
+        SceneBuffer.Store((dstRecord * Resources.RecordWords + word) * 4, value);
+    }
+}
@@ -19,30 +19,91 @@ struct SceneGPUData {
 
     uint LightsCount;
     uint ObjectsCount;
+    uint GroupsCount;
 
-    float Padding0[5];
+    float Padding0[4];
 };
 
 struct SceneObjectGPUData {
 
-	float4 BoundsOrigin; // w - bounds radius
-	//float4 BoundsExtents;
-	float4x4 GlobalTransform;
-    float4x4 InverseTransform;
+    // rows of the world transform, the last one is always (0, 0, 0, 1)
+    float4 TransformRows[3];
+
+    uint GroupIndex;
+    uint VisibilityIdx;
 
-	uint FirstIndex;
-	uint IndexCount;
+    // views only draw instances sharing a layer with their mask
+    uint LayerMask;
+
+    // first word of the instance's meshlet visibility bits, for groups drawn by meshlets
+    uint MeshletVisibilityOffset;
+};
+
+struct SceneInstanceGroupGPUData {
+
+	float4 BoundsOrigin; // w - bounds radius
 
 	uint64_t IndexBufferAddress;
 	uint64_t VertexBufferAddress;
 
+	// finest to coarsest, errors are relative to the bounds radius
+	uint4 LodFirstIndex;
+	uint4 LodIndexCount;
+	float4 LodErrors;
+	uint LodCount;
+
 	uint MaterialBufferIndex;
 	uint DrawBatchID;
 
-	uint VisibilityIdx;
+    uint InstanceOffset;
+    uint InstanceCount;
+
+    // meshlets of the submesh, the finest lod of groups with any is drawn by them
+    uint MeshletCount;
+    uint64_t MeshletBufferAddress;
+    // only for shaders culling back faces, one of MESHLET_CONES_*
+    uint MeshletConeCulling;
     float Padding0[3];
 };
 
+// mirrors Meshlet, spheres and cones are in mesh space
+struct MeshletGPUData {
+
+    float4 Sphere; // w - radius
+    float4 Cone; // w - cutoff
+
+    uint SubMesh;
+    uint FirstIndex;
+    uint IndexCount;
+    uint Padding0;
+};
+
+#define INVALID_GROUP_INDEX 0xFFFFFFFFu
+#define INVALID_BATCH_INDEX 0xFFFFFFFFu
+#define INVALID_MESHLET_VISIBILITY 0xFFFFFFFFu
+#define MESH_MAX_LODS 4u
+
+#define MESHLET_CONES_OFF 0u
+#define MESHLET_CONES_FRONT 1u
+#define MESHLET_CONES_MIRRORED 2u
+
+float3x4 GetObjectTransform(SceneObjectGPUData objectData) {
+
+    return float3x4(objectData.TransformRows[0], objectData.TransformRows[1], objectData.TransformRows[2]);
+}
+
+// cofactors of the upper 3x3, same direction as the inverse transpose without inverting
+float3x3 GetObjectNormalMatrix(float3x4 transform) {
+
+    float3 c0 = float3(transform[0].x, transform[1].x, transform[2].x);
+    float3 c1 = float3(transform[0].y, transform[1].y, transform[2].y);
+    float3 c2 = float3(transform[0].z, transform[1].z, transform[2].z);
+
+    // mirrored transforms flip the cofactors, the sign of the determinant flips them back
+    float s = sign(dot(c0, cross(c1, c2)));
+    return transpose(float3x3(cross(c1, c2), cross(c2, c0), cross(c0, c1)) * s);
+}
+
 struct SceneLightGPUData {
 
     float4 Position;
@@ -60,6 +121,17 @@ struct SceneLightGPUData {
     float Range;
 };
 
+// view space bounds of a froxel, see LightClusterGrid
+struct LightClusterBounds {
+
+    float4 Min;
+    float4 Max;
+};
+
+#define LIGHT_CLUSTER_TILE_SIZE 64u
+#define LIGHT_CLUSTER_SLICES 24u
+#define MAX_LIGHTS_PER_CLUSTER 256u
+
 float4 UnpackUintToUnsignedVec4(uint packed) {
     float r = float((packed & 0x000000ff) >> 0) / 255.f;
     float g = float((packed & 0x0000ff00) >> 8) / 255.f;
@@ -115,6 +187,8 @@ struct MaterialData {
 
 [[vk::binding(0, 0)]] ConstantBuffer<SceneGPUData> SceneDataBuffer;
 [[vk::binding(1, 0)]] StructuredBuffer<SceneObjectGPUData> ObjectsBuffer;
+[[vk::binding(2, 0)]] StructuredBuffer<SceneInstanceGroupGPUData> GroupsBuffer;
+[[vk::binding(3, 0)]] StructuredBuffer<uint> VisibleInstancesBuffer;
 
 [[vk::binding(0, 1)]] StructuredBuffer<MaterialData> MaterialDataBuffer;
 [[vk::binding(1, 1)]] Texture2D TextureTable[];
@@ -26,6 +26,10 @@ namespace Spike {
 			VK_CHECK(vkCreateFence(m_Device.Device, &fenceCreateInfo, nullptr, &m_ImmFence));
 
 			m_ImmCmd = nullptr;
+			m_NumSubmissions = 0;
+			m_CompletedSubmission = 0;
+			m_FrameSubmissions[0] = 0;
+			m_FrameSubmissions[1] = 0;
 		}
 
 		// init pools
@@ -96,6 +100,20 @@ namespace Spike {
 			delete m_ImmCmd;
 		}
 
+		for (auto& [id, pool] : m_ThreadPools) {
+
+			for (RHICommandBuffer* cmd : pool->Buffers) {
+				VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
+
+				ReleaseUploads(vkCmd);
+				delete vkCmd;
+				delete cmd;
+			}
+			vkDestroyCommandPool(m_Device.Device, pool->Pool, nullptr);
+
+			delete pool;
+		}
+
 		vkDestroyDescriptorPool(m_Device.Device, m_BindlessPool, nullptr);
 		vkDestroyDescriptorPool(m_Device.Device, m_GlobalSetPool, nullptr);
 
@@ -124,6 +142,15 @@ namespace Spike {
 	void VulkanRHIDevice::CopyDataToTexture(void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess, 
 		const std::vector<SubResourceCopyRegion>& regions, size_t copySize) 
 	{
+		ImmediateSubmit([&](RHICommandBuffer* cmd) {
+			CopyDataToTexture(cmd, src, srcOffset, dst, lastAccess, newAccess, regions, copySize);
+			});
+	}
+
+	void VulkanRHIDevice::CopyDataToTexture(RHICommandBuffer* cmd, void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess,
+		const std::vector<SubResourceCopyRegion>& regions, size_t copySize)
+	{
+		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
 		VulkanRHITexture* vkTex = (VulkanRHITexture*)dst->GetRHIData();
 
 		BufferDesc uploadDesc{};
@@ -134,34 +161,31 @@ namespace Spike {
 		VulkanRHIBuffer* uploadBuff = (VulkanRHIBuffer*)CreateBufferRHI(uploadDesc);
 		memcpy(uploadBuff->AllocationInfo.pMappedData, (uint8_t*)src + srcOffset, copySize);
 
-		ImmediateSubmit([&](RHICommandBuffer* cmd) {
-
-			VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
-			BarrierTexture(cmd, dst, lastAccess, EGPUAccessFlags::ECopyDst);
+		// read when the buffer executes, freed together with its recording
+		vkCmd->Uploads.push_back(uploadBuff);
 
-			std::vector<VkBufferImageCopy> vkRegions{};
-			for (auto& region : regions) {
+		BarrierTexture(cmd, dst, lastAccess, EGPUAccessFlags::ECopyDst);
 
-				VkBufferImageCopy vkRegion = {};
-				vkRegion.bufferOffset = region.DataOffset;
-				vkRegion.bufferRowLength = 0;
-				vkRegion.bufferImageHeight = 0;
+		std::vector<VkBufferImageCopy> vkRegions{};
+		for (auto& region : regions) {
 
-				vkRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				vkRegion.imageSubresource.mipLevel = region.MipLevel;
-				vkRegion.imageSubresource.baseArrayLayer = region.ArrayLayer;
-				vkRegion.imageSubresource.layerCount = 1;
-				vkRegion.imageExtent = { (dst->GetSizeXYZ().x >> region.MipLevel), (dst->GetSizeXYZ().y >> region.MipLevel), 1 };
-				vkRegion.imageOffset = { 0, 0, 0 };
+			VkBufferImageCopy vkRegion = {};
+			vkRegion.bufferOffset = region.DataOffset;
+			vkRegion.bufferRowLength = 0;
+			vkRegion.bufferImageHeight = 0;
 
-				vkRegions.push_back(vkRegion);
-			}
+			vkRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			vkRegion.imageSubresource.mipLevel = region.MipLevel;
+			vkRegion.imageSubresource.baseArrayLayer = region.ArrayLayer;
+			vkRegion.imageSubresource.layerCount = 1;
+			vkRegion.imageExtent = { (dst->GetSizeXYZ().x >> region.MipLevel), (dst->GetSizeXYZ().y >> region.MipLevel), 1 };
+			vkRegion.imageOffset = { 0, 0, 0 };
 
-			vkCmdCopyBufferToImage(vkCmd->Cmd, uploadBuff->Buffer, vkTex->Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vkRegions.size(), vkRegions.data());
-			BarrierTexture(cmd, dst, EGPUAccessFlags::ECopyDst, newAccess);
-			});
+			vkRegions.push_back(vkRegion);
+		}
 
-		DestroyBufferRHI((RHIData)uploadBuff);
+		vkCmdCopyBufferToImage(vkCmd->Cmd, uploadBuff->Buffer, vkTex->Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vkRegions.size(), vkRegions.data());
+		BarrierTexture(cmd, dst, EGPUAccessFlags::ECopyDst, newAccess);
 	}
 
 	void VulkanRHIDevice::MipMapTexture2D(RHICommandBuffer* cmd, RHITexture2D* tex, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess, uint32_t numMips) {
@@ -854,7 +878,8 @@ namespace Spike {
 
 		VulkanRHICommandBuffer* cmd = new VulkanRHICommandBuffer();
 
-		VkCommandPoolCreateInfo commandPoolInfo = VulkanUtils::CommandPoolCreateInfo(m_Device.Queues.GraphicsQueueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		// the buffer is reset together with its pool
+		VkCommandPoolCreateInfo commandPoolInfo = VulkanUtils::CommandPoolCreateInfo(m_Device.Queues.GraphicsQueueFamily, 0);
 		VK_CHECK(vkCreateCommandPool(m_Device.Device, &commandPoolInfo, nullptr, &cmd->Pool));
 
 		VkCommandBufferAllocateInfo cmdAllocInfo = VulkanUtils::CommandBufferAllocInfo(cmd->Pool, 1);
@@ -866,6 +891,7 @@ namespace Spike {
 	void VulkanRHIDevice::DestroyCommandBufferRHI(RHIData data) {
 
 		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)data;
+		ReleaseUploads(vkCmd);
 
 		if (vkCmd->Pool) {
 			vkDestroyCommandPool(m_Device.Device, vkCmd->Pool, nullptr);
@@ -890,7 +916,12 @@ namespace Spike {
 		uint32_t frameIndex = GFrameRenderer->GetFrameCount() % 2;
 		VK_CHECK(vkWaitForFences(m_Device.Device, 1, &m_SyncObjects[frameIndex].RenderFence, true, 1000000000));
 		VK_CHECK(vkResetFences(m_Device.Device, 1, &m_SyncObjects[frameIndex].RenderFence));
-		VK_CHECK(vkResetCommandBuffer(vkCmd->Cmd, 0));
+		VK_CHECK(vkResetCommandPool(m_Device.Device, vkCmd->Pool, 0));
+		ReleaseUploads(vkCmd);
+
+		// submissions complete in order, every transient buffer executed up to this frame can be reused
+		std::lock_guard<std::mutex> lock(m_ThreadPoolsMutex);
+		m_CompletedSubmission = std::max(m_CompletedSubmission, m_FrameSubmissions[frameIndex]);
 	}
 
 	void VulkanRHIDevice::ImmediateSubmit(std::function<void(RHICommandBuffer*)>&& func) {
@@ -903,7 +934,7 @@ namespace Spike {
 		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)m_ImmCmd->GetRHIData();
 
 		VK_CHECK(vkResetFences(m_Device.Device, 1, &m_ImmFence));
-		VK_CHECK(vkResetCommandBuffer(vkCmd->Cmd, 0));
+		VK_CHECK(vkResetCommandPool(m_Device.Device, vkCmd->Pool, 0));
 
 		VkCommandBufferBeginInfo cmdBeginInfo = VulkanUtils::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 		VK_CHECK(vkBeginCommandBuffer(vkCmd->Cmd, &cmdBeginInfo));
@@ -917,6 +948,90 @@ namespace Spike {
 
 		VK_CHECK(vkQueueSubmit2(m_Device.Queues.GraphicsQueue, 1, &submit, m_ImmFence));
 		VK_CHECK(vkWaitForFences(m_Device.Device, 1, &m_ImmFence, true, 9999999999));
+
+		ReleaseUploads(vkCmd);
+	}
+
+	VulkanThreadCommandPool* VulkanRHIDevice::GetThreadCommandPool() {
+
+		// the device lives for the whole application, so caching per thread is safe
+		static thread_local VulkanThreadCommandPool* threadPool = nullptr;
+		if (threadPool) return threadPool;
+
+		std::lock_guard<std::mutex> lock(m_ThreadPoolsMutex);
+
+		VulkanThreadCommandPool*& pool = m_ThreadPools[std::this_thread::get_id()];
+		if (!pool) {
+			pool = new VulkanThreadCommandPool();
+
+			VkCommandPoolCreateInfo commandPoolInfo = VulkanUtils::CommandPoolCreateInfo(m_Device.Queues.GraphicsQueueFamily, 
+				VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			VK_CHECK(vkCreateCommandPool(m_Device.Device, &commandPoolInfo, nullptr, &pool->Pool));
+		}
+
+		threadPool = pool;
+		return pool;
+	}
+
+	void VulkanRHIDevice::ReleaseUploads(VulkanRHICommandBuffer* cmd) {
+
+		for (VulkanRHIBuffer* upload : cmd->Uploads) {
+			DestroyBufferRHI((RHIData)upload);
+		}
+		cmd->Uploads.clear();
+	}
+
+	RHICommandBuffer* VulkanRHIDevice::AcquireTransientCommandBuffer() {
+
+		VulkanThreadCommandPool* pool = GetThreadCommandPool();
+		RHICommandBuffer* cmd = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_ThreadPoolsMutex);
+
+			// any buffer the gpu is done with is reused, new ones are only allocated while all of them are in flight
+			for (RHICommandBuffer* buffer : pool->Buffers) {
+				if (((VulkanRHICommandBuffer*)buffer->GetRHIData())->Submission <= m_CompletedSubmission) {
+					cmd = buffer;
+					break;
+				}
+			}
+
+			if (!cmd) {
+				VulkanRHICommandBuffer* vkCmd = new VulkanRHICommandBuffer();
+				vkCmd->Pool = pool->Pool;
+
+				VkCommandBufferAllocateInfo cmdAllocInfo = VulkanUtils::CommandBufferAllocInfo(pool->Pool, 1);
+				VK_CHECK(vkAllocateCommandBuffers(m_Device.Device, &cmdAllocInfo, &vkCmd->Cmd));
+
+				cmd = pool->Buffers.emplace_back(new RHICommandBuffer((RHIData)vkCmd));
+			}
+
+			// not reusable until the frame submission that picks it up has finished
+			((VulkanRHICommandBuffer*)cmd->GetRHIData())->Submission = UINT64_MAX;
+		}
+
+		// only this thread records from the pool, so the rest happens outside of the lock
+		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
+		ReleaseUploads(vkCmd);
+
+		VkCommandBufferBeginInfo cmdBeginInfo = VulkanUtils::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		VK_CHECK(vkBeginCommandBuffer(vkCmd->Cmd, &cmdBeginInfo));
+
+		return cmd;
+	}
+
+	void VulkanRHIDevice::SubmitTransientCommandBuffer(RHICommandBuffer* cmd) {
+
+		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
+
+		// pools are not synchronized, recording has to stay on the thread that acquired the buffer
+		assert(vkCmd->Pool == GetThreadCommandPool()->Pool && "Transient command buffer submitted from another thread!");
+		assert(vkCmd->Submission == UINT64_MAX && "Transient command buffer submitted twice!");
+
+		VK_CHECK(vkEndCommandBuffer(vkCmd->Cmd));
+
+		std::lock_guard<std::mutex> lock(m_ThreadPoolsMutex);
+		m_PendingTransientCmds.push_back(vkCmd);
 	}
 
 	void VulkanRHIDevice::DispatchCompute(RHICommandBuffer* cmd, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
@@ -925,6 +1040,14 @@ namespace Spike {
 		vkCmdDispatch(vkCmd->Cmd, groupCountX, groupCountY, groupCountZ);
 	}
 
+	void VulkanRHIDevice::DispatchComputeIndirect(RHICommandBuffer* cmd, RHIBuffer* argsBuffer, size_t offset) {
+
+		VulkanRHICommandBuffer* vkCmd = (VulkanRHICommandBuffer*)cmd->GetRHIData();
+		VulkanRHIBuffer* vkArgsBuff = (VulkanRHIBuffer*)argsBuffer->GetRHIData();
+
+		vkCmdDispatchIndirect(vkCmd->Cmd, vkArgsBuff->Buffer, offset);
+	}
+
 	void VulkanRHIDevice::WaitGPUIdle() {
 
 		vkDeviceWaitIdle(m_Device.Device);
@@ -1282,12 +1405,29 @@ namespace Spike {
 		{
 			VK_CHECK(vkEndCommandBuffer(vkCmd->Cmd));
 
-			VkCommandBufferSubmitInfo cmdInfo = VulkanUtils::CommandBufferSubmitInfo(vkCmd->Cmd);
+			// transient buffers submitted since the last frame go first
+			std::vector<VkCommandBufferSubmitInfo> cmdInfos{};
+			{
+				std::lock_guard<std::mutex> lock(m_ThreadPoolsMutex);
+
+				// the buffers become reusable once this frame's fence was waited on
+				uint64_t submission = ++m_NumSubmissions;
+				m_FrameSubmissions[frameIndex] = submission;
+
+				cmdInfos.reserve(m_PendingTransientCmds.size() + 1);
+				for (VulkanRHICommandBuffer* transientCmd : m_PendingTransientCmds) {
+					transientCmd->Submission = submission;
+					cmdInfos.push_back(VulkanUtils::CommandBufferSubmitInfo(transientCmd->Cmd));
+				}
+				m_PendingTransientCmds.clear();
+			}
+			cmdInfos.push_back(VulkanUtils::CommandBufferSubmitInfo(vkCmd->Cmd));
 
 			VkSemaphoreSubmitInfo waitInfo = VulkanUtils::SemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR, m_SyncObjects[frameIndex].SwapchainSemaphore);
 			VkSemaphoreSubmitInfo signalInfo = VulkanUtils::SemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, m_SyncObjects[frameIndex].RenderSemaphore);
 
-			VkSubmitInfo2 submit = VulkanUtils::SubmitInfo(&cmdInfo, &signalInfo, &waitInfo);
+			VkSubmitInfo2 submit = VulkanUtils::SubmitInfo(cmdInfos.data(), &signalInfo, &waitInfo);
+			submit.commandBufferInfoCount = (uint32_t)cmdInfos.size();
 
 			VK_CHECK(vkQueueSubmit2(m_Device.Queues.GraphicsQueue, 1, &submit, m_SyncObjects[frameIndex].RenderFence));
 
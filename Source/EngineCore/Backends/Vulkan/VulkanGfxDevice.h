@@ -5,6 +5,10 @@
 #include <Backends/Vulkan/VulkanSwapchain.h>
 #include <Backends/Vulkan/VulkanResources.h>
 
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 namespace Spike {
 
 	struct VulkanImGuiTextureManager {
@@ -40,6 +44,8 @@ namespace Spike {
 		virtual void ClearTexture(RHICommandBuffer* cmd, RHITexture* tex, EGPUAccessFlags access, const Vec4& color) override;
 		virtual void CopyDataToTexture(void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess, 
 			const std::vector<SubResourceCopyRegion>& regions, size_t copySize) override;
+		virtual void CopyDataToTexture(RHICommandBuffer* cmd, void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess,
+			const std::vector<SubResourceCopyRegion>& regions, size_t copySize) override;
 		virtual void BarrierTexture(RHICommandBuffer* cmd, RHITexture* texture, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess) override;
 
 		virtual RHIData CreateTextureViewRHI(const TextureViewDesc& desc) override;
@@ -71,7 +77,10 @@ namespace Spike {
 		virtual void BeginFrameCommandBuffer(RHICommandBuffer* cmd) override;
 		virtual void WaitForFrameCommandBuffer(RHICommandBuffer* cmd) override;
 		virtual void ImmediateSubmit(std::function<void(RHICommandBuffer*)>&& func) override;
+		virtual RHICommandBuffer* AcquireTransientCommandBuffer() override;
+		virtual void SubmitTransientCommandBuffer(RHICommandBuffer* cmd) override;
 		virtual void DispatchCompute(RHICommandBuffer* cmd, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+		virtual void DispatchComputeIndirect(RHICommandBuffer* cmd, RHIBuffer* argsBuffer, size_t offset) override;
 		virtual void WaitGPUIdle() override;
 
 		virtual void BeginRendering(RHICommandBuffer* cmd, const RenderInfo& info) override;
@@ -84,6 +93,9 @@ namespace Spike {
 	private:
 		void UpdateImGuiObjects(ImGuiRTState* state);
 
+		VulkanThreadCommandPool* GetThreadCommandPool();
+		void ReleaseUploads(VulkanRHICommandBuffer* cmd);
+
 	private:
 		VulkanDevice m_Device;
 		VulkanSwapchain m_Swapchain;
@@ -97,6 +109,15 @@ namespace Spike {
 		RHICommandBuffer* m_ImmCmd;
 		VkFence m_ImmFence;
 
+		// guards the pools, the pending list and the submission counts
+		// transient buffers are tracked one by one by the submission that executes them, so a frame never waits on a recording thread
+		std::mutex m_ThreadPoolsMutex;
+		std::unordered_map<std::thread::id, VulkanThreadCommandPool*> m_ThreadPools;
+		std::vector<VulkanRHICommandBuffer*> m_PendingTransientCmds;
+		uint64_t m_NumSubmissions;
+		uint64_t m_CompletedSubmission;
+		uint64_t m_FrameSubmissions[2];
+
 		struct {
 
 			VkSemaphore SwapchainSemaphore, RenderSemaphore;
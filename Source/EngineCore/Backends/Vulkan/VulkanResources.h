@@ -4,6 +4,8 @@
 
 namespace Spike {
 
+	class RHICommandBuffer;
+
 	struct VulkanRHITexture {
 
 		VkImage Image = nullptr;
@@ -29,6 +31,19 @@ namespace Spike {
 
 		VkCommandBuffer Cmd = nullptr;
 		VkCommandPool Pool = nullptr;
+
+		// transient buffers only, frame submission that executes the buffer, reused once the gpu finished it
+		uint64_t Submission = 0;
+
+		// upload memory read by the recorded commands, freed once the buffer was executed
+		std::vector<VulkanRHIBuffer*> Uploads;
+	};
+
+	// transient buffers of one thread, each buffer is reset on its own when it's reused
+	struct VulkanThreadCommandPool {
+
+		VkCommandPool Pool = nullptr;
+		std::vector<RHICommandBuffer*> Buffers;
 	};
 
 	struct VulkanRHIShader {
@@ -27,6 +27,16 @@ namespace Spike {
 		delete GInput;
 	}
 
+	float WindowsWindow::GetRefreshRate() const {
+
+		SDL_DisplayMode mode{};
+		if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(m_Window), &mode) != 0) {
+			return 0.f;
+		}
+
+		return (float)mode.refresh_rate;
+	}
+
 	void WindowsWindow::Tick() {
 		GInput->Tick();
 
@@ -16,6 +16,7 @@ namespace Spike {
 
 		virtual const std::string& GetName() const override { return m_Data.Name; }
 		virtual void* GetNativeWindow() const override { return m_Window; }
+		virtual float GetRefreshRate() const override;
 
 		virtual void Tick() override;
 
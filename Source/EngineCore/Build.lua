@@ -43,6 +43,10 @@ project "EngineCore"
 		"%{LibsDir.VULKAN_SDK}/vulkan-1.lib"
 	}
 
+	-- the only file built with avx, SimdMath.cpp calls into it after checking the cpu
+	filter "files:Engine/Utils/SimdMathAvx.cpp"
+		vectorextensions "AVX"
+
 	filter("system:windows")
 		systemversion "latest"
 		buildoptions "/utf-8"
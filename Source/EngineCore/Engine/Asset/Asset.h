@@ -4,6 +4,7 @@
 #include <Engine/Core/Core.h>
 #include <Engine/Utils/Misc.h>
 #include <Engine/Serialization/FileStream.h>
+#include <Engine/Multithreading/Task.h>
 
 #define ASSET_CLASS_TYPE(type)                                                 \
 static Spike::EAssetType GetStaticType() { return type; }                      \
@@ -39,7 +40,11 @@ namespace Spike {
 	public:
 		virtual ~AssetRegistry() = default;
 
+		// loaded assets are kept until unloaded, every load of the same id returns the same asset
 		virtual Ref<Asset> LoadAsset(UUID id) = 0;
+
+		// file io happens on a worker thread, has to be started and is resumed on the main thread
+		virtual Task<Ref<Asset>> LoadAssetAsync(UUID id) = 0;
 		virtual void UnloadAsset(UUID id) = 0;
 		virtual void Save() = 0;
 		virtual void Deserialize() = 0;
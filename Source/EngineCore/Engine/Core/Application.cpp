@@ -3,6 +3,7 @@
 #include <Engine/Core/Log.h>
 
 #include <Engine/Core/Stats.h>
+#include <Engine/Multithreading/JobSystem.h>
 
 Spike::Application* Spike::Application::s_Instance = nullptr;
 
@@ -16,8 +17,14 @@ namespace Spike {
 		m_UsingImGui = desc.UsingImGui;
 		m_UsingDocking = desc.UsingDocking;
 
+		m_FramePacer.SetDesc(desc.PacerDesc);
+		m_FramePacer.SetRefreshRate(m_Window->GetRefreshRate());
+
 		// initialize core globals
 		s_Instance = this;
+		m_MainThreadID = std::this_thread::get_id();
+
+		GJobSystem = new JobSystem();
 		RHIDevice::Create(m_Window, m_UsingImGui);
 
 		ENGINE_WARN("Created an application: " + desc.Name);
@@ -32,6 +39,9 @@ namespace Spike {
 
 		m_LayerStack.CleanAll();
 
+		delete GJobSystem;
+		GJobSystem = nullptr;
+
 		SUBMIT_RENDER_COMMAND([]() {
 			delete GRHIDevice;
 			});
@@ -46,7 +56,7 @@ namespace Spike {
 	void Application::Tick() {
 
 		while (m_Running) {
-			Timer timer = Timer();
+			m_FramePacer.WaitForFrame();
 
 			m_RenderThread.WaitTillDone();
 			ProcessEvents();
@@ -54,23 +64,50 @@ namespace Spike {
 			m_RenderThread.Process();
 			GFrameRenderer->BeginFrame();
 
+			// sample input right before the simulation, instead of for the next frame
+			bool lowLatency = m_FramePacer.GetDesc().LowLatency;
+			if (lowLatency) {
+				m_Window->Tick();
+				m_FramePacer.OnInputSampled();
+			}
+
+			m_FramePacer.OnSimulationStart();
 			if (!m_Minimized) {
+				float deltaTime = m_Time.DeltaTime;
 
-				// update all layers
+				// independent layers run on workers, while the rest ticks here in stack order
+				JobCounter counter{};
 				for (Layer* layer : m_LayerStack) {
-					layer->Tick(m_Time.DeltaTime);
+					if (layer->IsIndependent()) {
+						GJobSystem->Schedule([layer, deltaTime]() { layer->Tick(deltaTime); }, &counter);
+					}
 				}
+
+				for (Layer* layer : m_LayerStack) {
+					if (!layer->IsIndependent()) {
+						layer->Tick(deltaTime);
+					}
+				}
+
+				GJobSystem->Wait(counter);
+			}
+
+			if (!lowLatency) {
+				m_Window->Tick();
+				m_FramePacer.OnInputSampled();
 			}
 
-			m_Window->Tick();
 			GFrameRenderer->RenderSwapchain(m_Window->GetWidth(), m_Window->GetHeight());
+			m_FramePacer.OnSubmit();
 
-			float elapsed = timer.GetElapsedMs();
+			float elapsed = m_FramePacer.EndFrame();
 
 			m_Time.DeltaTime = elapsed / 1000.f;
 
 			Stats::Data.Frametime = elapsed;
 			Stats::Data.Fps = 1000.f / Stats::Data.Frametime;
+			Stats::Data.InputLatency = m_FramePacer.GetInputLatency();
+			Stats::Data.FrametimeVariance = m_FramePacer.GetFrametimeVariance();
 		}
 	}
 
@@ -108,13 +145,34 @@ namespace Spike {
 		}
 	}
 
+	void Application::EnqueueEvent(std::function<void()>&& event) {
+		while (!m_EventQueue.TryPush(std::move(event))) {
+
+			// the main thread is the only consumer, so it makes room itself instead of waiting on itself
+			// popped events go behind the ones already taken, the order stays the same
+			if (std::this_thread::get_id() == m_MainThreadID) {
+				m_EventQueue.PopBatch(m_ProcessedEvents);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
 	void Application::ProcessEvents() {
-		std::vector<std::function<void()>> queue{};
+		// bounded, so events pushed while processing wait for the next frame
+		m_EventQueue.PopBatch(m_ProcessedEvents, m_EventQueue.GetCapacity());
 
-		m_EventQueue.PopAll(queue);
-		for (auto& func : queue) {
+		// events can append to the list when they push into a full ring, so it is walked by index
+		for (size_t i = 0; i < m_ProcessedEvents.size(); i++) {
+			std::function<void()> func = std::move(m_ProcessedEvents[i]);
 			func();
 		}
+		m_ProcessedEvents.clear();
+
+		m_EventBus.Flush([this](const GenericEvent& event) {
+			OnEvent(event);
+			});
 	}
 
 	void Application::PushLayer(Layer* layer) {
@@ -3,10 +3,13 @@
 #include <Engine/Core/Window.h>
 #include <Engine/Renderer/GfxDevice.h>
 #include <Engine/Events/ApplicationEvents.h>
+#include <Engine/Events/EventBus.h>
 #include <Engine/Core/LayerStack.h>
 #include <Engine/Layers/RenderLayer.h>
 #include <Engine/Core/Timestep.h>
+#include <Engine/Core/FramePacer.h>
 #include <Engine/Core/Core.h>
+#include <Engine/Multithreading/MPMCQueue.h>
 
 namespace Spike {
 
@@ -16,6 +19,7 @@ namespace Spike {
 		bool UsingImGui;
 		bool UsingDocking;
 		WindowDesc WindowDesc;
+		FramePacerDesc PacerDesc;
 	};
 
 	class Application {
@@ -33,27 +37,26 @@ namespace Spike {
 		void Tick();
 
 		// events
-		void EnqueueEvent(std::function<void()>&& event) {
-			m_EventQueue.Push(std::move(event));
-		}
+		// can be called from any thread
+		void EnqueueEvent(std::function<void()>&& event);
 
 		template<typename T, typename... Args, bool DispatchImmediate = false>
 		void DispatchEvent(Args&&... args) {
 
-			std::shared_ptr<T> event = std::make_shared<T>(std::forward<Args>(args)...);
 			if constexpr (DispatchImmediate) {
-				OnEvent(*event);
+				T event(std::forward<Args>(args)...);
+				OnEvent(event);
 			}
 			else {
-				EnqueueEvent([event, this]() {
-					OnEvent(*event);
-					});
+				m_EventBus.Push<T>(std::forward<Args>(args)...);
 			}
 		}
 
 		Window* GetMainWindow() { return m_Window; }
 		RenderLayer* GetRenderLayer() { return m_RenderLayer; }
 		RenderThread& GetRenderThread() { return m_RenderThread; }
+		FramePacer& GetFramePacer() { return m_FramePacer; }
+		std::thread::id GetMainThreadID() const { return m_MainThreadID; }
 
 		bool IsUsingImGui() const { return m_UsingImGui; }
 		bool IsUsingDocking() const { return m_UsingDocking; }
@@ -72,8 +75,11 @@ namespace Spike {
 
 		LayerStack m_LayerStack;
 		RenderThread m_RenderThread;
+		std::thread::id m_MainThreadID;
 
-		ThreadSafeQueue<std::function<void()>> m_EventQueue;
+		MPMCQueue<std::function<void()>> m_EventQueue;
+		std::vector<std::function<void()>> m_ProcessedEvents; // main thread only
+		EventBus m_EventBus;
 		//ThreadSafeQueue<std::function<void()>> m_DeletorsQueue;
 
 		bool m_Running = false;
@@ -84,6 +90,7 @@ namespace Spike {
 		RenderLayer* m_RenderLayer;
 
 		Time m_Time;
+		FramePacer m_FramePacer;
 
 		static Application* s_Instance;
 	};
@@ -0,0 +1,137 @@
+#include <Engine/Core/FramePacer.h>
+
+#include <thread>
+#include <algorithm>
+
+namespace Spike {
+
+	// utility
+	static float ToMs(std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration<float, std::milli>(duration).count();
+	}
+
+	static std::chrono::steady_clock::duration FromMs(float ms) {
+		return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(ms));
+	}
+
+	void FramePacer::SetDesc(const FramePacerDesc& desc) {
+		m_Desc = desc;
+
+		// restart the pacing grid
+		m_NextFrame = Clock::time_point{};
+	}
+
+	float FramePacer::GetTargetFrametime() const {
+
+		switch (m_Desc.Mode)
+		{
+		case EFramePacingMode::EFixedRate:
+			return m_Desc.TargetFps > 0.f ? 1000.f / m_Desc.TargetFps : 0.f;
+		case EFramePacingMode::EDisplayRefresh:
+			return 1000.f / (m_RefreshRate > 0.f ? m_RefreshRate : 60.f);
+		default:
+			return 0.f;
+		}
+	}
+
+	void FramePacer::WaitForFrame() {
+		Clock::time_point now = Clock::now();
+
+		float period = GetTargetFrametime();
+		if (period <= 0.f) {
+			m_FrameStart = now;
+			return;
+		}
+
+		Clock::time_point slotStart = m_NextFrame;
+		Clock::duration periodDuration = FromMs(period);
+
+		// fell behind by more than a frame, restart the grid instead of catching up
+		if (now > slotStart + periodDuration) {
+			slotStart = now;
+		}
+		m_NextFrame = slotStart + periodDuration;
+
+		Clock::time_point start = slotStart;
+		if (m_Desc.LowLatency) {
+
+			// start as late as possible, so submission lands right before the slot ends
+			const float margin = 0.5f;
+			float delay = std::max(period - m_WorkTime - margin, 0.f);
+
+			start += FromMs(delay);
+		}
+
+		SleepUntil(start);
+		m_FrameStart = Clock::now();
+	}
+
+	void FramePacer::SleepUntil(Clock::time_point time) {
+
+		while (true) {
+			Clock::time_point now = Clock::now();
+			if (now >= time) break;
+
+			if (ToMs(time - now) > m_SleepEstimate) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+				// the estimate grows instantly but decays slowly, oversleeping costs more than spinning
+				float slept = ToMs(Clock::now() - now);
+				m_SleepEstimate = std::max(slept, m_SleepEstimate * 0.99f + slept * 0.01f);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void FramePacer::OnInputSampled() {
+		m_InputSampled = Clock::now();
+	}
+
+	void FramePacer::OnSimulationStart() {
+		m_SimulationStart = Clock::now();
+
+		// input the simulation is about to consume
+		m_ConsumedInput = m_InputSampled;
+	}
+
+	void FramePacer::OnSubmit() {
+		Clock::time_point now = Clock::now();
+
+		if (m_ConsumedInput != Clock::time_point{}) {
+			m_InputLatency = ToMs(now - m_ConsumedInput);
+		}
+
+		float work = ToMs(now - m_SimulationStart);
+		m_WorkTime = (m_WorkTime == 0.f) ? work : m_WorkTime * 0.9f + work * 0.1f;
+	}
+
+	float FramePacer::EndFrame() {
+		Clock::time_point now = Clock::now();
+
+		Clock::time_point last = (m_LastFrameEnd != Clock::time_point{}) ? m_LastFrameEnd : m_FrameStart;
+		m_LastFrameEnd = now;
+
+		float frametime = ToMs(now - last);
+
+		m_Frametimes[m_FrametimeIdx] = frametime;
+		m_FrametimeIdx = (m_FrametimeIdx + 1) % (uint32_t)m_Frametimes.size();
+		m_NumFrametimes = std::min(m_NumFrametimes + 1, (uint32_t)m_Frametimes.size());
+
+		float mean = 0.f;
+		for (uint32_t i = 0; i < m_NumFrametimes; i++) {
+			mean += m_Frametimes[i];
+		}
+		mean /= (float)m_NumFrametimes;
+
+		float variance = 0.f;
+		for (uint32_t i = 0; i < m_NumFrametimes; i++) {
+			float diff = m_Frametimes[i] - mean;
+			variance += diff * diff;
+		}
+		m_FrametimeVariance = variance / (float)m_NumFrametimes;
+
+		return frametime;
+	}
+}
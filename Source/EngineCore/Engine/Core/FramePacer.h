@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <array>
+#include <cstdint>
+
+namespace Spike {
+
+	enum class EFramePacingMode : uint8_t {
+
+		EUnlimited = 0,
+		EFixedRate,
+		EDisplayRefresh
+	};
+
+	struct FramePacerDesc {
+
+		EFramePacingMode Mode = EFramePacingMode::EUnlimited;
+
+		// used only with fixed rate mode
+		float TargetFps = 60.f;
+
+		// delays simulation start, so input is sampled as late as possible before submission
+		bool LowLatency = false;
+	};
+
+	class FramePacer {
+	public:
+		FramePacer() {}
+		~FramePacer() {}
+
+		void SetDesc(const FramePacerDesc& desc);
+		const FramePacerDesc& GetDesc() const { return m_Desc; }
+
+		// display refresh rate in hz, 0 if unknown
+		void SetRefreshRate(float refreshRate) { m_RefreshRate = refreshRate; }
+
+		// blocks until the next frame is allowed to start
+		void WaitForFrame();
+
+		void OnInputSampled();
+		void OnSimulationStart();
+		void OnSubmit();
+
+		// returns frame time in ms
+		float EndFrame();
+
+		float GetTargetFrametime() const;
+		float GetInputLatency() const { return m_InputLatency; }
+		float GetFrametimeVariance() const { return m_FrametimeVariance; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		void SleepUntil(Clock::time_point time);
+
+	private:
+		FramePacerDesc m_Desc;
+		float m_RefreshRate = 0.f;
+
+		Clock::time_point m_FrameStart;
+		Clock::time_point m_NextFrame;
+		Clock::time_point m_InputSampled;
+		Clock::time_point m_ConsumedInput;
+		Clock::time_point m_SimulationStart;
+		Clock::time_point m_LastFrameEnd;
+
+		// smoothed time from simulation start till submit in ms
+		float m_WorkTime = 0.f;
+		float m_InputLatency = 0.f;
+
+		// how long a 1ms sleep actually takes, anything shorter is spun
+		float m_SleepEstimate = 2.f;
+
+		std::array<float, 120> m_Frametimes{};
+		uint32_t m_NumFrametimes = 0;
+		uint32_t m_FrametimeIdx = 0;
+		float m_FrametimeVariance = 0.f;
+	};
+}
@@ -2,5 +2,5 @@
 
 namespace Spike {
 
-	Layer::Layer(const std::string& name) : m_Name(name) {}
+	Layer::Layer(const std::string& name, bool independent) : m_Name(name), m_Independent(independent) {}
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace Spike {
 
 	class Layer {
 	public:
-		Layer(const std::string& name = "New Layer");
+		Layer(const std::string& name = "New Layer", bool independent = false);
 		virtual ~Layer() = default;
 
 		virtual void Tick(float deltaTime) {}
@@ -18,8 +18,13 @@ namespace Spike {
 
 		const std::string& GetName() const { return m_Name; }
 
+		// independent layers tick on worker threads alongside other layers,
+		// so they must not touch imgui or push render commands directly
+		bool IsIndependent() const { return m_Independent; }
+
 	private:
 		std::string m_Name;
+		bool m_Independent;
 	};
 }
 
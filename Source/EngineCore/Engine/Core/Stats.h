@@ -7,6 +7,11 @@ namespace Spike {
 		float Fps;
 		float Frametime;
 
+		// in ms, from input sampling till the frame is handed to the render thread
+		float InputLatency;
+		// in ms^2, over the last 120 frames
+		float FrametimeVariance;
+
 		int TriangleCount;
 		int DrawcallCount;
 		float SceneUpdateTime;
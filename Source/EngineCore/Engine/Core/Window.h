@@ -24,6 +24,9 @@ namespace Spike {
 		virtual const std::string& GetName() const = 0;
 		virtual void* GetNativeWindow() const = 0;
 
+		// refresh rate of the display the window is on, 0 if unknown
+		virtual float GetRefreshRate() const = 0;
+
 		virtual void Tick() = 0;
 
 		using EventCallbackFn = std::function<void(const GenericEvent&)>;
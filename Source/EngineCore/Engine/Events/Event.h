@@ -8,7 +8,10 @@ namespace Spike {
 
 		ENone = 0, 
 		EWindowResize, EWindowClose, EWindowMinimize, EWindowRestore, ESDL,
-		EAssetImported
+		EAssetImported,
+
+		// number of event types, keep last
+		ECount
 	};
 
 	class GenericEvent {
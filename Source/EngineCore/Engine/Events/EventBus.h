@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Engine/Events/Event.h>
+#include <mutex>
+#include <atomic>
+
+namespace Spike {
+
+	class EventChannelBase {
+	public:
+		virtual ~EventChannelBase() = default;
+
+		// dispatches queued events in the order they were pushed
+		virtual void Flush(const std::function<void(const GenericEvent&)>& func) = 0;
+	};
+
+	// events of a single type stored by value, buffers are reused between flushes
+	template<typename T>
+	class EventChannel : public EventChannelBase {
+	public:
+		EventChannel(size_t capacity) {
+			m_Pending.reserve(capacity);
+			m_Processing.reserve(capacity);
+		}
+		virtual ~EventChannel() override {}
+
+		template<typename... Args>
+		void Push(Args&&... args) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Pending.emplace_back(std::forward<Args>(args)...);
+		}
+
+		virtual void Flush(const std::function<void(const GenericEvent&)>& func) override {
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				std::swap(m_Pending, m_Processing);
+			}
+
+			// events pushed by handlers land in the pending buffer, and are dispatched on the next flush
+			for (const T& event : m_Processing) {
+				func(event);
+			}
+			m_Processing.clear();
+		}
+
+	private:
+		std::mutex m_Mutex;
+
+		std::vector<T> m_Pending;
+		std::vector<T> m_Processing;
+	};
+
+	class EventBus {
+	public:
+		EventBus() {
+			for (auto& channel : m_Channels) {
+				channel.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~EventBus() {
+			for (auto& channel : m_Channels) {
+				delete channel.load(std::memory_order_relaxed);
+			}
+		}
+
+		// can be called from any thread
+		template<typename T, typename... Args>
+		void Push(Args&&... args) {
+			GetChannel<T>()->Push(std::forward<Args>(args)...);
+		}
+
+		// channels are flushed in event type order
+		void Flush(const std::function<void(const GenericEvent&)>& func) {
+
+			for (auto& channel : m_Channels) {
+				EventChannelBase* ptr = channel.load(std::memory_order_acquire);
+				if (ptr) ptr->Flush(func);
+			}
+		}
+
+	private:
+		template<typename T>
+		EventChannel<T>* GetChannel() {
+
+			uint32_t idx = (uint32_t)T::GetStaticType();
+			EventChannelBase* channel = m_Channels[idx].load(std::memory_order_acquire);
+
+			if (!channel) {
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				channel = m_Channels[idx].load(std::memory_order_relaxed);
+				if (!channel) {
+					const size_t defaultCapacity = 32;
+
+					channel = new EventChannel<T>(defaultCapacity);
+					m_Channels[idx].store(channel, std::memory_order_release);
+				}
+			}
+
+			return (EventChannel<T>*)channel;
+		}
+
+	private:
+		std::array<std::atomic<EventChannelBase*>, (size_t)EEventType::ECount> m_Channels;
+		std::mutex m_Mutex;
+	};
+}
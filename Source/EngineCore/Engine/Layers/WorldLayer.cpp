@@ -2,5 +2,17 @@
 
 namespace Spike {
 
+	void WorldLayer::Tick(float deltaTime) {
+		if (m_Current.Valid()) {
+			m_Current->Tick(deltaTime);
+		}
+	}
 
-}
\ No newline at end of file
+	void WorldLayer::OnAttach() {}
+
+	void WorldLayer::OnDetach() {
+		m_Current = nullptr;
+	}
+
+	void WorldLayer::OnEvent(const GenericEvent& /*event*/) {}
+}
@@ -7,14 +7,17 @@ namespace Spike {
 
 	class WorldLayer : public Layer {
 	public:
-		WorldLayer() : Layer("World Layer") {}
+		// world ticks only talk to the renderer through the render thread queue, so they can run on a worker
+		WorldLayer() : Layer("World Layer", true) {}
 		virtual ~WorldLayer() override {}
 
 		virtual void Tick(float deltaTime) override;
 		virtual void OnAttach() override;
 		virtual void OnDetach() override;
 
-		void LoadWorld(const BinaryReadStream& stream) { m_Current = World::Create(stream); }
+		void LoadWorld(const std::filesystem::path& path) { m_Current = World::Create(path); }
+		void SetWorld(const Ref<World>& world) { m_Current = world; }
+		const Ref<World>& GetWorld() const { return m_Current; }
 		virtual void OnEvent(const GenericEvent& event) override;
 
 	private:
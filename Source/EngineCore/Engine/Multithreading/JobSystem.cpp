@@ -0,0 +1,154 @@
+#include <Engine/Multithreading/JobSystem.h>
+
+#include <algorithm>
+
+Spike::JobSystem* Spike::GJobSystem = nullptr;
+
+namespace Spike {
+
+	static thread_local bool s_IsWorkerThread = false;
+
+	void JobCounter::Done() {
+		std::vector<std::function<void()>> waiters;
+
+		// raised before the count drops, IsDone stays false until the counter is no longer touched
+		m_Finishing.fetch_add(1);
+
+		if (m_Count.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			waiters = std::move(m_Waiters);
+			m_Waiters.clear();
+		}
+
+		// last access, the owner may destroy the counter from here on
+		m_Finishing.fetch_sub(1);
+
+		for (auto& func : waiters) {
+			func();
+		}
+	}
+
+	bool JobCounter::AddWaiter(std::function<void()>&& func) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// the last Done takes the waiters under this lock right after the count drops to zero
+		if (m_Count.load() == 0) return false;
+
+		m_Waiters.push_back(std::move(func));
+		return true;
+	}
+
+	JobSystem::JobSystem(uint32_t numWorkers) {
+
+		if (numWorkers == 0) {
+			uint32_t hwThreads = std::thread::hardware_concurrency();
+
+			// leave room for main and render threads
+			numWorkers = hwThreads > 3 ? hwThreads - 2 : 1;
+		}
+
+		m_Workers.reserve(numWorkers);
+		for (uint32_t i = 0; i < numWorkers; i++) {
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_ShouldTerminate = true;
+		}
+		m_Condition.notify_all();
+
+		for (auto& worker : m_Workers) {
+			worker.join();
+		}
+	}
+
+	void JobSystem::Schedule(Func&& func, JobCounter* counter) {
+
+		if (counter) counter->Add();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Queue.push_back(Job{ .Function = std::move(func), .Counter = counter });
+		}
+		m_Condition.notify_one();
+	}
+
+	void JobSystem::Wait(JobCounter& counter) {
+
+		while (!counter.IsDone()) {
+			if (!TryRunJob(&counter)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t minBatch, const std::function<void(uint32_t first, uint32_t last)>& func) {
+		if (count == 0) return;
+
+		// a few ranges per thread, so uneven ranges even out
+		uint32_t maxRanges = (GetNumWorkers() + 1) * 4;
+		uint32_t numRanges = std::min((count + minBatch - 1) / std::max(minBatch, 1u), maxRanges);
+
+		if (numRanges <= 1) {
+			func(0, count);
+			return;
+		}
+
+		uint32_t rangeSize = (count + numRanges - 1) / numRanges;
+		JobCounter counter{};
+
+		for (uint32_t first = rangeSize; first < count; first += rangeSize) {
+			uint32_t last = std::min(first + rangeSize, count);
+
+			Schedule([&func, first, last]() { func(first, last); }, &counter);
+		}
+
+		func(0, std::min(rangeSize, count));
+		Wait(counter);
+	}
+
+	bool JobSystem::IsWorkerThread() const {
+		return s_IsWorkerThread;
+	}
+
+	bool JobSystem::TryRunJob(const JobCounter* counter) {
+		Job job{};
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			// jobs of a waiter are usually the last ones scheduled
+			auto it = std::find_if(m_Queue.rbegin(), m_Queue.rend(), [counter](const Job& queued) { return queued.Counter == counter; });
+			if (it == m_Queue.rend()) return false;
+
+			job = std::move(*it);
+			m_Queue.erase(std::next(it).base());
+		}
+
+		job.Function();
+		if (job.Counter) job.Counter->Done();
+
+		return true;
+	}
+
+	void JobSystem::WorkerLoop() {
+		s_IsWorkerThread = true;
+
+		while (true) {
+			Job job{};
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_ShouldTerminate || !m_Queue.empty(); });
+
+				if (m_ShouldTerminate && m_Queue.empty()) break;
+
+				job = std::move(m_Queue.front());
+				m_Queue.pop_front();
+			}
+
+			job.Function();
+			if (job.Counter) job.Counter->Done();
+		}
+	}
+}
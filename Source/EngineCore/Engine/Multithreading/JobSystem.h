@@ -0,0 +1,76 @@
+#pragma once
+
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <deque>
+
+namespace Spike {
+
+	// counts outstanding jobs, fires registered waiters once it drops to zero
+	class JobCounter {
+	public:
+		JobCounter() : m_Count(0), m_Finishing(0) {}
+		~JobCounter() {}
+
+		void Add(uint32_t count = 1) { m_Count.fetch_add(count); }
+		void Done();
+
+		// also waits for Done calls still touching the counter, so a done counter can be destroyed right away
+		bool IsDone() const { return m_Count.load() == 0 && m_Finishing.load() == 0; }
+
+		// returns false if the counter is already done, func is not stored then
+		bool AddWaiter(std::function<void()>&& func);
+
+	private:
+		std::atomic<uint32_t> m_Count;
+		std::atomic<uint32_t> m_Finishing;
+
+		std::mutex m_Mutex;
+		std::vector<std::function<void()>> m_Waiters;
+	};
+
+	class JobSystem {
+	public:
+		// 0 - use all hardware threads except main and render
+		JobSystem(uint32_t numWorkers = 0);
+		~JobSystem();
+
+		using Func = std::function<void()>;
+		void Schedule(Func&& func, JobCounter* counter = nullptr);
+
+		// blocks the calling thread, but helps executing queued jobs of this counter meanwhile
+		// other jobs are left to workers, so a frame never picks up a long file read or decode
+		void Wait(JobCounter& counter);
+
+		// splits [0, count) into ranges of at least minBatch elements and runs them on workers,
+		// the calling thread takes one range itself and returns once all of them are done
+		void ParallelFor(uint32_t count, uint32_t minBatch, const std::function<void(uint32_t first, uint32_t last)>& func);
+
+		uint32_t GetNumWorkers() const { return (uint32_t)m_Workers.size(); }
+		bool IsWorkerThread() const;
+
+	private:
+		void WorkerLoop();
+		bool TryRunJob(const JobCounter* counter);
+
+	private:
+		struct Job {
+			Func Function;
+			JobCounter* Counter;
+		};
+
+		std::vector<std::thread> m_Workers;
+		std::deque<Job> m_Queue;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_ShouldTerminate = false;
+	};
+
+	// global job system pointer
+	extern JobSystem* GJobSystem;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <new>
+
+namespace Spike {
+
+	// bounded lock free queue, any number of producers and consumers
+	// each cell carries a sequence number, producers and consumers only contend on the head or tail counter
+	template<typename T>
+	class MPMCQueue {
+	public:
+		// capacity is rounded up to a power of two
+		MPMCQueue(size_t capacity = 4096) {
+
+			size_t size = 2;
+			while (size < capacity) size <<= 1;
+
+			m_Mask = size - 1;
+			m_Cells = std::make_unique<Cell[]>(size);
+
+			for (size_t i = 0; i < size; i++) {
+				m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+
+			m_Head.Value.store(0, std::memory_order_relaxed);
+			m_Tail.Value.store(0, std::memory_order_relaxed);
+		}
+
+		~MPMCQueue() {
+			while (Consume([](T&&) {})) {}
+		}
+
+		MPMCQueue(const MPMCQueue& other) = delete;
+		MPMCQueue& operator=(const MPMCQueue& other) = delete;
+
+		// returns false if the queue is full, element is left untouched then
+		bool TryPush(T&& element) { return Emplace(std::move(element)); }
+		bool TryPush(const T& element) { return Emplace(element); }
+
+		bool TryPop(T& out) {
+			return Consume([&](T&& element) { out = std::move(element); });
+		}
+
+		// pops up to maxCount elements straight into out, claims all ready cells with a single cas
+		size_t PopBatch(std::vector<T>& out, size_t maxCount = SIZE_MAX) {
+			size_t pos = m_Tail.Value.load(std::memory_order_relaxed);
+
+			while (true) {
+				size_t count = 0;
+				while (count < maxCount && count <= m_Mask) {
+
+					size_t seq = m_Cells[(pos + count) & m_Mask].Sequence.load(std::memory_order_acquire);
+					if (seq != pos + count + 1) break;
+
+					count++;
+				}
+
+				if (count == 0) {
+					size_t current = m_Tail.Value.load(std::memory_order_relaxed);
+					if (current == pos) return 0;
+
+					pos = current;
+					continue;
+				}
+
+				// ready cells can change only after someone else moved the tail, the cas fails then
+				if (m_Tail.Value.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+					out.reserve(out.size() + count);
+
+					for (size_t i = 0; i < count; i++) {
+						Cell& cell = m_Cells[(pos + i) & m_Mask];
+						T* data = cell.GetData();
+
+						out.push_back(std::move(*data));
+						data->~T();
+
+						cell.Sequence.store(pos + i + m_Mask + 1, std::memory_order_release);
+					}
+
+					return count;
+				}
+			}
+		}
+
+		size_t GetCapacity() const { return m_Mask + 1; }
+
+	private:
+		template<typename F>
+		bool Consume(F&& func) {
+			Cell* cell;
+			size_t pos = m_Tail.Value.load(std::memory_order_relaxed);
+
+			while (true) {
+				cell = &m_Cells[pos & m_Mask];
+				size_t seq = cell->Sequence.load(std::memory_order_acquire);
+				intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+				if (diff == 0) {
+					if (m_Tail.Value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = m_Tail.Value.load(std::memory_order_relaxed);
+				}
+			}
+
+			T* data = cell->GetData();
+			func(std::move(*data));
+			data->~T();
+
+			cell->Sequence.store(pos + m_Mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		template<typename U>
+		bool Emplace(U&& element) {
+			Cell* cell;
+			size_t pos = m_Head.Value.load(std::memory_order_relaxed);
+
+			while (true) {
+				cell = &m_Cells[pos & m_Mask];
+				size_t seq = cell->Sequence.load(std::memory_order_acquire);
+				intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+				if (diff == 0) {
+					if (m_Head.Value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = m_Head.Value.load(std::memory_order_relaxed);
+				}
+			}
+
+			new (cell->Storage) T(std::forward<U>(element));
+			cell->Sequence.store(pos + 1, std::memory_order_release);
+
+			return true;
+		}
+
+	private:
+		static constexpr size_t CacheLineSize = 64;
+
+		struct Cell {
+			std::atomic<size_t> Sequence;
+			alignas(T) unsigned char Storage[sizeof(T)];
+
+			T* GetData() { return std::launder((T*)Storage); }
+		};
+
+		struct alignas(CacheLineSize) PaddedCounter {
+			std::atomic<size_t> Value;
+		};
+
+		PaddedCounter m_Head;
+		PaddedCounter m_Tail;
+
+		alignas(CacheLineSize) std::unique_ptr<Cell[]> m_Cells;
+		size_t m_Mask;
+	};
+}
@@ -12,8 +12,11 @@ namespace Spike {
 	}
 
 	void RenderThread::Process() {
-		m_RTQueue = std::move(m_Queue);
-		m_Queue.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_RTQueue = std::move(m_Queue);
+			m_Queue.clear();
+		}
 
 		m_BlockSemaphore.release();
 	}
@@ -4,6 +4,7 @@
 #include <functional>
 #include <semaphore>
 #include <mutex>
+#include <vector>
 
 namespace Spike {
 
@@ -16,7 +17,12 @@ namespace Spike {
 		void Terminate();
 
 		using Func = std::function<void()>;
-		void PushTask(Func&& func) { m_Queue.push_back(std::move(func)); }
+
+		// can be called from any thread, independent layers and jobs push while the main thread does
+		void PushTask(Func&& func) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Queue.push_back(std::move(func));
+		}
 
 		void WaitTillDone();
 		void Process();
@@ -30,7 +36,7 @@ namespace Spike {
 		std::thread m_Thread;
 		std::vector<Func> m_Queue;
 		std::vector<Func> m_RTQueue;
-		//std::mutex m_Mutex;
+		std::mutex m_Mutex;
 
 		std::binary_semaphore m_BlockSemaphore{ 0 };
 		std::binary_semaphore m_WaitSemaphore{ 1 };
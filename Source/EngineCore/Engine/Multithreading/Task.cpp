@@ -0,0 +1,100 @@
+#include <Engine/Multithreading/Task.h>
+#include <Engine/Renderer/FrameRenderer.h>
+#include <Engine/Core/Application.h>
+#include <Engine/Core/Log.h>
+
+namespace Spike {
+
+	// utility
+	static EThreadType ResolveResumeThread(EThreadType thread) {
+
+		if (thread != EThreadType::ENone) return thread;
+
+		EThreadType current = GetCurrentThreadType();
+		return current != EThreadType::ENone ? current : EThreadType::EWorker;
+	}
+
+	EThreadType GetCurrentThreadType() {
+		std::thread::id id = std::this_thread::get_id();
+
+		if (id == Application::Get().GetMainThreadID()) return EThreadType::EMain;
+		if (id == Application::Get().GetRenderThread().GetID()) return EThreadType::ERender;
+		if (GJobSystem && GJobSystem->IsWorkerThread()) return EThreadType::EWorker;
+
+		return EThreadType::ENone;
+	}
+
+	void ScheduleOnThread(EThreadType thread, std::function<void()>&& func) {
+
+		switch (thread)
+		{
+		case EThreadType::EMain:
+			Application::Get().EnqueueEvent(std::move(func));
+			break;
+		case EThreadType::ERender:
+
+			// render thread tasks can only be pushed from the main thread
+			if (GetCurrentThreadType() == EThreadType::EMain) {
+				SUBMIT_RENDER_COMMAND(std::move(func));
+			}
+			else {
+				Application::Get().EnqueueEvent([f = std::move(func)]() mutable {
+					SUBMIT_RENDER_COMMAND(std::move(f));
+					});
+			}
+			break;
+		case EThreadType::EWorker:
+			GJobSystem->Schedule(std::move(func));
+			break;
+		default:
+			ENGINE_ERROR("Invalid thread type to schedule on!");
+			break;
+		}
+	}
+
+	void ReadFileAwaiter::await_suspend(std::coroutine_handle<> handle) {
+		EThreadType resumeOn = ResolveResumeThread(m_ResumeOn);
+
+		GJobSystem->Schedule([this, handle, resumeOn]() {
+			std::ifstream stream(m_Path, std::ios::binary | std::ios::ate);
+
+			if (stream.is_open()) {
+				size_t size = (size_t)stream.tellg();
+				m_Data.resize(size);
+
+				stream.seekg(0);
+				stream.read((char*)m_Data.data(), size);
+			}
+			else {
+				ENGINE_ERROR("Failed to open file for async read: {}", m_Path.string());
+			}
+
+			ScheduleOnThread(resumeOn, [handle]() { handle.resume(); });
+			});
+	}
+
+	bool JobCounterAwaiter::await_suspend(std::coroutine_handle<> handle) {
+		EThreadType resumeOn = ResolveResumeThread(m_ResumeOn);
+
+		return m_Counter.AddWaiter([handle, resumeOn]() {
+			ScheduleOnThread(resumeOn, [handle]() { handle.resume(); });
+			});
+	}
+
+	void GPUFrameAwaiter::await_suspend(std::coroutine_handle<> handle) {
+		EThreadType resumeOn = ResolveResumeThread(m_ResumeOn);
+
+		// frame queue is flushed right after the frame fence was waited on
+		ScheduleOnThread(EThreadType::ERender, [handle, resumeOn]() {
+			GFrameRenderer->SubmitToFrameQueue([handle, resumeOn]() {
+
+				if (resumeOn == EThreadType::ERender) {
+					handle.resume();
+				}
+				else {
+					ScheduleOnThread(resumeOn, [handle]() { handle.resume(); });
+				}
+				});
+			});
+	}
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <coroutine>
+#include <optional>
+#include <filesystem>
+#include <Engine/Multithreading/JobSystem.h>
+
+namespace Spike {
+
+	enum class EThreadType : uint8_t {
+
+		// thread the awaiting coroutine is currently running on
+		ENone = 0,
+		EMain,
+		ERender,
+		EWorker
+	};
+
+	EThreadType GetCurrentThreadType();
+	void ScheduleOnThread(EThreadType thread, std::function<void()>&& func);
+
+	template<typename T>
+	class Task;
+
+	namespace Internal {
+
+		struct TaskPromiseBase {
+
+			struct FinalAwaiter {
+				bool await_ready() const noexcept { return false; }
+
+				template<typename P>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+					TaskPromiseBase& promise = handle.promise();
+
+					if (promise.Continuation) {
+						return promise.Continuation;
+					}
+					if (promise.Detached) {
+						handle.destroy();
+					}
+					return std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			// tasks are lazy, they start once awaited or detached
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+			void unhandled_exception() { std::terminate(); }
+
+			std::coroutine_handle<> Continuation;
+			bool Detached = false;
+		};
+
+		template<typename T>
+		struct TaskPromise : public TaskPromiseBase {
+
+			Task<T> get_return_object();
+			void return_value(T value) { Value = std::move(value); }
+
+			std::optional<T> Value;
+		};
+
+		template<>
+		struct TaskPromise<void> : public TaskPromiseBase {
+
+			Task<void> get_return_object();
+			void return_void() {}
+		};
+	}
+
+	template<typename T = void>
+	class Task {
+	public:
+		using promise_type = Internal::TaskPromise<T>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Task() : m_Handle(nullptr) {}
+		explicit Task(Handle handle) : m_Handle(handle) {}
+		Task(const Task& copy) = delete;
+
+		Task(Task&& move) noexcept : m_Handle(move.m_Handle) {
+			move.m_Handle = nullptr;
+		}
+
+		~Task() { if (m_Handle) m_Handle.destroy(); }
+
+		Task& operator=(Task&& move) noexcept {
+			if (this != &move) {
+				if (m_Handle) m_Handle.destroy();
+
+				m_Handle = move.m_Handle;
+				move.m_Handle = nullptr;
+			}
+			return *this;
+		}
+
+		bool await_ready() const noexcept { return !m_Handle || m_Handle.done(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			m_Handle.promise().Continuation = awaiting;
+			return m_Handle;
+		}
+
+		T await_resume() {
+			if constexpr (!std::is_void_v<T>) {
+				return std::move(*m_Handle.promise().Value);
+			}
+		}
+
+		// starts the task without anyone awaiting it, the frame frees itself on completion
+		void Detach() {
+			Handle handle = m_Handle;
+			m_Handle = nullptr;
+
+			if (handle) {
+				handle.promise().Detached = true;
+				handle.resume();
+			}
+		}
+
+		bool Valid() const { return m_Handle != nullptr; }
+
+	private:
+		Handle m_Handle;
+	};
+
+	template<typename T>
+	Task<T> Internal::TaskPromise<T>::get_return_object() {
+		return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+	}
+
+	inline Task<void> Internal::TaskPromise<void>::get_return_object() {
+		return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+	}
+
+	// moves the awaiting coroutine onto the given thread
+	struct ResumeOnAwaiter {
+
+		bool await_ready() const { return GetCurrentThreadType() == Thread; }
+		void await_suspend(std::coroutine_handle<> handle) const {
+			ScheduleOnThread(Thread, [handle]() { handle.resume(); });
+		}
+		void await_resume() const {}
+
+		EThreadType Thread;
+	};
+
+	inline ResumeOnAwaiter ResumeOn(EThreadType thread) { return ResumeOnAwaiter{ .Thread = thread }; }
+
+	// reads the whole file on a worker thread, empty data on failure
+	class ReadFileAwaiter {
+	public:
+		ReadFileAwaiter(const std::filesystem::path& path, EThreadType resumeOn) : m_Path(path), m_ResumeOn(resumeOn) {}
+
+		bool await_ready() const { return false; }
+		void await_suspend(std::coroutine_handle<> handle);
+		std::vector<uint8_t> await_resume() { return std::move(m_Data); }
+
+	private:
+		std::filesystem::path m_Path;
+		EThreadType m_ResumeOn;
+		std::vector<uint8_t> m_Data;
+	};
+
+	inline ReadFileAwaiter ReadFileAsync(const std::filesystem::path& path, EThreadType resumeOn = EThreadType::ENone) {
+		return ReadFileAwaiter(path, resumeOn);
+	}
+
+	class JobCounterAwaiter {
+	public:
+		JobCounterAwaiter(JobCounter& counter, EThreadType resumeOn) : m_Counter(counter), m_ResumeOn(resumeOn) {}
+
+		bool await_ready() const { return m_Counter.IsDone(); }
+		bool await_suspend(std::coroutine_handle<> handle);
+		void await_resume() const {}
+
+	private:
+		JobCounter& m_Counter;
+		EThreadType m_ResumeOn;
+	};
+
+	inline JobCounterAwaiter WaitForJobs(JobCounter& counter, EThreadType resumeOn = EThreadType::ENone) {
+		return JobCounterAwaiter(counter, resumeOn);
+	}
+
+	// resumes once the gpu has finished the frame that is being recorded when awaited
+	class GPUFrameAwaiter {
+	public:
+		GPUFrameAwaiter(EThreadType resumeOn) : m_ResumeOn(resumeOn) {}
+
+		bool await_ready() const { return false; }
+		void await_suspend(std::coroutine_handle<> handle);
+		void await_resume() const {}
+
+	private:
+		EThreadType m_ResumeOn;
+	};
+
+	inline GPUFrameAwaiter WaitForGPUFrame(EThreadType resumeOn = EThreadType::ENone) {
+		return GPUFrameAwaiter(resumeOn);
+	}
+}
@@ -89,9 +89,20 @@ namespace Spike {
 		desc.UsageFlags = ETextureUsageFlags::ESampled | ETextureUsageFlags::ECopyDst;
 		desc.SamplerDesc = samplDesc;
 
+		if (!stream.CanRead(header.ByteSize)) {
+			ENGINE_ERROR("Truncated cube texture asset file: {}", (uint64_t)id);
+			return nullptr;
+		}
+
 		uint8_t* buff = new uint8_t[header.ByteSize];
 		stream.ReadRaw(buff, header.ByteSize);
 
+		if (!stream.IsValid()) {
+			ENGINE_ERROR("Truncated cube texture asset file: {}", (uint64_t)id);
+			delete[] buff;
+			return nullptr;
+		}
+
 		Ref<CubeTexture> tex = CreateRef<CubeTexture>(desc, id);
 		SUBMIT_RENDER_COMMAND(([rhi = tex->GetResource(), sizes = std::move(mipSizes), copySize = header.ByteSize, buff]() {
 
@@ -107,7 +118,10 @@ namespace Spike {
 					offset += sizes[m];
 				}
 			}
-			GRHIDevice->CopyDataToTexture(buff, 0, rhi, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRV, regions, copySize);
+			// recorded on a transient buffer, so streaming textures in doesn't stall the render thread on a gpu wait
+			RHICommandBuffer* cmd = GRHIDevice->AcquireTransientCommandBuffer();
+			GRHIDevice->CopyDataToTexture(cmd, buff, 0, rhi, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRV, regions, copySize);
+			GRHIDevice->SubmitTransientCommandBuffer(cmd);
 			delete[] buff;
 			}));
 
@@ -1,10 +1,12 @@
 #include <Engine/Renderer/DefaultFeatures.h>
 #include <Engine/Core/Log.h>
 #include <Engine/Utils/RenderUtils.h>
+#include <Engine/Utils/Geometry.h>
 
 #include <Generated/IndirectCull.h>
 #include <Generated/DepthPyramid.h>
 #include <Generated/DeferredLighting.h>
+#include <Generated/LightClusters.h>
 #include <Generated/SSAOGen.h>
 #include <Generated/SSAOComposite.h>
 #include <Generated/BloomDownSample.h>
@@ -23,6 +25,15 @@
 
 namespace Spike {
 
+	// stages of the cull shader, run in this order for each cull pass
+	static constexpr uint32_t CULL_STAGE_INSTANCES = 0;
+	static constexpr uint32_t CULL_STAGE_EMIT = 1;
+	static constexpr uint32_t CULL_STAGE_COMPACT = 2;
+	static constexpr uint32_t CULL_STAGE_MESHLETS = 3;
+
+	// coarser lods are picked once their simplification error projects to less than this many pixels
+	static constexpr float LOD_PIXEL_ERROR = 1.f;
+
 	GBufferFeature::GBufferFeature() {
 
 		{
@@ -75,12 +86,6 @@ namespace Spike {
 		uboDesc.MemUsage = EBufferMemUsage::ECPUToGPU;
 		RDGHandle sceneUBO = graphBuilder->CreateRDGBuffer("Scene-UBO", uboDesc);
 
-		BufferDesc batchSSBODesc{};
-		batchSSBODesc.Size = sizeof(uint32_t) * MAX_SHADERS_PER_WORLD;
-		batchSSBODesc.UsageFlags = EBufferUsageFlags::EStorage;
-		batchSSBODesc.MemUsage = EBufferMemUsage::ECPUToGPU;
-		RDGHandle batchSSBO = graphBuilder->CreateRDGBuffer("Batch-SSBO", batchSSBODesc);
-
 		auto roundUpToPowerOfTwo = [](float value) {
 
 			float valueBase = glm::log2(value);
@@ -112,14 +117,106 @@ namespace Spike {
 		RDGHandle hzbTex = graphBuilder->CreateRDGTexture2D("GBuffer-Hzb", hzbDesc);
 
 		graphBuilder->RegisterExternalBuffer(proxy->ObjectsBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->GroupsBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->GroupCountsBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->VisibleInstancesBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->InstanceSlotsBuffer);
 		graphBuilder->RegisterExternalBuffer(proxy->DrawCommandsBuffer);
 		graphBuilder->RegisterExternalBuffer(proxy->DrawCountsBuffer);
 		//graphBuilder->RegisterExternalBuffer(proxy->BatchOffsetsBuffer);
 		graphBuilder->RegisterExternalBuffer(proxy->VisibilityBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->MeshletQueueBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->MeshletDispatchBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->MeshletCommandsBuffer);
+		graphBuilder->RegisterExternalBuffer(proxy->MeshletVisibilityBuffer);
+
+		// the view is culled together with the other views of the frame by the shared passes
+		{
+			CullView& view = m_CullViews.emplace_back(CullView{});
+			view.HzbTexture = hzbTex;
+
+			ViewCullGPUData& data = view.Data;
+			data.View = cameraData->View;
+			data.CameraPos = Vec4(cameraData->Position, 1.f);
+
+			Frustum frustum = Frustum::FromViewProj(cameraData->Proj * cameraData->View);
+			for (int i = 0; i < 6; i++) {
+				data.FrustumPlanes[i] = frustum.Planes[i];
+			}
+
+			data.P00 = cameraData->Proj[0][0];
+			data.P11 = cameraData->Proj[1][1];
+			data.CullZNear = cameraData->Proj[3][2];
+			data.LodErrorScale = 0.5f * context.OutTexture->GetSizeXYZ().y / LOD_PIXEL_ERROR;
+			data.PyramidSize = hzbSize;
+			data.ViewMask = cameraData->ViewMask;
+			data.ViewIndex = context.ViewIndex;
+		}
+
+		// draws the view's list of the last cull pass
+		auto drawGeometry = [=](RHICommandBuffer* cmd, bool prepass) {
+
+			RHIBuffer* ubo = graphBuilder->GetBufferResource(sceneUBO);
+			RHITexture2D* albedo = graphBuilder->GetTextureResource(albedoTex);
+			RHITexture2D* normal = graphBuilder->GetTextureResource(normalTex);
+			RHITexture2D* material = graphBuilder->GetTextureResource(materialTex);
+			RHITexture2D* depth = graphBuilder->GetTextureResource(depthTex);
+
+			RHIBindingSet* meshDrawSet = GRDGPool->GetOrCreateBindingSet(GShaderManager->GetMeshDrawLayout());
+			{
+				meshDrawSet->AddBufferWrite(0, 0, EShaderResourceType::EConstantBuffer, ubo, sizeof(WorldGPUData), 0);
+				meshDrawSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferSRV, proxy->ObjectsBuffer,
+					proxy->ObjectsBuffer->GetSize(), 0);
+				meshDrawSet->AddBufferWrite(2, 0, EShaderResourceType::EBufferSRV, proxy->GroupsBuffer,
+					proxy->GroupsBuffer->GetSize(), 0);
+				meshDrawSet->AddBufferWrite(3, 0, EShaderResourceType::EBufferSRV, proxy->VisibleInstancesBuffer,
+					proxy->VisibleInstancesBuffer->GetSize(), 0);
+			}
+
+			Vec4 colorClear = { 0.0f, 0.0f, 0.0f, 1.0f };
+			Vec2 depthClear = { 0.0f, 0.0f };
+
+			RHIDevice::RenderInfo info{};
+			info.ColorTargets = { albedo->GetTextureView(), normal->GetTextureView(), material->GetTextureView() };
+			info.DepthTarget = depth->GetTextureView();
+			info.ColorClear = prepass ? &colorClear : nullptr;
+			info.DepthClear = prepass ? &depthClear : nullptr;
+			info.DrawSize = { context.OutTexture->GetSizeXYZ().x, context.OutTexture->GetSizeXYZ().y };
 
+			GRHIDevice->BeginRendering(cmd, info);
+
+			for (int i = 0; i < proxy->Batches.size(); i++) {
+
+				WorldDrawBatch currBatch = proxy->Batches[i];
+				if (!currBatch.Shader) continue;
+
+				GRHIDevice->BindShader(cmd, currBatch.Shader, {meshDrawSet, GShaderManager->GetMaterialSet()});
+
+				// commands and counts of the view follow the ones of the views before it
+				uint32_t stride = sizeof(DrawIndirectCommand);
+				uint64_t commandOffset = (uint64_t)context.ViewIndex * proxy->ViewGroupLodsStride + currBatch.CommandOffset;
+				uint64_t countOffset = (uint64_t)context.ViewIndex * VIEW_DRAW_COUNTS + i;
+
+				GRHIDevice->DrawIndirectCount(cmd, proxy->DrawCommandsBuffer, stride * commandOffset, proxy->DrawCountsBuffer,
+					sizeof(uint32_t) * countOffset, currBatch.CommandsCount * MESH_MAX_LODS, stride);
+
+				// visible meshlets of the batch's instances drawn with their finest lod, a command each
+				if (currBatch.MeshletCommandsCount > 0) {
+					uint64_t meshletOffset = (uint64_t)context.ViewIndex * proxy->ViewMeshletCommandsStride + currBatch.MeshletCommandOffset;
+					uint64_t meshletCountOffset = countOffset + MAX_SHADERS_PER_WORLD;
+
+					GRHIDevice->DrawIndirectCount(cmd, proxy->MeshletCommandsBuffer, stride * meshletOffset, proxy->DrawCountsBuffer,
+						sizeof(uint32_t) * meshletCountOffset, currBatch.MeshletCommandsCount, stride);
+				}
+			}
+
+			GRHIDevice->EndRendering(cmd); 
+			};
+
+		// first draw of the view and its hzb, the second cull pass runs after every view got here
 		graphBuilder->AddPass(
 			{ albedoTex, normalTex, materialTex, depthTex, hzbTex },
-			{ sceneUBO, batchSSBO }, 
+			{ sceneUBO }, 
 			ERendererStage::EOpaqueRender, 
 			[=, this](RHICommandBuffer* cmd) {
 
@@ -133,29 +230,9 @@ namespace Spike {
 					worldData->InverseView = glm::inverse(cameraData->View);
 					worldData->CameraPos = Vec4(cameraData->Position, 1.f);
 
-					glm::mat4& vp = worldData->ViewProj;
-					worldData->FrustumPlanes[0] = glm::vec4(
-						vp[0][3] + vp[0][0], vp[1][3] + vp[1][0],
-						vp[2][3] + vp[2][0], vp[3][3] + vp[3][0]);
-					worldData->FrustumPlanes[1] = glm::vec4(
-						vp[0][3] - vp[0][0], vp[1][3] - vp[1][0],
-						vp[2][3] - vp[2][0], vp[3][3] - vp[3][0]);
-					worldData->FrustumPlanes[2] = glm::vec4(
-						vp[0][3] + vp[0][1], vp[1][3] + vp[1][1],
-						vp[2][3] + vp[2][1], vp[3][3] + vp[3][1]);
-					worldData->FrustumPlanes[3] = glm::vec4(
-						vp[0][3] - vp[0][1], vp[1][3] - vp[1][1],
-						vp[2][3] - vp[2][1], vp[3][3] - vp[3][1]);
-					worldData->FrustumPlanes[4] = glm::vec4(
-						vp[0][3] + vp[0][2], vp[1][3] + vp[1][2],
-						vp[2][3] + vp[2][2], vp[3][3] + vp[3][2]);
-					worldData->FrustumPlanes[5] = glm::vec4(
-						vp[0][3] - vp[0][2], vp[1][3] - vp[1][2],
-						vp[2][3] - vp[2][2], vp[3][3] - vp[3][2]);
-
+					Frustum frustum = Frustum::FromViewProj(worldData->ViewProj);
 					for (int i = 0; i < 6; i++) {
-						float length = glm::length(glm::vec3(worldData->FrustumPlanes[i]));
-						worldData->FrustumPlanes[i] /= length;
+						worldData->FrustumPlanes[i] = frustum.Planes[i];
 					}
 
 					worldData->P00 = worldData->Proj[0][0];
@@ -164,6 +241,7 @@ namespace Spike {
 					worldData->FarProj = cameraData->FarProj;
 					worldData->LightsCount = proxy->LightsVB.Size();
 					worldData->ObjectsCount = proxy->ObjectsVB.Size();
+					worldData->GroupsCount = proxy->GroupsVB.Size();
 
 					// TODO: Make serializable and changeble in world settings
 					worldData->SunColor = { 1.0f, 0.7f, 0.6f, 1.0f };
@@ -173,24 +251,6 @@ namespace Spike {
 					worldData->SunDirection = Vec4(-58.823f, -588.235f, 735.394f, 0.0f);
 				}
 
-				std::vector<uint32_t> batchOffsets;
-				RHIBuffer* bSSBO = graphBuilder->GetBufferResource(batchSSBO);
-				batchOffsets.resize(proxy->Batches.size());
-				{
-					uint32_t* offsetsBuffer = (uint32_t*)bSSBO->GetMappedData();
-					for (int i = 0; i < proxy->Batches.size(); i++) {
-
-						if (i > 0) {
-							batchOffsets[i] = proxy->Batches[i - 1].CommandsCount + batchOffsets[i - 1];
-						}
-						else {
-							batchOffsets[i] = 0;
-						}
-
-						offsetsBuffer[i] = batchOffsets[i];
-					}
-				}
-
 				std::vector<RHITextureView*> hzbViews;
 				RHITexture2D* hzb = graphBuilder->GetTextureResource(hzbTex);
 
@@ -212,96 +272,14 @@ namespace Spike {
 				RHITexture2D* material = graphBuilder->GetTextureResource(materialTex);
 				RHITexture2D* depth = graphBuilder->GetTextureResource(depthTex);
 
-				RHIBindingSet* cullSet = GRDGPool->GetOrCreateBindingSet(m_CullShader->GetLayouts()[0]);
+				// first draw
 				{
-					cullSet->AddBufferWrite(0, 0, EShaderResourceType::EBufferUAV, proxy->DrawCommandsBuffer,
-						proxy->DrawCommandsBuffer->GetSize(), 0);
-					cullSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferUAV, proxy->DrawCountsBuffer,
-						proxy->DrawCountsBuffer->GetSize(), 0);
-					cullSet->AddBufferWrite(2, 0, EShaderResourceType::EBufferSRV, bSSBO,
-						bSSBO->GetSize(), 0);
-					cullSet->AddBufferWrite(3, 0, EShaderResourceType::EBufferSRV, proxy->VisibilityBuffer,
-						proxy->VisibilityBuffer->GetSize(), 0);
-					//cullSet->AddBufferWrite(4, 0, EShaderResourceType::EBufferUAV, frameData.VisibilityBuffer,
-					//	sizeof(uint32_t) * scene->Objects.size(), sizeof(uint32_t) * frameData.ObjectsOffset);
-					cullSet->AddTextureWrite(4, 0, EShaderResourceType::ETextureSRV, hzb->GetTextureView(), EGPUAccessFlags::ESRVCompute);
-					cullSet->AddSamplerWrite(5, 0, EShaderResourceType::ESampler, hzb->GetSampler());
-					cullSet->AddBufferWrite(6, 0, EShaderResourceType::EBufferSRV, proxy->ObjectsBuffer,
-						proxy->ObjectsBuffer->GetSize(), 0);
-					cullSet->AddBufferWrite(7, 0, EShaderResourceType::EConstantBuffer, ubo, ubo->GetSize(), 0);
-				}
-
-				auto cullGeometry = [=, this](bool prepass) {
-
-					IndirectCullPushData pushData{};
-					pushData.IsPrepass = prepass ? 1 : 0; 
-
-					if (!prepass) {
-
-						pushData.PyramidSize = hzbSize;
-						pushData.CullZNear = cameraData->Proj[3][2]; 
-					}
-
-					GRHIDevice->BindShader(cmd, m_CullShader, {cullSet}, &pushData);
-
-					uint32_t groupSize = uint32_t((proxy->ObjectsVB.Size() / 256) + 1);
-					GRHIDevice->DispatchCompute(cmd, groupSize, 1, 1);
-
-					graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCommandsBuffer, 
-						proxy->DrawCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs);
-					graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCountsBuffer, 
-						proxy->DrawCountsBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs);
-					};
-
-				RHIBindingSet* meshDrawSet = GRDGPool->GetOrCreateBindingSet(GShaderManager->GetMeshDrawLayout());
-				{
-					meshDrawSet->AddBufferWrite(0, 0, EShaderResourceType::EConstantBuffer, ubo, sizeof(WorldGPUData), 0);
-					meshDrawSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferSRV, proxy->ObjectsBuffer,
-						proxy->ObjectsBuffer->GetSize(), 0);
-				}
-
-				auto drawGeometry = [=](bool prepass) {
-
-					Vec4 colorClear = { 0.0f, 0.0f, 0.0f, 1.0f };
-					Vec2 depthClear = { 0.0f, 0.0f };
-
-					RHIDevice::RenderInfo info{};
-					info.ColorTargets = { albedo->GetTextureView(), normal->GetTextureView(), material->GetTextureView() };
-					info.DepthTarget = depth->GetTextureView();
-					info.ColorClear = prepass ? &colorClear : nullptr;
-					info.DepthClear = prepass ? &depthClear : nullptr;
-					info.DrawSize = { context.OutTexture->GetSizeXYZ().x, context.OutTexture->GetSizeXYZ().y };
-
-					GRHIDevice->BeginRendering(cmd, info);
-
-					for (int i = 0; i < proxy->Batches.size(); i++) {
-
-						WorldDrawBatch currBatch = proxy->Batches[i];
-						GRHIDevice->BindShader(cmd, currBatch.Shader, {meshDrawSet, GShaderManager->GetMaterialSet()});
-
-						uint32_t stride = sizeof(DrawIndirectCommand);
-						uint64_t commandOffset = batchOffsets[i];
-						uint64_t countOffset = i;
-
-						GRHIDevice->DrawIndirectCount(cmd, proxy->DrawCommandsBuffer, stride * commandOffset, proxy->DrawCountsBuffer,
-							sizeof(uint32_t) * countOffset, proxy->ObjectsVB.Size(), stride);
-					}
-
-					GRHIDevice->EndRendering(cmd); 
-					};
-
-				// first cull pass
-				{
-					graphBuilder->BarrierRDGTexture2D(cmd, hzb, EGPUAccessFlags::ESRVCompute);
-
-					cullGeometry(true);
-
 					graphBuilder->BarrierRDGTexture2D(cmd, albedo, EGPUAccessFlags::EColorTarget);
 					graphBuilder->BarrierRDGTexture2D(cmd, normal, EGPUAccessFlags::EColorTarget);
 					graphBuilder->BarrierRDGTexture2D(cmd, material, EGPUAccessFlags::EColorTarget);
 					graphBuilder->BarrierRDGTexture2D(cmd, depth, EGPUAccessFlags::EDepthTarget);
 
-					drawGeometry(true);
+					drawGeometry(cmd, true);
 				}
 
 				// build hzb
@@ -336,18 +314,22 @@ namespace Spike {
 
 					graphBuilder->BarrierRDGTexture2D(cmd, hzb, EGPUAccessFlags::ESRV);
 				}
+			});
 
-				// second cull pass
-				{
-					graphBuilder->FillRDGBuffer(cmd, proxy->DrawCountsBuffer, 
-						proxy->DrawCountsBuffer->GetSize(), 0, 0, EGPUAccessFlags::EUAVCompute);
-					graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCommandsBuffer, 
-						proxy->DrawCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+		// second draw, objects that became visible against the hzb
+		graphBuilder->AddPass(
+			{ albedoTex, normalTex, materialTex, depthTex },
+			{ sceneUBO },
+			ERendererStage::EAfterOpaqueRender,
+			[=](RHICommandBuffer* cmd) {
 
-					cullGeometry(false);
-					graphBuilder->BarrierRDGTexture2D(cmd, depth, EGPUAccessFlags::EDepthTarget);
-					drawGeometry(false);
-				}
+				RHITexture2D* albedo = graphBuilder->GetTextureResource(albedoTex);
+				RHITexture2D* normal = graphBuilder->GetTextureResource(normalTex);
+				RHITexture2D* material = graphBuilder->GetTextureResource(materialTex);
+				RHITexture2D* depth = graphBuilder->GetTextureResource(depthTex);
+
+				graphBuilder->BarrierRDGTexture2D(cmd, depth, EGPUAccessFlags::EDepthTarget);
+				drawGeometry(cmd, false);
 
 				graphBuilder->BarrierRDGTexture2D(cmd, albedo, EGPUAccessFlags::ESRV);
 				graphBuilder->BarrierRDGTexture2D(cmd, normal, EGPUAccessFlags::ESRV);
@@ -356,15 +338,215 @@ namespace Spike {
 			});
 	}
 
+	void GBufferFeature::BuildSharedGraph(RDGBuilder* graphBuilder, const RHIWorldProxy* proxy) {
+		if (m_CullViews.empty()) return;
+
+		std::vector<CullView> views = std::move(m_CullViews);
+		m_CullViews.clear();
+
+		BufferDesc viewsSSBODesc{};
+		viewsSSBODesc.Size = sizeof(ViewCullGPUData) * MAX_RENDER_VIEWS;
+		viewsSSBODesc.UsageFlags = EBufferUsageFlags::EStorage;
+		viewsSSBODesc.MemUsage = EBufferMemUsage::ECPUToGPU;
+		RDGHandle viewsSSBO = graphBuilder->CreateRDGBuffer("Cull-Views", viewsSSBODesc);
+
+		BufferDesc batchSSBODesc{};
+		batchSSBODesc.Size = sizeof(uint32_t) * MAX_SHADERS_PER_WORLD * 2;
+		batchSSBODesc.UsageFlags = EBufferUsageFlags::EStorage;
+		batchSSBODesc.MemUsage = EBufferMemUsage::ECPUToGPU;
+		RDGHandle batchSSBO = graphBuilder->CreateRDGBuffer("Batch-SSBO", batchSSBODesc);
+
+		std::vector<RDGHandle> hzbTextures;
+		for (const CullView& view : views) {
+			hzbTextures.push_back(view.HzbTexture);
+		}
+
+		// every view is a row of the dispatch, so the whole scene is read once per stage for all of them
+		auto cullViews = [=, this](RHICommandBuffer* cmd, bool prepass) {
+
+			RHIBuffer* viewsBuffer = graphBuilder->GetBufferResource(viewsSSBO);
+			RHIBuffer* bSSBO = graphBuilder->GetBufferResource(batchSSBO);
+
+			RHIBindingSet* cullSet = GRDGPool->GetOrCreateBindingSet(m_CullShader->GetLayouts()[0]);
+			{
+				cullSet->AddBufferWrite(0, 0, EShaderResourceType::EBufferUAV, proxy->DrawCommandsBuffer,
+					proxy->DrawCommandsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferUAV, proxy->DrawCountsBuffer,
+					proxy->DrawCountsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(2, 0, EShaderResourceType::EBufferSRV, bSSBO,
+					bSSBO->GetSize(), 0);
+				cullSet->AddBufferWrite(3, 0, EShaderResourceType::EBufferSRV, proxy->VisibilityBuffer,
+					proxy->VisibilityBuffer->GetSize(), 0);
+
+				for (uint32_t i = 0; i < (uint32_t)hzbTextures.size(); i++) {
+					RHITexture2D* hzb = graphBuilder->GetTextureResource(hzbTextures[i]);
+					cullSet->AddTextureWrite(4, i, EShaderResourceType::ETextureSRV, hzb->GetTextureView(), EGPUAccessFlags::ESRVCompute);
+				}
+
+				cullSet->AddSamplerWrite(5, 0, EShaderResourceType::ESampler, graphBuilder->GetTextureResource(hzbTextures[0])->GetSampler());
+				cullSet->AddBufferWrite(6, 0, EShaderResourceType::EBufferSRV, proxy->ObjectsBuffer,
+					proxy->ObjectsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(7, 0, EShaderResourceType::EBufferSRV, viewsBuffer, viewsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(8, 0, EShaderResourceType::EBufferSRV, proxy->GroupsBuffer,
+					proxy->GroupsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(9, 0, EShaderResourceType::EBufferUAV, proxy->GroupCountsBuffer,
+					proxy->GroupCountsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(10, 0, EShaderResourceType::EBufferUAV, proxy->VisibleInstancesBuffer,
+					proxy->VisibleInstancesBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(11, 0, EShaderResourceType::EBufferUAV, proxy->InstanceSlotsBuffer,
+					proxy->InstanceSlotsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(12, 0, EShaderResourceType::EBufferUAV, proxy->MeshletCommandsBuffer,
+					proxy->MeshletCommandsBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(13, 0, EShaderResourceType::EBufferUAV, proxy->MeshletQueueBuffer,
+					proxy->MeshletQueueBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(14, 0, EShaderResourceType::EBufferUAV, proxy->MeshletDispatchBuffer,
+					proxy->MeshletDispatchBuffer->GetSize(), 0);
+				cullSet->AddBufferWrite(15, 0, EShaderResourceType::EBufferUAV, proxy->MeshletVisibilityBuffer,
+					proxy->MeshletVisibilityBuffer->GetSize(), 0);
+			}
+
+			IndirectCullPushData pushData{};
+			pushData.IsPrepass = prepass ? 1 : 0;
+			pushData.ObjectsCount = proxy->ObjectsVB.Size();
+			pushData.GroupsCount = proxy->GroupsVB.Size();
+			pushData.InstancesStride = proxy->ViewInstancesStride;
+			pushData.GroupLodsStride = proxy->ViewGroupLodsStride;
+			pushData.VisibilityStride = proxy->ViewVisibilityStride;
+			pushData.DrawCountsStride = VIEW_DRAW_COUNTS;
+			pushData.MeshletCommandsStride = proxy->ViewMeshletCommandsStride;
+			pushData.MeshletVisibilityStride = proxy->ViewMeshletVisibilityStride;
+			pushData.BatchesCapacity = MAX_SHADERS_PER_WORLD;
+
+			// visible instances are counted per group and lod first, every lod with any of them gets one command,
+			// then the instances are written into the ranges of their commands,
+			// instances drawn by meshlets are queued on the way and their meshlets culled last
+			graphBuilder->FillRDGBuffer(cmd, proxy->GroupCountsBuffer,
+				proxy->GroupCountsBuffer->GetSize(), 0, 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->FillRDGBuffer(cmd, proxy->MeshletDispatchBuffer,
+				proxy->MeshletDispatchBuffer->GetSize(), 0, 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCommandsBuffer,
+				proxy->DrawCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletCommandsBuffer,
+				proxy->MeshletCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletQueueBuffer,
+				proxy->MeshletQueueBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->InstanceSlotsBuffer,
+				proxy->InstanceSlotsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->VisibleInstancesBuffer,
+				proxy->VisibleInstancesBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+
+			uint32_t numViews = (uint32_t)views.size();
+			uint32_t objectGroups = uint32_t((proxy->ObjectsVB.Size() / 256) + 1);
+			uint32_t groupGroups = uint32_t((proxy->GroupsVB.Size() / 256) + 1);
+
+			pushData.Stage = CULL_STAGE_INSTANCES;
+			GRHIDevice->BindShader(cmd, m_CullShader, {cullSet}, &pushData);
+			GRHIDevice->DispatchCompute(cmd, objectGroups, numViews, 1);
+
+			// counts are turned into offsets in place
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->GroupCountsBuffer,
+				proxy->GroupCountsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+
+			pushData.Stage = CULL_STAGE_EMIT;
+			GRHIDevice->BindShader(cmd, m_CullShader, {cullSet}, &pushData);
+			GRHIDevice->DispatchCompute(cmd, groupGroups, numViews, 1);
+
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->GroupCountsBuffer,
+				proxy->GroupCountsBuffer->GetSize(), 0, EGPUAccessFlags::ESRVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->InstanceSlotsBuffer,
+				proxy->InstanceSlotsBuffer->GetSize(), 0, EGPUAccessFlags::ESRVCompute);
+
+			pushData.Stage = CULL_STAGE_COMPACT;
+			GRHIDevice->BindShader(cmd, m_CullShader, {cullSet}, &pushData);
+			GRHIDevice->DispatchCompute(cmd, objectGroups, numViews, 1);
+
+			// the compaction sized the dispatch by the longest queue of the views
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletDispatchBuffer,
+				proxy->MeshletDispatchBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs | EGPUAccessFlags::EUAVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletQueueBuffer,
+				proxy->MeshletQueueBuffer->GetSize(), 0, EGPUAccessFlags::ESRVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->VisibleInstancesBuffer,
+				proxy->VisibleInstancesBuffer->GetSize(), 0, EGPUAccessFlags::ESRVCompute);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCountsBuffer,
+				proxy->DrawCountsBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+
+			pushData.Stage = CULL_STAGE_MESHLETS;
+			GRHIDevice->BindShader(cmd, m_CullShader, {cullSet}, &pushData);
+			GRHIDevice->DispatchComputeIndirect(cmd, proxy->MeshletDispatchBuffer, 0);
+
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletCommandsBuffer,
+				proxy->MeshletCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCommandsBuffer, 
+				proxy->DrawCommandsBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->DrawCountsBuffer, 
+				proxy->DrawCountsBuffer->GetSize(), 0, EGPUAccessFlags::EIndirectArgs);
+			graphBuilder->BarrierRDGBuffer(cmd, proxy->VisibleInstancesBuffer,
+				proxy->VisibleInstancesBuffer->GetSize(), 0, EGPUAccessFlags::ESRVGraphics);
+			};
+
+		// first cull pass, objects visible last frame in each view
+		graphBuilder->AddPass(
+			hzbTextures,
+			{ viewsSSBO, batchSSBO },
+			ERendererStage::EBeforeRender,
+			[=](RHICommandBuffer* cmd) {
+
+				ViewCullGPUData* viewsData = (ViewCullGPUData*)graphBuilder->GetBufferResource(viewsSSBO)->GetMappedData();
+				for (uint32_t i = 0; i < (uint32_t)views.size(); i++) {
+					viewsData[i] = views[i].Data;
+				}
+
+				// offsets are kept up to date by the proxy when batches change
+				uint32_t* offsetsBuffer = (uint32_t*)graphBuilder->GetBufferResource(batchSSBO)->GetMappedData();
+				for (uint32_t i = 0; i < (uint32_t)proxy->Batches.size(); i++) {
+					offsetsBuffer[i] = proxy->Batches[i].CommandOffset;
+					offsetsBuffer[MAX_SHADERS_PER_WORLD + i] = proxy->Batches[i].MeshletCommandOffset;
+				}
+
+				for (RDGHandle handle : hzbTextures) {
+					graphBuilder->BarrierRDGTexture2D(cmd, graphBuilder->GetTextureResource(handle), EGPUAccessFlags::ESRVCompute);
+				}
+
+				graphBuilder->BarrierRDGBuffer(cmd, proxy->VisibilityBuffer,
+					proxy->VisibilityBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+				graphBuilder->BarrierRDGBuffer(cmd, proxy->MeshletVisibilityBuffer,
+					proxy->MeshletVisibilityBuffer->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+
+				cullViews(cmd, true);
+			});
+
+		// second cull pass, added after the views, so it runs once all of them have their hzb
+		graphBuilder->AddPass(
+			hzbTextures,
+			{ viewsSSBO, batchSSBO },
+			ERendererStage::EOpaqueRender,
+			[=](RHICommandBuffer* cmd) {
+
+				graphBuilder->FillRDGBuffer(cmd, proxy->DrawCountsBuffer, 
+					proxy->DrawCountsBuffer->GetSize(), 0, 0, EGPUAccessFlags::EUAVCompute);
+
+				cullViews(cmd, false);
+			});
+	}
+
 
 	DeferredLightingFeature::DeferredLightingFeature() {
 
-		ShaderDesc desc{};
-		desc.Type = EShaderType::EGraphics;
-		desc.Name = "DeferredLighting";
-		desc.ColorTargetFormats = { ETextureFormat::ERGBA16F };
+		{
+			ShaderDesc desc{};
+			desc.Type = EShaderType::EGraphics;
+			desc.Name = "DeferredLighting";
+			desc.ColorTargetFormats = { ETextureFormat::ERGBA16F };
+
+			m_LightingShader = GShaderManager->GetShaderFromCache(desc);
+		}
+		{
+			ShaderDesc desc{};
+			desc.Type = EShaderType::ECompute;
+			desc.Name = "LightClusters";
 
-		m_LightingShader = GShaderManager->GetShaderFromCache(desc);
+			m_ClusterShader = GShaderManager->GetShaderFromCache(desc);
+		}
 	}
 
 	DeferredLightingFeature::~DeferredLightingFeature() {}
@@ -380,9 +562,100 @@ namespace Spike {
 		graphBuilder->RegisterExternalTexture2D(context.OutTexture);
 		graphBuilder->RegisterExternalBuffer(proxy->LightsBuffer);
 
+		// lights are binned into view space clusters first, so pixels only loop over the lights around them
+		// cameras can keep their planes in either order and draw with an infinite projection,
+		// so slices span from the closer plane to the farther one
+		float clusterNear = std::min(cameraData->NearProj, cameraData->FarProj);
+		float clusterFar = std::max(cameraData->NearProj, cameraData->FarProj);
+
+		LightClusterGrid* grid = &m_ClusterGrids[context.ViewIndex];
+		grid->Update(context.OutTexture->GetSizeXYZ().x, context.OutTexture->GetSizeXYZ().y,
+			cameraData->Proj[0][0], cameraData->Proj[1][1], clusterNear, clusterFar);
+
+		const uint32_t numClusters = grid->GetNumClusters();
+		const uint32_t maxLightIndices = numClusters * LightClusterGrid::AVERAGE_LIGHTS_PER_CLUSTER;
+
+		RDGHandle clusterBounds;
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(LightClusterBounds) * numClusters;
+			desc.UsageFlags = EBufferUsageFlags::EStorage;
+			desc.MemUsage = EBufferMemUsage::ECPUToGPU;
+
+			clusterBounds = graphBuilder->CreateRDGBuffer("Light-Cluster-Bounds", desc);
+		}
+		RDGHandle clusterRanges;
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(Vec2Uint) * numClusters;
+			desc.UsageFlags = EBufferUsageFlags::EStorage;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			clusterRanges = graphBuilder->CreateRDGBuffer("Light-Cluster-Ranges", desc);
+		}
+		RDGHandle clusterIndices;
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * maxLightIndices;
+			desc.UsageFlags = EBufferUsageFlags::EStorage;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			clusterIndices = graphBuilder->CreateRDGBuffer("Light-Cluster-Indices", desc);
+		}
+		RDGHandle clusterCounter;
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t);
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			clusterCounter = graphBuilder->CreateRDGBuffer("Light-Cluster-Counter", desc);
+		}
+
+		graphBuilder->AddPass(
+			{},
+			{sceneUBO, clusterBounds, clusterRanges, clusterIndices, clusterCounter},
+			ERendererStage::ELightsRender,
+			[=, this](RHICommandBuffer* cmd) {
+
+				RHIBuffer* ubo = graphBuilder->GetBufferResource(sceneUBO);
+				RHIBuffer* bounds = graphBuilder->GetBufferResource(clusterBounds);
+				RHIBuffer* ranges = graphBuilder->GetBufferResource(clusterRanges);
+				RHIBuffer* indices = graphBuilder->GetBufferResource(clusterIndices);
+				RHIBuffer* counter = graphBuilder->GetBufferResource(clusterCounter);
+
+				memcpy(bounds->GetMappedData(), grid->GetBounds().data(), sizeof(LightClusterBounds) * numClusters);
+
+				graphBuilder->FillRDGBuffer(cmd, counter, counter->GetSize(), 0, 0, EGPUAccessFlags::EUAVCompute);
+				graphBuilder->BarrierRDGBuffer(cmd, ranges, ranges->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+				graphBuilder->BarrierRDGBuffer(cmd, indices, indices->GetSize(), 0, EGPUAccessFlags::EUAVCompute);
+
+				RHIBindingSet* clusterSet = GRDGPool->GetOrCreateBindingSet(m_ClusterShader->GetLayouts()[0]);
+				{
+					clusterSet->AddBufferWrite(0, 0, EShaderResourceType::EConstantBuffer, ubo, ubo->GetSize(), 0);
+					clusterSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferSRV, proxy->LightsBuffer, proxy->LightsBuffer->GetSize(), 0);
+					clusterSet->AddBufferWrite(2, 0, EShaderResourceType::EBufferSRV, bounds, bounds->GetSize(), 0);
+					clusterSet->AddBufferWrite(3, 0, EShaderResourceType::EBufferUAV, ranges, ranges->GetSize(), 0);
+					clusterSet->AddBufferWrite(4, 0, EShaderResourceType::EBufferUAV, indices, indices->GetSize(), 0);
+					clusterSet->AddBufferWrite(5, 0, EShaderResourceType::EBufferUAV, counter, counter->GetSize(), 0);
+				}
+
+				LightClustersPushData pushData{};
+				LightClusterGrid::GetViewRows(cameraData->View, pushData.ViewRows);
+				pushData.TilesXY = grid->GetTilesX() * grid->GetTilesY();
+				pushData.MaxLightIndices = maxLightIndices;
+
+				// a group per cluster, slices along y keep both dimensions small at any resolution
+				GRHIDevice->BindShader(cmd, m_ClusterShader, {clusterSet}, &pushData);
+				GRHIDevice->DispatchCompute(cmd, pushData.TilesXY, LightClusterGrid::NUM_SLICES, 1);
+
+				graphBuilder->BarrierRDGBuffer(cmd, ranges, ranges->GetSize(), 0, EGPUAccessFlags::ESRVGraphics);
+				graphBuilder->BarrierRDGBuffer(cmd, indices, indices->GetSize(), 0, EGPUAccessFlags::ESRVGraphics);
+			});
+
 		graphBuilder->AddPass(
 			{albedoTex, normalTex, materialTex, depthTex},
-			{sceneUBO},
+			{sceneUBO, clusterRanges, clusterIndices},
 			ERendererStage::ELightsRender,
 			[=, this](RHICommandBuffer* cmd) {
 
@@ -392,6 +665,8 @@ namespace Spike {
 				RHITexture2D* depth = graphBuilder->GetTextureResource(depthTex);
 				RHITexture2D* brdf = GFrameRenderer->GetBRDFLut();
 				RHIBuffer* ubo = graphBuilder->GetBufferResource(sceneUBO);
+				RHIBuffer* ranges = graphBuilder->GetBufferResource(clusterRanges);
+				RHIBuffer* indices = graphBuilder->GetBufferResource(clusterIndices);
 
 				graphBuilder->BarrierRDGTexture2D(cmd, context.OutTexture, EGPUAccessFlags::EColorTarget);
 
@@ -408,10 +683,16 @@ namespace Spike {
 					lightingSet->AddSamplerWrite(8, 0, EShaderResourceType::ESampler, context.OutTexture->GetSampler());
 					lightingSet->AddSamplerWrite(9, 0, EShaderResourceType::ESampler, context.EnvironmentTexture->GetSampler());
 					lightingSet->AddBufferWrite(10, 0, EShaderResourceType::EBufferSRV, proxy->LightsBuffer, proxy->LightsBuffer->GetSize(), 0);
+					lightingSet->AddBufferWrite(11, 0, EShaderResourceType::EBufferSRV, ranges, ranges->GetSize(), 0);
+					lightingSet->AddBufferWrite(12, 0, EShaderResourceType::EBufferSRV, indices, indices->GetSize(), 0);
 				} 
 
 				DeferredLightingPushData pushData{};
 				pushData.EnvMapNumMips = context.EnvironmentTexture->GetNumMips();
+				pushData.ClusterTilesX = grid->GetTilesX();
+				pushData.ClusterTilesY = grid->GetTilesY();
+				pushData.ClusterSliceScale = grid->GetSliceScale();
+				pushData.ClusterSliceBias = grid->GetSliceBias();
 
 				Vec4 colorClear = { 0.0f, 0.0f, 0.0f, 1.0f };
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <Engine/Renderer/FrameRenderer.h>
+#include <Engine/Renderer/LightClusters.h>
+
+#include <array>
 
 namespace Spike {
 
@@ -23,11 +26,20 @@ namespace Spike {
 		virtual ~GBufferFeature() override;
 
 		virtual void BuildGraph(RDGBuilder* graphBuilder, const RHIWorldProxy* proxy, RenderContext context, const CameraDrawData* cameraData) override;
+		virtual void BuildSharedGraph(RDGBuilder* graphBuilder, const RHIWorldProxy* proxy) override;
 
 	private:
 
+		// a view for the shared cull passes, gathered while the views build their graphs
+		struct CullView {
+			ViewCullGPUData Data;
+			RDGHandle HzbTexture;
+		};
+
 		RHIShader* m_CullShader;
 		RHIShader* m_HzbShader;
+
+		std::vector<CullView> m_CullViews;
 	};
 
 	class DeferredLightingFeature : public RenderFeature {
@@ -40,6 +52,10 @@ namespace Spike {
 	private:
 
 		RHIShader* m_LightingShader;
+		RHIShader* m_ClusterShader;
+
+		// grids are read when the graph executes, so every view of the frame has its own
+		std::array<LightClusterGrid, MAX_RENDER_VIEWS> m_ClusterGrids;
 	};
 
 	class SkyboxFeature : public RenderFeature {
@@ -134,17 +134,48 @@ namespace Spike {
 	}
 
 	void FrameRenderer::RenderWorld(RHIWorldProxy* proxy, RenderContext context, const CameraDrawData& cameraData, const std::vector<EFeatureType>& features) {
-		if (!Application::Get().Closing()) {
+		RenderWorld(proxy, { RenderView{ cameraData, context, features } });
+	}
+
+	void FrameRenderer::RenderWorld(RHIWorldProxy* proxy, const std::vector<RenderView>& views) {
+		if (!Application::Get().Closing() && !views.empty()) {
 
 			RDGBuilder builder = RDGBuilder();
 			uint32_t frameIndex = m_FrameCount % 2;
 
+			uint32_t numViews = (uint32_t)views.size();
+			if (numViews > MAX_RENDER_VIEWS) {
+				ENGINE_WARN("Too many views of a world in a frame, max is: {}", MAX_RENDER_VIEWS);
+				numViews = MAX_RENDER_VIEWS;
+			}
+
+			// scene records changed on the cpu since the last render of this world
+			proxy->SetNumViews(numViews);
+			proxy->UploadDirtyData(m_CommandBuffers[frameIndex]);
+
 			// reset draw counts buffer
 			GRHIDevice->FillBuffer(m_CommandBuffers[frameIndex], proxy->DrawCountsBuffer, proxy->DrawCountsBuffer->GetSize(), 0, 0, EGPUAccessFlags::EIndirectArgs, EGPUAccessFlags::EUAVCompute);
 
-			for (auto& feature : features) {
-				auto f = LoadFeature(feature);
-				f->BuildGraph(&builder, proxy, context, &cameraData);
+			std::vector<RenderFeature*> usedFeatures;
+			for (uint32_t v = 0; v < numViews; v++) {
+
+				RenderContext context = views[v].Context;
+				context.ViewIndex = v;
+
+				builder.SetNameScope("View" + std::to_string(v) + "-");
+				for (auto& feature : views[v].Features) {
+					auto f = LoadFeature(feature);
+					f->BuildGraph(&builder, proxy, context, &views[v].Camera);
+
+					if (std::find(usedFeatures.begin(), usedFeatures.end(), f) == usedFeatures.end()) {
+						usedFeatures.push_back(f);
+					}
+				}
+			}
+
+			builder.SetNameScope("");
+			for (auto f : usedFeatures) {
+				f->BuildSharedGraph(&builder, proxy);
 			}
 
 			builder.Execute(m_CommandBuffers[frameIndex]);
@@ -25,6 +25,9 @@ namespace Spike {
 
 		float NearProj;
 		float FarProj;
+
+		// layers drawn by the view, instances outside of all of them are culled
+		uint32_t ViewMask = ALL_LAYERS_MASK;
 	};
 
 	struct RenderContext {
@@ -32,6 +35,9 @@ namespace Spike {
 
 		RHICubeTexture* EnvironmentTexture;
 		RHICubeTexture* IrradianceTexture;
+
+		// slice of the per view buffers, set by the frame renderer
+		uint32_t ViewIndex = 0;
 	};
 
 	enum class EFeatureType : uint8_t;
@@ -39,6 +45,16 @@ namespace Spike {
 	public:
 		virtual ~RenderFeature() = default;
 		virtual void BuildGraph(RDGBuilder* graphBuilder, const RHIWorldProxy* proxy, RenderContext context, const CameraDrawData* cameraData) = 0;
+
+		// called once after every view of the frame has built its graph, for work done for all views at once
+		virtual void BuildSharedGraph(RDGBuilder* /*graphBuilder*/, const RHIWorldProxy* /*proxy*/) {}
+	};
+
+	// a camera rendered into its own target with its own features
+	struct RenderView {
+		CameraDrawData Camera;
+		RenderContext Context;
+		std::vector<EFeatureType> Features;
 	};
 
 	class FrameRenderer {
@@ -47,6 +63,10 @@ namespace Spike {
 		~FrameRenderer();
 
 		void RenderWorld(RHIWorldProxy* proxy, RenderContext context, const CameraDrawData& cameraData, const std::vector<EFeatureType>& features);
+
+		// views of the same world share one graph and one cull pass, each view gets its own draw lists,
+		// a view keeps its visibility history as long as it keeps its place in the list
+		void RenderWorld(RHIWorldProxy* proxy, const std::vector<RenderView>& views);
 		void RenderSwapchain(uint32_t width, uint32_t height, RHITexture2D* fillTexture = nullptr);
 		void BeginFrame();
 
@@ -19,6 +19,9 @@ namespace Spike {
 	class RHICommandBuffer : public RHIResource {
 	public:
 		RHICommandBuffer() : m_RHIData(0) {}
+
+		// wraps command buffer data owned by the device (transient command buffers)
+		explicit RHICommandBuffer(RHIData data) : m_RHIData(data) {}
 		virtual ~RHICommandBuffer() override {}
 
 		virtual void InitRHI() override;
@@ -63,6 +66,9 @@ namespace Spike {
 
 		virtual void CopyDataToTexture(void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess, 
 			const std::vector<SubResourceCopyRegion>& regions, size_t copySize) = 0;
+		// records the copy without waiting for it, the data is staged and kept until cmd was executed
+		virtual void CopyDataToTexture(RHICommandBuffer* cmd, void* src, size_t srcOffset, RHITexture* dst, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess,
+			const std::vector<SubResourceCopyRegion>& regions, size_t copySize) = 0;
 		virtual void CopyFromTextureToCPU(RHICommandBuffer* cmd, RHITexture* src, SubResourceCopyRegion region, RHIBuffer* dst) = 0;
 		virtual void BarrierTexture(RHICommandBuffer* cmd, RHITexture* texture, EGPUAccessFlags lastAccess, EGPUAccessFlags newAccess) = 0;
 
@@ -95,7 +101,15 @@ namespace Spike {
 		virtual void BeginFrameCommandBuffer(RHICommandBuffer* cmd) = 0;
 		virtual void WaitForFrameCommandBuffer(RHICommandBuffer* cmd) = 0;
 		virtual void ImmediateSubmit(std::function<void(RHICommandBuffer*)>&& func) = 0;
+
+		// can be called from any thread, the buffer is already recording
+		// it has to be recorded and submitted on the acquiring thread, a buffer that is never submitted is never reused
+		virtual RHICommandBuffer* AcquireTransientCommandBuffer() = 0;
+		// ends recording, submitted buffers execute in order before the next frame command buffer
+		virtual void SubmitTransientCommandBuffer(RHICommandBuffer* cmd) = 0;
 		virtual void DispatchCompute(RHICommandBuffer* cmd, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
+		// group counts are three uints at the offset, written on the gpu
+		virtual void DispatchComputeIndirect(RHICommandBuffer* cmd, RHIBuffer* argsBuffer, size_t offset) = 0;
 		virtual void WaitGPUIdle() = 0;
 
 		struct RenderInfo {
@@ -0,0 +1,123 @@
+#include <Engine/Renderer/LightClusters.h>
+#include <Engine/World/World.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace Spike {
+
+	// utility
+	// mirrors LightClusters.hlsl, every operation is kept in the same order and without contraction
+	static Vec3 LightToView(const Vec4 rows[3], const Vec4& position) {
+		return Vec3(
+			((rows[0].x * position.x + rows[0].y * position.y) + rows[0].z * position.z) + rows[0].w,
+			((rows[1].x * position.x + rows[1].y * position.y) + rows[1].z * position.z) + rows[1].w,
+			((rows[2].x * position.x + rows[2].y * position.y) + rows[2].z * position.z) + rows[2].w);
+	}
+
+	static bool SphereIntersectsCluster(const LightClusterBounds& bounds, const Vec3& center, float radius) {
+		float dx = std::max(std::max(bounds.Min.x - center.x, center.x - bounds.Max.x), 0.f);
+		float dy = std::max(std::max(bounds.Min.y - center.y, center.y - bounds.Max.y), 0.f);
+		float dz = std::max(std::max(bounds.Min.z - center.z, center.z - bounds.Max.z), 0.f);
+
+		float distSq = (dx * dx + dy * dy) + dz * dz;
+		return distSq <= radius * radius;
+	}
+
+	LightClusterGrid::LightClusterGrid() :
+		m_Width(0), m_Height(0), m_P00(0.f), m_P11(0.f), m_Near(0.f), m_Far(0.f),
+		m_TilesX(0), m_TilesY(0), m_SliceScale(0.f), m_SliceBias(0.f) {}
+
+	void LightClusterGrid::Update(uint32_t width, uint32_t height, float P00, float P11, float nearProj, float farProj) {
+		if (width == m_Width && height == m_Height && P00 == m_P00 && P11 == m_P11 && nearProj == m_Near && farProj == m_Far) return;
+
+		m_Width = width;
+		m_Height = height;
+		m_P00 = P00;
+		m_P11 = P11;
+		m_Near = nearProj;
+		m_Far = farProj;
+
+		m_TilesX = std::max((width + TILE_SIZE - 1) / TILE_SIZE, 1u);
+		m_TilesY = std::max((height + TILE_SIZE - 1) / TILE_SIZE, 1u);
+
+		float farOverNear = std::max(farProj / nearProj, 1.0001f);
+		float logRange = std::log2(farOverNear);
+
+		m_SliceScale = NUM_SLICES / logRange;
+		m_SliceBias = -(NUM_SLICES * std::log2(nearProj)) / logRange;
+
+		m_Bounds.resize(GetNumClusters());
+
+		for (uint32_t slice = 0; slice < NUM_SLICES; slice++) {
+
+			// exponential slices keep clusters close to cubes along the view
+			float sliceNear = nearProj * std::pow(farOverNear, float(slice) / NUM_SLICES);
+			float sliceFar = nearProj * std::pow(farOverNear, float(slice + 1) / NUM_SLICES);
+
+			for (uint32_t ty = 0; ty < m_TilesY; ty++) {
+
+				float y0 = float(ty * TILE_SIZE) / height * 2.f - 1.f;
+				float y1 = float(std::min((ty + 1) * TILE_SIZE, height)) / height * 2.f - 1.f;
+
+				for (uint32_t tx = 0; tx < m_TilesX; tx++) {
+
+					float x0 = float(tx * TILE_SIZE) / width * 2.f - 1.f;
+					float x1 = float(std::min((tx + 1) * TILE_SIZE, width)) / width * 2.f - 1.f;
+
+					Vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+
+					// corners of the tile at both slice depths, view space looks down -z
+					for (uint32_t i = 0; i < 8; i++) {
+						float depth = (i & 4) ? sliceFar : sliceNear;
+						float x = ((i & 1) ? x1 : x0) * depth / P00;
+						float y = ((i & 2) ? y1 : y0) * depth / P11;
+
+						minPos = glm::min(minPos, Vec3(x, y, -depth));
+						maxPos = glm::max(maxPos, Vec3(x, y, -depth));
+					}
+
+					LightClusterBounds& bounds = m_Bounds[(slice * m_TilesY + ty) * m_TilesX + tx];
+					bounds.Min = Vec4(minPos, 0.f);
+					bounds.Max = Vec4(maxPos, 0.f);
+				}
+			}
+		}
+	}
+
+	void LightClusterGrid::GetViewRows(const Mat4x4& view, Vec4 outRows[3]) {
+		for (uint32_t i = 0; i < 3; i++) {
+			outRows[i] = Vec4(view[0][i], view[1][i], view[2][i], view[3][i]);
+		}
+	}
+
+	void LightClusterGrid::BinLights(const Mat4x4& view, const LightGPUData* lights, uint32_t numLights,
+		std::vector<Vec2Uint>& outRanges, std::vector<uint32_t>& outIndices) const {
+
+		Vec4 rows[3];
+		GetViewRows(view, rows);
+
+		std::vector<Vec3> centers(numLights);
+		for (uint32_t i = 0; i < numLights; i++) {
+			centers[i] = LightToView(rows, lights[i].Position);
+		}
+
+		outRanges.resize(m_Bounds.size());
+		outIndices.clear();
+
+		for (uint32_t c = 0; c < (uint32_t)m_Bounds.size(); c++) {
+			uint32_t offset = (uint32_t)outIndices.size();
+			uint32_t count = 0;
+
+			for (uint32_t i = 0; i < numLights && count < MAX_LIGHTS_PER_CLUSTER; i++) {
+				if (!SphereIntersectsCluster(m_Bounds[c], centers[i], lights[i].Range)) continue;
+
+				outIndices.push_back(i);
+				count++;
+			}
+
+			outRanges[c] = Vec2Uint(offset, count);
+		}
+	}
+}
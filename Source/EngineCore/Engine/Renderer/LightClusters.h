@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Engine/Utils/MathUtils.h>
+#include <vector>
+
+namespace Spike {
+
+	struct LightGPUData;
+
+	// view space bounds of a single cluster
+	struct alignas(16) LightClusterBounds {
+
+		Vec4 Min;
+		Vec4 Max;
+	};
+
+	// view space froxels, screen tiles split into exponential depth slices
+	// bounds are built on the cpu and lights are binned into them by the LightClusters shader
+	class LightClusterGrid {
+	public:
+		LightClusterGrid();
+
+		// bounds are only rebuilt when the viewport or the projection changes, near has to be the closer plane
+		void Update(uint32_t width, uint32_t height, float P00, float P11, float nearProj, float farProj);
+
+		// binning on the cpu, for debugging the shader's lists, nothing checks them against each other
+		// lists of the clusters follow each other in cluster order, every list is in light order
+		// and cut at MAX_LIGHTS_PER_CLUSTER, ranges are (offset, count)
+		void BinLights(const Mat4x4& view, const LightGPUData* lights, uint32_t numLights,
+			std::vector<Vec2Uint>& outRanges, std::vector<uint32_t>& outIndices) const;
+
+		// rows of the view matrix as the binning pass gets them
+		static void GetViewRows(const Mat4x4& view, Vec4 outRows[3]);
+
+		const std::vector<LightClusterBounds>& GetBounds() const { return m_Bounds; }
+
+		uint32_t GetTilesX() const { return m_TilesX; }
+		uint32_t GetTilesY() const { return m_TilesY; }
+		uint32_t GetNumClusters() const { return m_TilesX * m_TilesY * NUM_SLICES; }
+
+		// slice = log2(depth) * scale + bias
+		float GetSliceScale() const { return m_SliceScale; }
+		float GetSliceBias() const { return m_SliceBias; }
+
+		static constexpr uint32_t TILE_SIZE = 64;
+		static constexpr uint32_t NUM_SLICES = 24;
+		static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 256;
+
+		// index list capacity per cluster on average, dense clusters can go over it as long as others are sparse
+		static constexpr uint32_t AVERAGE_LIGHTS_PER_CLUSTER = 32;
+
+	private:
+		uint32_t m_Width;
+		uint32_t m_Height;
+		float m_P00;
+		float m_P11;
+		float m_Near;
+		float m_Far;
+
+		uint32_t m_TilesX;
+		uint32_t m_TilesY;
+		float m_SliceScale;
+		float m_SliceBias;
+
+		std::vector<LightClusterBounds> m_Bounds;
+	};
+}
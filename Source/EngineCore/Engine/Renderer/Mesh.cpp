@@ -3,9 +3,174 @@
 #include <Engine/Core/Application.h>
 #include <Engine/Core/Log.h>
 #include <Engine/Renderer/FrameRenderer.h>
+#include <Engine/Utils/MeshUtils.h>
 
 namespace Spike {
 
+	// a level has to drop at least this share of the previous one's triangles to be kept
+	static constexpr float MIN_LOD_REDUCTION = 0.2f;
+
+	MeshOptimizeStats OptimizeMesh(MeshDesc& desc) {
+		MeshOptimizeStats stats{};
+		desc.LODs.clear();
+
+		if (desc.Vertices.empty() || desc.Indices.empty()) return stats;
+
+		stats.VerticesBefore = (uint32_t)desc.Vertices.size();
+		stats.Before = MeshUtils::AnalyzeVertexCache(desc.Indices.data(), (uint32_t)desc.Indices.size(), stats.VerticesBefore);
+
+		// importers split vertices per face corner, identical ones only cost an extra transform
+		uint32_t numVertices = 0;
+		std::vector<uint32_t> remap = MeshUtils::GenerateVertexRemap(desc.Vertices.data(), sizeof(Vertex), stats.VerticesBefore, &numVertices);
+
+		for (uint32_t& index : desc.Indices) {
+			index = remap[index];
+		}
+
+		std::vector<Vertex> vertices(numVertices);
+		for (uint32_t v = 0; v < stats.VerticesBefore; v++) {
+			vertices[remap[v]] = desc.Vertices[v];
+		}
+
+		MeshUtils::MeshView view{};
+		view.Positions = &vertices[0].Position.x;
+		view.PositionStride = sizeof(Vertex);
+		view.NumVertices = numVertices;
+
+		for (const SubMesh& subMesh : desc.SubMeshes) {
+			uint32_t* indices = desc.Indices.data() + subMesh.FirstIndex;
+
+			std::vector<uint32_t> cacheOrder = MeshUtils::OptimizeVertexCache(indices, subMesh.IndexCount, numVertices);
+			std::vector<uint32_t> drawOrder = MeshUtils::OptimizeOverdraw(view, cacheOrder.data(), subMesh.IndexCount);
+			std::copy(drawOrder.begin(), drawOrder.end(), indices);
+		}
+
+		// vertices follow the indices, so the fetches of a draw walk the vertex buffer forward, unused ones are dropped
+		remap = MeshUtils::GenerateFetchRemap(desc.Indices.data(), (uint32_t)desc.Indices.size(), numVertices, &numVertices);
+
+		for (uint32_t& index : desc.Indices) {
+			index = remap[index];
+		}
+
+		desc.Vertices.resize(numVertices);
+		for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) {
+			if (remap[v] == UINT32_MAX) continue;
+			desc.Vertices[remap[v]] = vertices[v];
+		}
+
+		stats.VerticesAfter = numVertices;
+		stats.After = MeshUtils::AnalyzeVertexCache(desc.Indices.data(), (uint32_t)desc.Indices.size(), numVertices);
+		return stats;
+	}
+
+	void GenerateMeshlets(MeshDesc& desc) {
+		desc.Meshlets.clear();
+		if (desc.Vertices.empty()) return;
+
+		MeshUtils::MeshView view{};
+		view.Positions = &desc.Vertices[0].Position.x;
+		view.PositionStride = sizeof(Vertex);
+		view.NumVertices = (uint32_t)desc.Vertices.size();
+
+		std::vector<Vec2Uint> ranges;
+		for (uint32_t s = 0; s < (uint32_t)desc.SubMeshes.size(); s++) {
+			const SubMesh& subMesh = desc.SubMeshes[s];
+			uint32_t* indices = desc.Indices.data() + subMesh.FirstIndex;
+
+			std::vector<uint32_t> ordered = MeshUtils::BuildMeshlets(view, indices, subMesh.IndexCount,
+				MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, ranges);
+			std::copy(ordered.begin(), ordered.end(), indices);
+
+			for (const Vec2Uint& range : ranges) {
+				MeshUtils::ClusterBounds bounds = MeshUtils::ComputeClusterBounds(view, indices + range.x, range.y);
+
+				Meshlet meshlet{};
+				meshlet.Sphere = Vec4(bounds.Center, bounds.Radius);
+				meshlet.Cone = Vec4(bounds.ConeAxis, bounds.ConeCutoff);
+				meshlet.SubMesh = s;
+				meshlet.FirstIndex = subMesh.FirstIndex + range.x;
+				meshlet.IndexCount = range.y;
+
+				desc.Meshlets.push_back(meshlet);
+			}
+		}
+	}
+
+	void GenerateMeshLODs(MeshDesc& desc) {
+		desc.LODs.clear();
+		if (desc.Vertices.empty()) return;
+
+		Vec3 minPos = desc.Vertices[0].Position;
+		Vec3 maxPos = desc.Vertices[0].Position;
+
+		// normals and the first uv set keep shading and texturing close to the source
+		constexpr uint32_t numAttributes = 5;
+		const float weights[numAttributes] = { 0.5f, 0.5f, 0.5f, 1.f, 1.f };
+
+		std::vector<float> attributes(desc.Vertices.size() * numAttributes);
+		for (size_t i = 0; i < desc.Vertices.size(); i++) {
+			const Vertex& v = desc.Vertices[i];
+
+			minPos = glm::min(minPos, v.Position);
+			maxPos = glm::max(maxPos, v.Position);
+
+			Vec4 normal = MathUtils::UnpackHalfToSignedVec4(v.Normal);
+			float* a = &attributes[i * numAttributes];
+			a[0] = normal.x;
+			a[1] = normal.y;
+			a[2] = normal.z;
+			a[3] = v.UV0.x;
+			a[4] = v.UV0.y;
+		}
+
+		float radius = glm::length((maxPos - minPos) / 2.f);
+		if (radius <= 0.f) return;
+
+		MeshUtils::MeshView view{};
+		view.Positions = &desc.Vertices[0].Position.x;
+		view.PositionStride = sizeof(Vertex);
+		view.NumVertices = (uint32_t)desc.Vertices.size();
+		view.Attributes = attributes.data();
+		view.AttributeStride = sizeof(float) * numAttributes;
+		view.AttributeWeights = weights;
+		view.NumAttributes = numAttributes;
+
+		for (uint32_t s = 0; s < (uint32_t)desc.SubMeshes.size(); s++) {
+
+			// every level is simplified from the previous one, so errors add up
+			std::vector<uint32_t> previous(desc.Indices.begin() + desc.SubMeshes[s].FirstIndex,
+				desc.Indices.begin() + desc.SubMeshes[s].FirstIndex + desc.SubMeshes[s].IndexCount);
+			float error = 0.f;
+
+			for (uint32_t lod = 1; lod < MESH_MAX_LODS; lod++) {
+
+				uint32_t target = uint32_t(previous.size() / 6) * 3;
+				if (target == 0) break;
+
+				float lodError = 0.f;
+				std::vector<uint32_t> indices = MeshUtils::SimplifyMesh(view, previous.data(), (uint32_t)previous.size(), target, radius, &lodError);
+
+				if (indices.empty() || indices.size() > previous.size() * (1.f - MIN_LOD_REDUCTION)) break;
+
+				// collapses leave the triangles in the previous order, which has holes for the cache now
+				indices = MeshUtils::OptimizeVertexCache(indices.data(), (uint32_t)indices.size(), view.NumVertices);
+
+				error += lodError;
+
+				SubMeshLOD level{};
+				level.SubMesh = s;
+				level.FirstIndex = (uint32_t)desc.Indices.size();
+				level.IndexCount = (uint32_t)indices.size();
+				level.Error = error / radius;
+
+				desc.Indices.insert(desc.Indices.end(), indices.begin(), indices.end());
+				desc.LODs.push_back(level);
+
+				previous = std::move(indices);
+			}
+		}
+	}
+
 	RHIMesh::RHIMesh(const MeshDesc& desc) : m_Desc(desc) {
 
 		BufferDesc bufferDesc{};
@@ -17,6 +182,12 @@ namespace Spike {
 		bufferDesc.Size = sizeof(uint32_t) * desc.Indices.size();
 		m_IndexBuffer = new RHIBuffer(bufferDesc);
 
+		m_MeshletBuffer = nullptr;
+		if (!desc.Meshlets.empty()) {
+			bufferDesc.Size = sizeof(Meshlet) * desc.Meshlets.size();
+			m_MeshletBuffer = new RHIBuffer(bufferDesc);
+		}
+
 		// calculate bounds
 		{
 			Vec3 minpos = Vec3(m_Desc.Vertices[0].Position);
@@ -41,12 +212,14 @@ namespace Spike {
 
 		m_VertexBuffer->InitRHI();
 		m_IndexBuffer->InitRHI();
+		if (m_MeshletBuffer) m_MeshletBuffer->InitRHI();
 
 		const size_t vertexBufferSize = sizeof(Vertex) * m_Desc.Vertices.size();
 		const size_t indexBufferSize = sizeof(uint32_t) * m_Desc.Indices.size();
+		const size_t meshletBufferSize = sizeof(Meshlet) * m_Desc.Meshlets.size();
 
 		BufferDesc stagingDesc{};
-		stagingDesc.Size = vertexBufferSize + indexBufferSize;
+		stagingDesc.Size = vertexBufferSize + indexBufferSize + meshletBufferSize;
 		stagingDesc.UsageFlags = EBufferUsageFlags::ECopySrc;
 		stagingDesc.MemUsage = EBufferMemUsage::ECPUOnly;
 
@@ -55,11 +228,15 @@ namespace Spike {
 
 		memcpy(staging->GetMappedData(), m_Desc.Vertices.data(), vertexBufferSize);
 		memcpy((char*)staging->GetMappedData() + vertexBufferSize, m_Desc.Indices.data(), indexBufferSize);
+		memcpy((char*)staging->GetMappedData() + vertexBufferSize + indexBufferSize, m_Desc.Meshlets.data(), meshletBufferSize);
 
 		GRHIDevice->ImmediateSubmit([&, this](RHICommandBuffer* cmd) {
 
 			GRHIDevice->CopyBuffer(cmd, staging, m_VertexBuffer, 0, 0, vertexBufferSize);
 			GRHIDevice->CopyBuffer(cmd, staging, m_IndexBuffer, vertexBufferSize, 0, indexBufferSize);
+			if (m_MeshletBuffer) {
+				GRHIDevice->CopyBuffer(cmd, staging, m_MeshletBuffer, vertexBufferSize + indexBufferSize, 0, meshletBufferSize);
+			}
 			});
 
 		staging->ReleaseRHI();
@@ -79,6 +256,11 @@ namespace Spike {
 
 		m_IndexBuffer->ReleaseRHI();
 		delete m_IndexBuffer;
+
+		if (m_MeshletBuffer) {
+			m_MeshletBuffer->ReleaseRHI();
+			delete m_MeshletBuffer;
+		}
 	}
 
 	Mesh::Mesh(const MeshDesc& desc, UUID id) {
@@ -96,12 +278,26 @@ namespace Spike {
 		char magic[4] = {};
 		stream >> magic;
 
-		if (memcmp(MESH_MAGIC, magic, sizeof(char) * 4) != 0) {
+		bool hasMeshlets = memcmp(MESH_MESHLETS_MAGIC, magic, sizeof(char) * 4) == 0;
+		bool hasLODs = hasMeshlets || memcmp(MESH_LODS_MAGIC, magic, sizeof(char) * 4) == 0;
+
+		if (!hasLODs && memcmp(MESH_MAGIC, magic, sizeof(char) * 4) != 0) {
 			ENGINE_ERROR("Mesh asset file is not valid: {}!", (uint64_t)id);
 			return nullptr;
 		}
 
 		stream >> desc.Vertices >> desc.Indices >> desc.SubMeshes;
+		if (hasLODs) {
+			stream >> desc.LODs;
+		}
+		if (hasMeshlets) {
+			stream >> desc.Meshlets;
+		}
+
+		if (!stream.IsValid()) {
+			ENGINE_ERROR("Truncated mesh asset file: {}", (uint64_t)id);
+			return nullptr;
+		}
 		return CreateRef<Mesh>(desc, id);
 	}
 
@@ -2,6 +2,7 @@
 
 #include <Engine/Core/Core.h>
 #include <Engine/Utils/MathUtils.h>
+#include <Engine/Utils/MeshUtils.h>
 #include <Engine/Asset/Asset.h>
 
 #include <Engine/Renderer/Material.h>
@@ -28,7 +29,41 @@ namespace Spike {
 		uint32_t IndexCount;
 	};
 
+	// coarser index range of a submesh, the submesh range itself is lod 0
+	struct SubMeshLOD {
+
+		uint32_t SubMesh;
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+
+		// simplification error relative to the mesh bounds radius
+		float Error;
+	};
+
+	// cluster of a submesh's lod 0 triangles, culled on its own by the gpu, mirrored by MeshletGPUData in the cull shader
+	struct alignas(16) Meshlet {
+
+		Vec4 Sphere; // w - radius
+
+		// xyz - axis of the triangle normals, w - sine of the cone's half angle, 1 if the cone can't cull
+		Vec4 Cone;
+
+		uint32_t SubMesh;
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		uint32_t Padding0;
+	};
+
+	// lod 0 included
+	constexpr uint32_t MESH_MAX_LODS = 4;
+
+	constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+	constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+	// assets without lods or meshlets are still read, new ones are always written with both
 	constexpr char MESH_MAGIC[4] = { 'S', 'E', 'M', 'S' };
+	constexpr char MESH_LODS_MAGIC[4] = { 'S', 'E', 'M', 'L' };
+	constexpr char MESH_MESHLETS_MAGIC[4] = { 'S', 'E', 'M', 'C' };
 
 	struct MeshDesc {
 
@@ -36,9 +71,34 @@ namespace Spike {
 		std::vector<uint32_t> Indices;
 		std::vector<SubMesh> SubMeshes;
 
+		// ordered by submesh and then from finer to coarser
+		std::vector<SubMeshLOD> LODs;
+
+		// ordered by submesh, together they cover the submesh's index range
+		std::vector<Meshlet> Meshlets;
+
 		bool NeedCPUData = false;
 	};
 
+	struct MeshOptimizeStats {
+
+		uint32_t VerticesBefore = 0;
+		uint32_t VerticesAfter = 0;
+
+		MeshUtils::VertexCacheStats Before;
+		MeshUtils::VertexCacheStats After;
+	};
+
+	// merges identical vertices, reorders the triangles of every submesh for the vertex cache and then for overdraw,
+	// and the vertices in the order they are first used, lods index the old vertices so they are dropped, generate them after this
+	MeshOptimizeStats OptimizeMesh(MeshDesc& desc);
+
+	// splits every submesh into meshlets and reorders its triangles, so each meshlet is a contiguous index range
+	void GenerateMeshlets(MeshDesc& desc);
+
+	// appends simplified index ranges of every submesh, stops early once a level isn't much smaller than the previous one
+	void GenerateMeshLODs(MeshDesc& desc);
+
 	class RHIMesh : public RHIResource {
 	public:
 		RHIMesh(const MeshDesc& desc);
@@ -49,6 +109,8 @@ namespace Spike {
 
 		RHIBuffer* GetVertexBuffer() { return m_VertexBuffer; }
 		RHIBuffer* GetIndexBuffer() { return m_IndexBuffer; }
+		// nullptr for meshes without meshlets
+		RHIBuffer* GetMeshletBuffer() { return m_MeshletBuffer; }
 
 		const std::vector<Vertex>& GetVertices() const { return m_Desc.Vertices; }
 		const std::vector<uint32_t>& GetIndices() const { return m_Desc.Indices; }
@@ -63,6 +125,7 @@ namespace Spike {
 
 		RHIBuffer* m_VertexBuffer;
 		RHIBuffer* m_IndexBuffer;
+		RHIBuffer* m_MeshletBuffer;
 
 		Vec3 m_BoundsOrigin;
 		float m_BoundsRadius;
@@ -219,7 +219,7 @@ namespace Spike {
 
 		RDGTexture newTexture{};
 		newTexture.Desc = desc;
-		newTexture.Name = name;
+		newTexture.Name = m_NameScope + name;
 
 		m_Textures.push_back(newTexture);
 
@@ -232,7 +232,7 @@ namespace Spike {
 
 		RDGBuffer newTexture{};
 		newTexture.Desc = desc;
-		newTexture.Name = name;
+		newTexture.Name = m_NameScope + name;
 
 		m_Buffers.push_back(newTexture);
 
@@ -293,8 +293,9 @@ namespace Spike {
 
 	RDGHandle RDGBuilder::FindRDGTexture2D(const std::string& name) {
 
-		auto it = std::find_if(m_Textures.begin(), m_Textures.end(), [&name](const auto& e) {
-			return e.Name == name;
+		std::string scopedName = m_NameScope + name;
+		auto it = std::find_if(m_Textures.begin(), m_Textures.end(), [&scopedName](const auto& e) {
+			return e.Name == scopedName;
 			});
 
 		if (it != m_Textures.end()) {
@@ -310,8 +311,9 @@ namespace Spike {
 
 	RDGHandle RDGBuilder::FindRDGBuffer(const std::string& name) {
 
-		auto it = std::find_if(m_Buffers.begin(), m_Buffers.end(), [&name](const auto& e) {
-			return e.Name == name;
+		std::string scopedName = m_NameScope + name;
+		auto it = std::find_if(m_Buffers.begin(), m_Buffers.end(), [&scopedName](const auto& e) {
+			return e.Name == scopedName;
 			});
 
 		if (it != m_Buffers.end()) {
@@ -113,6 +113,9 @@ namespace Spike {
 
 		RDGHandle FindRDGTexture2D(const std::string& name);
 		RDGHandle FindRDGBuffer(const std::string& name);
+
+		// names are created and found within the scope, so every view of a frame can use the same ones
+		void SetNameScope(const std::string& scope) { m_NameScope = scope; }
 		RHITexture2D* GetTextureResource(RDGHandle handle);
 		RHIBuffer* GetBufferResource(RDGHandle handle);
 
@@ -159,5 +162,7 @@ namespace Spike {
 
 		std::unordered_map<RHITexture2D*, EGPUAccessFlags> m_TextureAccessMap;
 		std::unordered_map<RHIBuffer*, EGPUAccessFlags> m_BufferAccessMap;
+
+		std::string m_NameScope;
 	};
 }
\ No newline at end of file
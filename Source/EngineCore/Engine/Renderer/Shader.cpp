@@ -127,7 +127,9 @@ namespace Spike {
 			BindingSetLayoutDesc desc{};
 			desc.Bindings = {
 				{.Type = EShaderResourceType::EConstantBuffer, .Count = 1, .Slot = 0},
-				{.Type = EShaderResourceType::EBufferSRV, .Count = 100, .Slot = 1}
+				{.Type = EShaderResourceType::EBufferSRV, .Count = 100, .Slot = 1},
+				{.Type = EShaderResourceType::EBufferSRV, .Count = 1, .Slot = 2},
+				{.Type = EShaderResourceType::EBufferSRV, .Count = 1, .Slot = 3}
 			};
 
 			m_MeshDrawLayout = new RHIBindingSetLayout(desc);
@@ -0,0 +1,188 @@
+#include <Engine/Renderer/SoftwareOcclusion.h>
+
+#include <immintrin.h>
+#include <algorithm>
+
+namespace Spike {
+
+	// utility
+	static constexpr float MIN_CLIP_W = 1e-4f;
+
+	SoftwareOcclusionBuffer::SoftwareOcclusionBuffer(uint32_t width, uint32_t height) {
+
+		m_TilesX = std::max((width + TILE_WIDTH - 1) / TILE_WIDTH, 1u);
+		m_TilesY = std::max((height + TILE_HEIGHT - 1) / TILE_HEIGHT, 1u);
+		m_Width = m_TilesX * TILE_WIDTH;
+		m_Height = m_TilesY * TILE_HEIGHT;
+
+		m_Depth.resize(m_Width * m_Height);
+		m_TileDepth.resize(m_TilesX * m_TilesY);
+
+		Clear();
+	}
+
+	void SoftwareOcclusionBuffer::Clear() {
+		std::fill(m_Depth.begin(), m_Depth.end(), 0.f);
+		std::fill(m_TileDepth.begin(), m_TileDepth.end(), 0.f);
+	}
+
+	void SoftwareOcclusionBuffer::RasterizeTriangles(const Mat4x4& mvp, const float* positions, uint32_t stride, uint32_t numVertices,
+		const uint32_t* indices, uint32_t numIndices) {
+
+		m_Screen.resize(numVertices);
+		for (uint32_t i = 0; i < numVertices; i++) {
+			const float* p = (const float*)((const uint8_t*)positions + (size_t)i * stride);
+			Vec4 clip = mvp * Vec4(p[0], p[1], p[2], 1.f);
+
+			if (clip.w < MIN_CLIP_W) {
+				m_Screen[i] = Vec3(0.f, 0.f, -1.f);
+				continue;
+			}
+
+			float invW = 1.f / clip.w;
+			m_Screen[i] = Vec3((clip.x * invW * 0.5f + 0.5f) * m_Width, (clip.y * invW * 0.5f + 0.5f) * m_Height, invW);
+		}
+
+		const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (uint32_t t = 0; t + 2 < numIndices; t += 3) {
+			if (indices[t] >= numVertices || indices[t + 1] >= numVertices || indices[t + 2] >= numVertices) continue;
+
+			Vec3 a = m_Screen[indices[t]];
+			Vec3 b = m_Screen[indices[t + 1]];
+			Vec3 c = m_Screen[indices[t + 2]];
+
+			// clipping would only add depth, skipping the triangle keeps the buffer conservative
+			if (a.z < 0.f || b.z < 0.f || c.z < 0.f) continue;
+
+			float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (std::abs(area) < 1e-6f) continue;
+
+			// occluders are rasterized double sided, the order only picks the sign of the edge functions
+			if (area < 0.f) {
+				std::swap(b, c);
+				area = -area;
+			}
+
+			int32_t minX = std::max((int32_t)std::floor(std::min(std::min(a.x, b.x), c.x)), 0);
+			int32_t minY = std::max((int32_t)std::floor(std::min(std::min(a.y, b.y), c.y)), 0);
+			int32_t maxX = std::min((int32_t)std::ceil(std::max(std::max(a.x, b.x), c.x)), (int32_t)m_Width - 1);
+			int32_t maxY = std::min((int32_t)std::ceil(std::max(std::max(a.y, b.y), c.y)), (int32_t)m_Height - 1);
+
+			if (minX > maxX || minY > maxY) continue;
+
+			// edge p -> q is A * x + B * y + C, positive on the inner side
+			auto edge = [](const Vec3& p, const Vec3& q) {
+				float A = p.y - q.y;
+				float B = q.x - p.x;
+				return Vec3(A, B, -(A * p.x + B * p.y));
+				};
+
+			Vec3 e0 = edge(a, b), e1 = edge(b, c), e2 = edge(c, a);
+
+			// 1 / w is linear in screen space
+			float dzdx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+			float dzdy = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+			float z0 = a.z - dzdx * a.x - dzdy * a.y;
+
+			// four pixels per step, rows start aligned
+			int32_t startX = minX & ~3;
+
+			for (int32_t y = minY; y <= maxY; y++) {
+				float py = (float)y + 0.5f;
+				float* row = m_Depth.data() + (size_t)y * m_Width;
+
+				__m128 rowE0 = _mm_set1_ps(e0.y * py + e0.z);
+				__m128 rowE1 = _mm_set1_ps(e1.y * py + e1.z);
+				__m128 rowE2 = _mm_set1_ps(e2.y * py + e2.z);
+				__m128 rowZ = _mm_set1_ps(dzdy * py + z0);
+
+				for (int32_t x = startX; x <= maxX; x += 4) {
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+					__m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.x), px), rowE0);
+					__m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.x), px), rowE1);
+					__m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.x), px), rowE2);
+
+					__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+					if (_mm_movemask_ps(inside) == 0) continue;
+
+					__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), rowZ);
+					__m128 old = _mm_loadu_ps(row + x);
+					__m128 closest = _mm_max_ps(old, z);
+
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, old)));
+				}
+			}
+		}
+	}
+
+	void SoftwareOcclusionBuffer::BuildTiles() {
+
+		for (uint32_t ty = 0; ty < m_TilesY; ty++) {
+			for (uint32_t tx = 0; tx < m_TilesX; tx++) {
+
+				// farthest depth in the tile, anything behind it is hidden by every pixel
+				__m128 farthest = _mm_set1_ps(FLT_MAX);
+
+				for (uint32_t y = 0; y < TILE_HEIGHT; y++) {
+					const float* row = m_Depth.data() + (size_t)(ty * TILE_HEIGHT + y) * m_Width + tx * TILE_WIDTH;
+
+					farthest = _mm_min_ps(farthest, _mm_loadu_ps(row));
+					farthest = _mm_min_ps(farthest, _mm_loadu_ps(row + 4));
+				}
+
+				farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+				farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				m_TileDepth[ty * m_TilesX + tx] = _mm_cvtss_f32(farthest);
+			}
+		}
+	}
+
+	bool SoftwareOcclusionBuffer::ProjectBox(const AABB& box, const Mat4x4& viewProj, Vec4& outRect, float& outDepth) const {
+		outRect = Vec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+		outDepth = 0.f;
+
+		for (uint32_t i = 0; i < 8; i++) {
+			Vec3 corner((i & 1) ? box.Max.x : box.Min.x, (i & 2) ? box.Max.y : box.Min.y, (i & 4) ? box.Max.z : box.Min.z);
+			Vec4 clip = viewProj * Vec4(corner, 1.f);
+
+			if (clip.w < MIN_CLIP_W) return false;
+
+			// w is linear over the box, so the closest corner gives the closest point
+			float invW = 1.f / clip.w;
+			float x = (clip.x * invW * 0.5f + 0.5f) * m_Width;
+			float y = (clip.y * invW * 0.5f + 0.5f) * m_Height;
+
+			outRect = Vec4(std::min(outRect.x, x), std::min(outRect.y, y), std::max(outRect.z, x), std::max(outRect.w, y));
+			outDepth = std::max(outDepth, invW);
+		}
+
+		return true;
+	}
+
+	bool SoftwareOcclusionBuffer::IsOccluded(const AABB& box, const Mat4x4& viewProj) const {
+		Vec4 rect;
+		float depth;
+
+		if (!ProjectBox(box, viewProj, rect, depth)) return false;
+
+		// pixel centers covered by the rect, nothing covered means it's off screen or too small to hit a sample
+		int32_t minX = std::max((int32_t)std::floor(rect.x), 0);
+		int32_t minY = std::max((int32_t)std::floor(rect.y), 0);
+		int32_t maxX = std::min((int32_t)std::floor(rect.z), (int32_t)m_Width - 1);
+		int32_t maxY = std::min((int32_t)std::floor(rect.w), (int32_t)m_Height - 1);
+
+		if (minX > maxX || minY > maxY) return false;
+
+		for (int32_t ty = minY / (int32_t)TILE_HEIGHT; ty <= maxY / (int32_t)TILE_HEIGHT; ty++) {
+			for (int32_t tx = minX / (int32_t)TILE_WIDTH; tx <= maxX / (int32_t)TILE_WIDTH; tx++) {
+				if (m_TileDepth[ty * m_TilesX + tx] <= depth) return false;
+			}
+		}
+
+		return true;
+	}
+}
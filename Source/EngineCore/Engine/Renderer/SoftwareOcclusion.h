@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Engine/Utils/Geometry.h>
+#include <vector>
+
+namespace Spike {
+
+	// low resolution depth buffer, occluders are rasterized on the cpu and bounds are tested against it
+	// stores 1 / w like the reversed depth buffer, bigger is closer and 0 is infinitely far
+	// tests use the farthest depth of every tile, so they can only be conservative
+	class SoftwareOcclusionBuffer {
+	public:
+		// size is rounded up to whole tiles
+		SoftwareOcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+
+		void Clear();
+
+		// positions are read with a byte stride, so vertex arrays can be passed as they are
+		// triangles crossing the near plane are skipped
+		void RasterizeTriangles(const Mat4x4& mvp, const float* positions, uint32_t stride, uint32_t numVertices, const uint32_t* indices, uint32_t numIndices);
+
+		// call once after all occluders are rasterized, before testing
+		void BuildTiles();
+
+		bool IsOccluded(const AABB& box, const Mat4x4& viewProj) const;
+
+		// screen rect in pixels (min x, min y, max x, max y) and the closest 1 / w of the box,
+		// returns false if the box crosses the near plane
+		bool ProjectBox(const AABB& box, const Mat4x4& viewProj, Vec4& outRect, float& outDepth) const;
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+		const float* GetDepth() const { return m_Depth.data(); }
+
+		static constexpr uint32_t TILE_WIDTH = 8;
+		static constexpr uint32_t TILE_HEIGHT = 4;
+
+	private:
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_TilesX;
+		uint32_t m_TilesY;
+
+		std::vector<float> m_Depth;
+		std::vector<float> m_TileDepth;
+
+		// screen x, y, 1 / w, negative w marks vertices behind the near plane
+		std::vector<Vec3> m_Screen;
+	};
+}
@@ -99,9 +99,20 @@ namespace Spike {
 		desc.UsageFlags = ETextureUsageFlags::ESampled | ETextureUsageFlags::ECopyDst;
 		desc.SamplerDesc = samplDesc;
 
+		if (!stream.CanRead(header.ByteSize)) {
+			ENGINE_ERROR("Truncated texture 2D asset file: {}", (uint64_t)id);
+			return nullptr;
+		}
+
 		uint8_t* buff = new uint8_t[header.ByteSize];
 		stream.ReadRaw(buff, header.ByteSize);
 
+		if (!stream.IsValid()) {
+			ENGINE_ERROR("Truncated texture 2D asset file: {}", (uint64_t)id);
+			delete[] buff;
+			return nullptr;
+		}
+
 		Ref<Texture2D> tex = CreateRef<Texture2D>(desc, id);
 		SUBMIT_RENDER_COMMAND(([rhi = tex->GetResource(), sizes = std::move(mipSizes), copySize = header.ByteSize, buff]() {
 
@@ -115,7 +126,10 @@ namespace Spike {
 				region.MipLevel = m;
 				offset += sizes[m];
 			}
-			GRHIDevice->CopyDataToTexture(buff, 0, rhi, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRV, regions, copySize);
+			// recorded on a transient buffer, so streaming textures in doesn't stall the render thread on a gpu wait
+			RHICommandBuffer* cmd = GRHIDevice->AcquireTransientCommandBuffer();
+			GRHIDevice->CopyDataToTexture(cmd, buff, 0, rhi, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRV, regions, copySize);
+			GRHIDevice->SubmitTransientCommandBuffer(cmd);
 			delete[] buff;
 			}));
 
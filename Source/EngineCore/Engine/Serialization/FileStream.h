@@ -5,16 +5,43 @@
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <algorithm>
 
 namespace Spike {
 
 	class BinaryReadStream {
 	public:
-		BinaryReadStream(const std::filesystem::path& path) : m_Stream(path, std::ios::binary) {}
+		BinaryReadStream(const std::filesystem::path& path) : m_Stream(path, std::ios::binary), m_Data(nullptr), m_Size(0), m_Offset(0), m_Failed(false) {}
+
+		// reads from memory that was loaded beforehand, data must outlive the stream
+		BinaryReadStream(const uint8_t* data, size_t size) : m_Data(data), m_Size(size), m_Offset(0), m_Failed(false) {}
 		~BinaryReadStream() { m_Stream.close(); }
 
-		void ReadRaw(void* out, size_t size) { m_Stream.read((char*)out, size); }
-		bool IsOpen() const { return m_Stream.is_open(); }
+		// a read past the end zeroes out and fails the stream, every read after it is skipped
+		void ReadRaw(void* out, size_t size) {
+			if (!CanRead(size)) {
+				memset(out, 0, size);
+				m_Failed = true;
+				return;
+			}
+
+			if (m_Data) {
+				memcpy(out, m_Data + m_Offset, size);
+				m_Offset += size;
+			}
+			else if (!m_Stream.read((char*)out, size)) {
+				m_Failed = true;
+			}
+		}
+
+		// memory streams know what's left, file streams only find out once a read comes up short
+		bool CanRead(size_t count, size_t stride = 1) const { return !m_Failed && (!m_Data || count <= (m_Size - m_Offset) / stride); }
+
+		bool IsOpen() const { return m_Data ? true : m_Stream.is_open(); }
+
+		// false once any read came up short, data read from a failed stream must not be used
+		bool IsValid() const { return IsOpen() && !m_Failed; }
 
 		template<typename T>
 		friend BinaryReadStream& operator>>(BinaryReadStream& stream, T& t) {
@@ -27,6 +54,11 @@ namespace Spike {
 			size_t size = 0;
 			stream >> size;
 
+			if (!stream.CanRead(size)) {
+				stream.m_Failed = true;
+				return stream;
+			}
+
 			str.resize(size);
 			stream.ReadRaw(str.data(), size);
 
@@ -39,6 +71,12 @@ namespace Spike {
 			size_t size = 0;
 			stream >> size;
 
+			// a corrupted size must not turn into a huge allocation, every element takes at least a byte
+			if (!stream.CanRead(size, std::is_trivial<T>() ? sizeof(T) : 1)) {
+				stream.m_Failed = true;
+				return stream;
+			}
+
 			v.resize(size);
 			if constexpr (std::is_trivial<T>()) {
 				stream.ReadRaw(v.data(), sizeof(T) * size);
@@ -57,6 +95,11 @@ namespace Spike {
 			size_t size = 0;
 			stream >> size;
 
+			if (!stream.CanRead(size)) {
+				stream.m_Failed = true;
+				return stream;
+			}
+
 			m.reserve(size);
 			for (size_t i = 0; i < size; i++) {
 
@@ -69,6 +112,12 @@ namespace Spike {
 
 	private:
 		std::ifstream m_Stream;
+
+		const uint8_t* m_Data;
+		size_t m_Size;
+		size_t m_Offset;
+
+		bool m_Failed;
 	};
 
 	class BinaryWriteStream {
@@ -0,0 +1,56 @@
+#include <Engine/Serialization/MappedFile.h>
+#include <Engine/Core/Core.h>
+
+#ifdef ENGINE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace Spike {
+
+	MappedFile::MappedFile(const std::filesystem::path& path) : m_Data(nullptr), m_Size(0), m_File(nullptr), m_Mapping(nullptr) {
+
+#ifdef ENGINE_PLATFORM_WINDOWS
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return;
+		}
+
+		// start reading the whole file in the background, instead of faulting it in page by page
+		WIN32_MEMORY_RANGE_ENTRY range{ view, (SIZE_T)size.QuadPart };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Data = (const uint8_t*)view;
+		m_Size = (size_t)size.QuadPart;
+#endif
+	}
+
+	MappedFile::~MappedFile() {
+
+#ifdef ENGINE_PLATFORM_WINDOWS
+		if (m_Data) UnmapViewOfFile(m_Data);
+		if (m_Mapping) CloseHandle((HANDLE)m_Mapping);
+		if (m_File) CloseHandle((HANDLE)m_File);
+#endif
+	}
+}
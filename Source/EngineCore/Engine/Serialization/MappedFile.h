@@ -0,0 +1,28 @@
+#pragma once
+
+#include <filesystem>
+
+namespace Spike {
+
+	// read only view of a whole file, pages are loaded by the os on access
+	class MappedFile {
+	public:
+		MappedFile(const std::filesystem::path& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		bool IsOpen() const { return m_Data != nullptr; }
+
+		const uint8_t* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		const uint8_t* m_Data;
+		size_t m_Size;
+
+		void* m_File;
+		void* m_Mapping;
+	};
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <Engine/Utils/MathUtils.h>
+#include <cfloat>
+
+namespace Spike {
+
+	struct AABB {
+
+		Vec3 Min = Vec3(FLT_MAX);
+		Vec3 Max = Vec3(-FLT_MAX);
+
+		AABB() = default;
+		AABB(const Vec3& min, const Vec3& max) : Min(min), Max(max) {}
+
+		static AABB FromSphere(const Vec3& center, float radius) { return AABB(center - Vec3(radius), center + Vec3(radius)); }
+
+		bool IsEmpty() const { return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z; }
+
+		Vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+		Vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+		float GetSurfaceArea() const {
+			if (IsEmpty()) return 0.f;
+
+			Vec3 size = Max - Min;
+			return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		void Extend(const Vec3& point) {
+			Min = glm::min(Min, point);
+			Max = glm::max(Max, point);
+		}
+
+		void Extend(const AABB& other) {
+			Min = glm::min(Min, other.Min);
+			Max = glm::max(Max, other.Max);
+		}
+
+		bool Contains(const Vec3& point) const { return glm::all(glm::greaterThanEqual(point, Min)) && glm::all(glm::lessThanEqual(point, Max)); }
+		bool Overlaps(const AABB& other) const { return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::greaterThanEqual(Max, other.Min)); }
+
+		float DistanceSquared(const Vec3& point) const {
+			Vec3 delta = glm::max(glm::max(Min - point, point - Max), Vec3(0.f));
+			return glm::dot(delta, delta);
+		}
+
+		bool OverlapsSphere(const Vec3& center, float radius) const { return DistanceSquared(center) <= radius * radius; }
+	};
+
+	struct Ray {
+
+		Vec3 Origin;
+		Vec3 Direction; // normalized
+
+		// 1 / direction, infinities for axis aligned rays are handled by the slab test
+		Vec3 InvDirection;
+
+		Ray() = default;
+		Ray(const Vec3& origin, const Vec3& direction) : Origin(origin), Direction(direction), InvDirection(1.f / direction) {}
+
+		// distance to the entry point, or FLT_MAX if the box is missed within maxDistance
+		float Intersect(const AABB& box, float maxDistance) const {
+			Vec3 t0 = (box.Min - Origin) * InvDirection;
+			Vec3 t1 = (box.Max - Origin) * InvDirection;
+
+			Vec3 tMin = glm::min(t0, t1);
+			Vec3 tMax = glm::max(t0, t1);
+
+			float entry = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+			float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+			return entry <= exit ? entry : FLT_MAX;
+		}
+	};
+
+	enum class EFrustumTest : uint8_t {
+
+		EOutside = 0,
+		EIntersect,
+		EInside
+	};
+
+	struct Frustum {
+
+		// normalized, normals point inside: left, right, bottom, top, near, far
+		Vec4 Planes[6];
+
+		static Frustum FromViewProj(const Mat4x4& vp) {
+			Frustum frustum{};
+
+			for (int i = 0; i < 3; i++) {
+				frustum.Planes[i * 2 + 0] = Vec4(vp[0][3] + vp[0][i], vp[1][3] + vp[1][i], vp[2][3] + vp[2][i], vp[3][3] + vp[3][i]);
+				frustum.Planes[i * 2 + 1] = Vec4(vp[0][3] - vp[0][i], vp[1][3] - vp[1][i], vp[2][3] - vp[2][i], vp[3][3] - vp[3][i]);
+			}
+
+			for (Vec4& plane : frustum.Planes) {
+				plane /= glm::length(Vec3(plane));
+			}
+			return frustum;
+		}
+
+		bool TestSphere(const Vec3& center, float radius) const {
+			for (const Vec4& plane : Planes) {
+				if (glm::dot(Vec3(plane), center) + plane.w < -radius) return false;
+			}
+			return true;
+		}
+
+		EFrustumTest TestAABB(const AABB& box) const {
+			Vec3 center = box.GetCenter();
+			Vec3 extents = box.GetExtents();
+
+			EFrustumTest result = EFrustumTest::EInside;
+			for (const Vec4& plane : Planes) {
+				float distance = glm::dot(Vec3(plane), center) + plane.w;
+				float radius = glm::dot(glm::abs(Vec3(plane)), extents);
+
+				if (distance < -radius) return EFrustumTest::EOutside;
+				if (distance < radius) result = EFrustumTest::EIntersect;
+			}
+			return result;
+		}
+	};
+}
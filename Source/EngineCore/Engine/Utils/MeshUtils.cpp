@@ -0,0 +1,960 @@
+#include <Engine/Utils/MeshUtils.h>
+#include <Engine/Utils/MathUtils.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+// utility
+namespace {
+
+	// area weighted sum of squared plane distances, the symmetric matrix is stored by its upper half
+	struct Quadric {
+
+		float A00, A11, A22;
+		float A01, A02, A12;
+		float B0, B1, B2;
+		float C;
+		float W;
+	};
+
+	void AddPlaneQuadric(Quadric& q, const Vec3& n, float d, float w) {
+		q.A00 += n.x * n.x * w;
+		q.A11 += n.y * n.y * w;
+		q.A22 += n.z * n.z * w;
+		q.A01 += n.x * n.y * w;
+		q.A02 += n.x * n.z * w;
+		q.A12 += n.y * n.z * w;
+		q.B0 += n.x * d * w;
+		q.B1 += n.y * d * w;
+		q.B2 += n.z * d * w;
+		q.C += d * d * w;
+		q.W += w;
+	}
+
+	void AddQuadric(Quadric& q, const Quadric& other) {
+		q.A00 += other.A00;
+		q.A11 += other.A11;
+		q.A22 += other.A22;
+		q.A01 += other.A01;
+		q.A02 += other.A02;
+		q.A12 += other.A12;
+		q.B0 += other.B0;
+		q.B1 += other.B1;
+		q.B2 += other.B2;
+		q.C += other.C;
+		q.W += other.W;
+	}
+
+	// mean squared distance of the point to the planes of the quadric
+	float QuadricError(const Quadric& q, const Vec3& p) {
+		float rx = q.A00 * p.x + q.A01 * p.y + q.A02 * p.z;
+		float ry = q.A01 * p.x + q.A11 * p.y + q.A12 * p.z;
+		float rz = q.A02 * p.x + q.A12 * p.y + q.A22 * p.z;
+
+		float r = p.x * rx + p.y * ry + p.z * rz + 2.f * (q.B0 * p.x + q.B1 * p.y + q.B2 * p.z) + q.C;
+		return q.W > 0.f ? std::abs(r) / q.W : 0.f;
+	}
+
+	struct Collapse {
+		float Cost;
+		float Error;
+		uint32_t From;
+		uint32_t To;
+	};
+
+	uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+	}
+
+	// fifo cache by timestamps, a vertex stays cached until size misses came after its own
+	struct FifoCache {
+
+		std::vector<uint32_t> Timestamps;
+		uint32_t Time;
+		uint32_t Size;
+
+		FifoCache(uint32_t numVertices, uint32_t size) : Timestamps(numVertices, 0), Time(size + 1), Size(size) {}
+
+		bool Miss(uint32_t v) {
+			if (Time - Timestamps[v] <= Size) return false;
+
+			Timestamps[v] = Time++;
+			return true;
+		}
+
+		uint32_t MissTriangle(const uint32_t* tri) {
+			return (uint32_t)Miss(tri[0]) + (uint32_t)Miss(tri[1]) + (uint32_t)Miss(tri[2]);
+		}
+
+		void Reset() {
+			Time += Size + 1;
+		}
+	};
+
+	// size of the lru cache the triangle order is scored against
+	constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+	constexpr uint32_t FORSYTH_VALENCE_TABLE_SIZE = 32;
+
+	struct ForsythTables {
+
+		float Cache[FORSYTH_CACHE_SIZE];
+		float Valence[FORSYTH_VALENCE_TABLE_SIZE];
+	};
+
+	// scores from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const ForsythTables& GetForsythTables() {
+		static const ForsythTables tables = [] {
+			ForsythTables t{};
+
+			// vertices of the last triangle get a fixed score, otherwise the order would strip along one edge
+			for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+				t.Cache[i] = i < 3 ? 0.75f : std::pow(1.f - float(i - 3) / float(FORSYTH_CACHE_SIZE - 3), 1.5f);
+			}
+
+			// vertices with few triangles left are finished first, so they don't have to come back into the cache
+			t.Valence[0] = 0.f;
+			for (uint32_t i = 1; i < FORSYTH_VALENCE_TABLE_SIZE; i++) {
+				t.Valence[i] = 2.f / std::sqrt(float(i));
+			}
+			return t;
+			}();
+
+		return tables;
+	}
+
+	float ForsythScore(const ForsythTables& tables, int32_t cachePosition, uint32_t liveTriangles) {
+		if (liveTriangles == 0) return -1.f;
+
+		float score = cachePosition >= 0 ? tables.Cache[cachePosition] : 0.f;
+		score += liveTriangles < FORSYTH_VALENCE_TABLE_SIZE ? tables.Valence[liveTriangles] : 2.f / std::sqrt(float(liveTriangles));
+		return score;
+	}
+
+	// unused triangles after the cursor a meshlet looks at once its own triangles have no free neighbours
+	constexpr uint32_t MESHLET_SEED_WINDOW = 256;
+
+	// normals spread wider than this can't be culled by their cone anyway, about 84 degrees off the axis
+	constexpr float MIN_CONE_DOT = 0.1f;
+
+	bool IndicesInRange(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices) {
+		for (uint32_t i = 0; i < numIndices; i++) {
+			if (indices[i] >= numVertices) return false;
+		}
+		return true;
+	}
+}
+
+std::vector<uint32_t> Spike::MeshUtils::SimplifyMesh(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices,
+	uint32_t targetIndexCount, float maxError, float* outError) {
+
+	const uint32_t numVertices = mesh.NumVertices;
+	const uint32_t numAttributes = std::min(mesh.NumAttributes, MAX_SIMPLIFY_ATTRIBUTES);
+
+	std::vector<uint32_t> result;
+	result.reserve(numIndices);
+
+	// degenerate and out of range triangles are dropped right away
+	for (uint32_t i = 0; i + 2 < numIndices; i += 3) {
+		uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+
+		if (a >= numVertices || b >= numVertices || c >= numVertices) continue;
+		if (a == b || b == c || a == c) continue;
+
+		result.push_back(a);
+		result.push_back(b);
+		result.push_back(c);
+	}
+
+	if (outError) *outError = 0.f;
+	if (result.size() <= targetIndexCount || numVertices == 0) return result;
+
+	auto position = [&](uint32_t v) {
+		const float* p = (const float*)((const uint8_t*)mesh.Positions + (size_t)v * mesh.PositionStride);
+		return Vec3(p[0], p[1], p[2]);
+		};
+
+	auto attribute = [&](uint32_t v) {
+		return (const float*)((const uint8_t*)mesh.Attributes + (size_t)v * mesh.AttributeStride);
+		};
+
+	// positions are moved into the unit box, so errors and the flip test don't depend on the mesh scale
+	Vec3 minPos = position(0), maxPos = position(0);
+	for (uint32_t v = 1; v < numVertices; v++) {
+		minPos = glm::min(minPos, position(v));
+		maxPos = glm::max(maxPos, position(v));
+	}
+
+	Vec3 extents = maxPos - minPos;
+	float scale = std::max(std::max(extents.x, extents.y), extents.z);
+	float invScale = scale > 0.f ? 1.f / scale : 0.f;
+
+	std::vector<Vec3> positions(numVertices);
+	for (uint32_t v = 0; v < numVertices; v++) {
+		positions[v] = (position(v) - minPos) * invScale;
+	}
+
+	// vertices with the same position are one point of the surface, edges are classified on those points
+	std::vector<uint32_t> pointOf(numVertices);
+	std::vector<uint32_t> wedgeCounts(numVertices, 0);
+	{
+		struct PositionHash {
+			size_t operator()(const Vec3& p) const {
+				uint32_t bits[3];
+				memcpy(bits, &p, sizeof(bits));
+				return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+			}
+		};
+
+		std::unordered_map<Vec3, uint32_t, PositionHash> points;
+		points.reserve(numVertices);
+
+		for (uint32_t v = 0; v < numVertices; v++) {
+			auto [it, inserted] = points.emplace(positions[v], v);
+			pointOf[v] = it->second;
+			wedgeCounts[it->second]++;
+		}
+	}
+
+	// open and non manifold edges keep their points, so do seams, moving one wedge of a point would open a crack
+	std::vector<uint8_t> locked(numVertices, 0);
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve(result.size());
+
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (uint32_t e = 0; e < 3; e++) {
+				uint32_t a = pointOf[result[i + e]];
+				uint32_t b = pointOf[result[i + (e + 1) % 3]];
+				edgeCounts[EdgeKey(a, b)]++;
+			}
+		}
+
+		std::vector<uint8_t> lockedPoints(numVertices, 0);
+		for (const auto& [key, count] : edgeCounts) {
+			if (count == 2) continue;
+
+			lockedPoints[uint32_t(key >> 32)] = 1;
+			lockedPoints[uint32_t(key & 0xFFFFFFFF)] = 1;
+		}
+
+		for (uint32_t v = 0; v < numVertices; v++) {
+			locked[v] = lockedPoints[pointOf[v]] || wedgeCounts[pointOf[v]] > 1;
+		}
+	}
+
+	std::vector<Quadric> quadrics(numVertices, Quadric{});
+	for (size_t i = 0; i < result.size(); i += 3) {
+		const Vec3& p0 = positions[result[i]];
+		const Vec3& p1 = positions[result[i + 1]];
+		const Vec3& p2 = positions[result[i + 2]];
+
+		Vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		if (length <= 0.f) continue;
+
+		normal /= length;
+		float area = length * 0.5f;
+		float d = -glm::dot(normal, p0);
+
+		for (uint32_t k = 0; k < 3; k++) {
+			AddPlaneQuadric(quadrics[result[i + k]], normal, d, area);
+		}
+	}
+
+	auto attributeCost = [&](uint32_t from, uint32_t to) {
+		float cost = 0.f;
+		if (!mesh.Attributes) return cost;
+
+		const float* a = attribute(from);
+		const float* b = attribute(to);
+
+		for (uint32_t k = 0; k < numAttributes; k++) {
+			float diff = (a[k] - b[k]) * mesh.AttributeWeights[k];
+			cost += diff * diff;
+		}
+		return cost;
+		};
+
+	const float errorLimit = maxError * invScale * maxError * invScale;
+	float appliedError = 0.f;
+
+	std::vector<uint32_t> remap(numVertices);
+	std::vector<uint8_t> touched(numVertices);
+	std::vector<uint32_t> adjacencyOffsets(numVertices + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+
+	for (uint32_t v = 0; v < numVertices; v++) {
+		remap[v] = v;
+	}
+
+	// every pass collapses the cheapest edges that don't touch each other, then rebuilds the triangles
+	while (result.size() > targetIndexCount) {
+		const uint32_t numTriangles = uint32_t(result.size() / 3);
+
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : result) {
+			adjacencyOffsets[index + 1]++;
+		}
+		for (uint32_t v = 0; v < numVertices; v++) {
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (uint32_t t = 0; t < numTriangles; t++) {
+				for (uint32_t k = 0; k < 3; k++) {
+					adjacency[fill[result[t * 3 + k]]++] = t;
+				}
+			}
+		}
+
+		// cheapest collapse of every movable vertex onto one of its neighbours
+		collapses.clear();
+		for (uint32_t v = 0; v < numVertices; v++) {
+			if (locked[v]) continue;
+
+			Collapse best{ FLT_MAX, 0.f, v, v };
+			for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+				const uint32_t* tri = &result[adjacency[a] * 3];
+
+				for (uint32_t k = 0; k < 3; k++) {
+					uint32_t to = tri[k];
+					if (to == v) continue;
+
+					float error = QuadricError(quadrics[v], positions[to]);
+					float cost = error + attributeCost(v, to);
+
+					if (cost < best.Cost || (cost == best.Cost && to < best.To)) {
+						best.Cost = cost;
+						best.Error = error;
+						best.To = to;
+					}
+				}
+			}
+
+			if (best.To != v && best.Error <= errorLimit) {
+				collapses.push_back(best);
+			}
+		}
+
+		if (collapses.empty()) break;
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.Cost != b.Cost ? a.Cost < b.Cost : a.From < b.From;
+			});
+
+		std::fill(touched.begin(), touched.end(), 0);
+		uint32_t remainingTriangles = numTriangles;
+		uint32_t applied = 0;
+
+		for (const Collapse& c : collapses) {
+			if (remainingTriangles * 3 <= targetIndexCount) break;
+			if (touched[c.From] || touched[c.To]) continue;
+
+			// triangles around the moved vertex must not flip, ones sharing the edge disappear
+			bool flips = false;
+			uint32_t removed = 0;
+
+			for (uint32_t a = adjacencyOffsets[c.From]; a < adjacencyOffsets[c.From + 1] && !flips; a++) {
+				const uint32_t* tri = &result[adjacency[a] * 3];
+				uint32_t v0 = remap[tri[0]], v1 = remap[tri[1]], v2 = remap[tri[2]];
+
+				if (v0 == v1 || v1 == v2 || v0 == v2) continue;
+				if (v0 == c.To || v1 == c.To || v2 == c.To) {
+					removed++;
+					continue;
+				}
+
+				Vec3 before = glm::cross(positions[v1] - positions[v0], positions[v2] - positions[v0]);
+
+				Vec3 p0 = positions[v0 == c.From ? c.To : v0];
+				Vec3 p1 = positions[v1 == c.From ? c.To : v1];
+				Vec3 p2 = positions[v2 == c.From ? c.To : v2];
+				Vec3 after = glm::cross(p1 - p0, p2 - p0);
+
+				flips = glm::dot(before, after) <= 0.f;
+			}
+
+			if (flips) continue;
+
+			remap[c.From] = c.To;
+			touched[c.From] = 1;
+			touched[c.To] = 1;
+
+			AddQuadric(quadrics[c.To], quadrics[c.From]);
+			appliedError = std::max(appliedError, c.Error);
+
+			remainingTriangles -= std::min(removed, remainingTriangles);
+			applied++;
+		}
+
+		if (applied == 0) break;
+
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if (a == b || b == c || a == c) continue;
+
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	if (outError) *outError = std::sqrt(appliedError) * scale;
+	return result;
+}
+
+Spike::MeshUtils::VertexCacheStats Spike::MeshUtils::AnalyzeVertexCache(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize) {
+	VertexCacheStats stats{};
+
+	FifoCache cache(numVertices, cacheSize);
+	std::vector<uint8_t> used(numVertices, 0);
+	uint32_t numUsed = 0;
+
+	const uint32_t numTriangles = numIndices / 3;
+	for (uint32_t i = 0; i < numTriangles * 3; i++) {
+		uint32_t v = indices[i];
+		if (v >= numVertices) continue;
+
+		if (!used[v]) {
+			used[v] = 1;
+			numUsed++;
+		}
+
+		if (cache.Miss(v)) {
+			stats.VerticesTransformed++;
+		}
+	}
+
+	stats.ACMR = numTriangles > 0 ? float(stats.VerticesTransformed) / numTriangles : 0.f;
+	stats.ATVR = numUsed > 0 ? float(stats.VerticesTransformed) / numUsed : 0.f;
+	return stats;
+}
+
+std::vector<uint32_t> Spike::MeshUtils::GenerateVertexRemap(const void* vertices, uint32_t vertexSize, uint32_t numVertices, uint32_t* outNumUnique) {
+	const uint8_t* data = (const uint8_t*)vertices;
+
+	struct VertexHash {
+		const uint8_t* Data;
+		uint32_t Size;
+
+		size_t operator()(uint32_t v) const {
+			const uint8_t* bytes = Data + (size_t)v * Size;
+
+			// fnv-1a
+			uint64_t hash = 14695981039346656037ull;
+			for (uint32_t i = 0; i < Size; i++) {
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+			return (size_t)hash;
+		}
+	};
+
+	struct VertexEqual {
+		const uint8_t* Data;
+		uint32_t Size;
+
+		bool operator()(uint32_t a, uint32_t b) const {
+			return memcmp(Data + (size_t)a * Size, Data + (size_t)b * Size, Size) == 0;
+		}
+	};
+
+	std::unordered_map<uint32_t, uint32_t, VertexHash, VertexEqual> unique(numVertices, VertexHash{ data, vertexSize }, VertexEqual{ data, vertexSize });
+	std::vector<uint32_t> remap(numVertices);
+
+	for (uint32_t v = 0; v < numVertices; v++) {
+		auto [it, inserted] = unique.emplace(v, (uint32_t)unique.size());
+		remap[v] = it->second;
+	}
+
+	if (outNumUnique) *outNumUnique = (uint32_t)unique.size();
+	return remap;
+}
+
+std::vector<uint32_t> Spike::MeshUtils::OptimizeVertexCache(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices) {
+	const uint32_t numTriangles = numIndices / 3;
+
+	// a trailing partial triangle is kept where it is
+	std::vector<uint32_t> result(indices, indices + numIndices);
+	if (numTriangles == 0 || !IndicesInRange(indices, numTriangles * 3, numVertices)) return result;
+
+	const ForsythTables& tables = GetForsythTables();
+
+	// triangles of every vertex, the ones not emitted yet are kept at the front of its range
+	std::vector<uint32_t> liveTriangles(numVertices, 0);
+	for (uint32_t i = 0; i < numTriangles * 3; i++) {
+		liveTriangles[indices[i]]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+	for (uint32_t v = 0; v < numVertices; v++) {
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+
+	std::vector<uint32_t> adjacency(numTriangles * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t t = 0; t < numTriangles; t++) {
+			for (uint32_t k = 0; k < 3; k++) {
+				adjacency[fill[indices[t * 3 + k]]++] = t;
+			}
+		}
+	}
+
+	std::vector<int32_t> cachePositions(numVertices, -1);
+	std::vector<float> vertexScores(numVertices);
+	for (uint32_t v = 0; v < numVertices; v++) {
+		vertexScores[v] = ForsythScore(tables, -1, liveTriangles[v]);
+	}
+
+	auto triangleScore = [&](uint32_t t) {
+		return vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		};
+
+	uint32_t best = 0;
+	float bestScore = triangleScore(0);
+	for (uint32_t t = 1; t < numTriangles; t++) {
+		float score = triangleScore(t);
+		if (score > bestScore) {
+			best = t;
+			bestScore = score;
+		}
+	}
+
+	std::vector<uint8_t> emitted(numTriangles, 0);
+	uint32_t cursor = 0;
+
+	// three extra slots hold what the emitted triangle pushes out of the cache
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+
+	for (uint32_t out = 0; out < numTriangles; out++) {
+
+		// dead end, nothing in the cache has triangles left, carry on with the next one in input order
+		if (best == UINT32_MAX) {
+			while (emitted[cursor]) cursor++;
+			best = cursor;
+		}
+
+		const uint32_t* tri = &indices[best * 3];
+		result[out * 3] = tri[0];
+		result[out * 3 + 1] = tri[1];
+		result[out * 3 + 2] = tri[2];
+		emitted[best] = 1;
+
+		for (uint32_t k = 0; k < 3; k++) {
+			uint32_t v = tri[k];
+			uint32_t* list = &adjacency[adjacencyOffsets[v]];
+
+			for (uint32_t i = 0; i < liveTriangles[v]; i++) {
+				if (list[i] != best) continue;
+
+				std::swap(list[i], list[liveTriangles[v] - 1]);
+				break;
+			}
+			liveTriangles[v]--;
+		}
+
+		// the triangle's vertices move to the front, the rest keep their order behind them
+		uint32_t newCount = 0;
+		for (uint32_t k = 0; k < 3; k++) {
+			if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount) {
+				newCache[newCount++] = tri[k];
+			}
+		}
+		for (uint32_t i = 0; i < cacheCount; i++) {
+			uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				newCache[newCount++] = v;
+			}
+		}
+
+		for (uint32_t i = 0; i < newCount; i++) {
+			uint32_t v = newCache[i];
+			cachePositions[v] = i < FORSYTH_CACHE_SIZE ? (int32_t)i : -1;
+			vertexScores[v] = ForsythScore(tables, cachePositions[v], liveTriangles[v]);
+		}
+
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		// only triangles around the cache changed their score, the best of them comes next
+		best = UINT32_MAX;
+		bestScore = -FLT_MAX;
+
+		for (uint32_t i = 0; i < newCount; i++) {
+			uint32_t v = newCache[i];
+			const uint32_t* list = &adjacency[adjacencyOffsets[v]];
+
+			for (uint32_t a = 0; a < liveTriangles[v]; a++) {
+				float score = triangleScore(list[a]);
+				if (score > bestScore) {
+					best = list[a];
+					bestScore = score;
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<uint32_t> Spike::MeshUtils::OptimizeOverdraw(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices, float threshold) {
+	const uint32_t numVertices = mesh.NumVertices;
+	const uint32_t numTriangles = numIndices / 3;
+
+	std::vector<uint32_t> result(indices, indices + numIndices);
+	if (numTriangles < 2 || !IndicesInRange(indices, numTriangles * 3, numVertices)) return result;
+
+	// hard boundaries, a triangle missing the cache with all of its vertices starts over anyway
+	FifoCache cache(numVertices, VERTEX_CACHE_SIZE);
+	std::vector<uint32_t> hardStarts;
+
+	for (uint32_t t = 0; t < numTriangles; t++) {
+		if (cache.MissTriangle(&indices[t * 3]) == 3 || t == 0) {
+			hardStarts.push_back(t);
+		}
+	}
+	hardStarts.push_back(numTriangles);
+
+	// soft boundaries, starting from a cold cache a cluster is cut once its acmr comes within the threshold of the whole range's
+	std::vector<uint32_t> clusterStarts;
+
+	for (size_t h = 0; h + 1 < hardStarts.size(); h++) {
+		uint32_t start = hardStarts[h];
+		uint32_t end = hardStarts[h + 1];
+
+		cache.Reset();
+		uint32_t misses = 0;
+		for (uint32_t t = start; t < end; t++) {
+			misses += cache.MissTriangle(&indices[t * 3]);
+		}
+		float limit = float(misses) / float(end - start) * threshold;
+
+		cache.Reset();
+		clusterStarts.push_back(start);
+		uint32_t clusterStart = start;
+		misses = 0;
+
+		for (uint32_t t = start; t + 1 < end; t++) {
+			misses += cache.MissTriangle(&indices[t * 3]);
+			if (float(misses) > limit * float(t + 1 - clusterStart)) continue;
+
+			cache.Reset();
+			clusterStarts.push_back(t + 1);
+			clusterStart = t + 1;
+			misses = 0;
+		}
+	}
+	clusterStarts.push_back(numTriangles);
+
+	auto position = [&](uint32_t v) {
+		const float* p = (const float*)((const uint8_t*)mesh.Positions + (size_t)v * mesh.PositionStride);
+		return Vec3(p[0], p[1], p[2]);
+		};
+
+	struct Cluster {
+		uint32_t Start;
+		uint32_t End;
+		Vec3 Centroid;
+		Vec3 Normal;
+		float Area;
+	};
+
+	std::vector<Cluster> clusters(clusterStarts.size() - 1);
+	Vec3 meshCentroid(0.f);
+	float meshArea = 0.f;
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		Cluster& cluster = clusters[c];
+		cluster = Cluster{ clusterStarts[c], clusterStarts[c + 1], Vec3(0.f), Vec3(0.f), 0.f };
+
+		for (uint32_t t = cluster.Start; t < cluster.End; t++) {
+			Vec3 p0 = position(indices[t * 3]);
+			Vec3 p1 = position(indices[t * 3 + 1]);
+			Vec3 p2 = position(indices[t * 3 + 2]);
+
+			// the cross product is twice the area along the normal, so its sum is the area weighted normal
+			Vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			cluster.Centroid += (p0 + p1 + p2) * (area / 3.f);
+			cluster.Normal += normal;
+			cluster.Area += area;
+		}
+
+		meshCentroid += cluster.Centroid;
+		meshArea += cluster.Area;
+	}
+
+	if (meshArea <= 0.f) return result;
+	meshCentroid /= meshArea;
+
+	// clusters facing away from the center are in front of the rest from most directions
+	std::vector<float> sortKeys(clusters.size(), 0.f);
+	for (size_t c = 0; c < clusters.size(); c++) {
+		const Cluster& cluster = clusters[c];
+
+		float length = glm::length(cluster.Normal);
+		if (cluster.Area <= 0.f || length <= 0.f) continue;
+
+		sortKeys[c] = glm::dot(cluster.Centroid / cluster.Area - meshCentroid, cluster.Normal / length);
+	}
+
+	std::vector<uint32_t> order(clusters.size());
+	for (uint32_t c = 0; c < (uint32_t)order.size(); c++) {
+		order[c] = c;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return sortKeys[a] > sortKeys[b];
+		});
+
+	uint32_t write = 0;
+	for (uint32_t c : order) {
+		const Cluster& cluster = clusters[c];
+		std::copy(indices + cluster.Start * 3, indices + cluster.End * 3, result.begin() + write);
+		write += (cluster.End - cluster.Start) * 3;
+	}
+
+	return result;
+}
+
+std::vector<uint32_t> Spike::MeshUtils::GenerateFetchRemap(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t* outNumUsed) {
+	std::vector<uint32_t> remap(numVertices, UINT32_MAX);
+	uint32_t next = 0;
+
+	for (uint32_t i = 0; i < numIndices; i++) {
+		uint32_t v = indices[i];
+		if (v >= numVertices || remap[v] != UINT32_MAX) continue;
+
+		remap[v] = next++;
+	}
+
+	if (outNumUsed) *outNumUsed = next;
+	return remap;
+}
+
+std::vector<uint32_t> Spike::MeshUtils::BuildMeshlets(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices,
+	uint32_t maxVertices, uint32_t maxTriangles, std::vector<Vec2Uint>& outRanges) {
+
+	const uint32_t numVertices = mesh.NumVertices;
+	const uint32_t numTriangles = numIndices / 3;
+
+	std::vector<uint32_t> result;
+	result.reserve(numIndices);
+	outRanges.clear();
+
+	if (numTriangles == 0 || maxVertices < 3 || maxTriangles == 0 || !IndicesInRange(indices, numTriangles * 3, numVertices)) {
+		result.assign(indices, indices + numTriangles * 3);
+		if (numTriangles > 0) outRanges.push_back(Vec2Uint(0, numTriangles * 3));
+		return result;
+	}
+
+	auto position = [&](uint32_t v) {
+		const float* p = (const float*)((const uint8_t*)mesh.Positions + (size_t)v * mesh.PositionStride);
+		return Vec3(p[0], p[1], p[2]);
+		};
+
+	// vertices with the same position are one point, triangles are neighbours through their points
+	std::vector<uint32_t> pointOf(numVertices);
+	{
+		struct PositionHash {
+			size_t operator()(const Vec3& p) const {
+				uint32_t bits[3];
+				memcpy(bits, &p, sizeof(bits));
+				return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+			}
+		};
+
+		std::unordered_map<Vec3, uint32_t, PositionHash> points;
+		points.reserve(numVertices);
+
+		for (uint32_t v = 0; v < numVertices; v++) {
+			pointOf[v] = points.emplace(position(v), v).first->second;
+		}
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+	for (uint32_t i = 0; i < numTriangles * 3; i++) {
+		adjacencyOffsets[pointOf[indices[i]] + 1]++;
+	}
+	for (uint32_t v = 0; v < numVertices; v++) {
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+
+	std::vector<uint32_t> adjacency(numTriangles * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t t = 0; t < numTriangles; t++) {
+			for (uint32_t k = 0; k < 3; k++) {
+				adjacency[fill[pointOf[indices[t * 3 + k]]]++] = t;
+			}
+		}
+	}
+
+	std::vector<Vec3> centroids(numTriangles);
+	for (uint32_t t = 0; t < numTriangles; t++) {
+		centroids[t] = (position(indices[t * 3]) + position(indices[t * 3 + 1]) + position(indices[t * 3 + 2])) / 3.f;
+	}
+
+	std::vector<uint8_t> used(numTriangles, 0);
+
+	// meshlet a vertex was last added to, so membership is a single compare
+	std::vector<uint32_t> vertexMeshlet(numVertices, UINT32_MAX);
+	std::vector<uint32_t> meshletVertices;
+	meshletVertices.reserve(maxVertices);
+
+	uint32_t cursor = 0;
+	uint32_t emitted = 0;
+
+	while (emitted < numTriangles) {
+		const uint32_t meshlet = (uint32_t)outRanges.size();
+		const uint32_t firstIndex = (uint32_t)result.size();
+
+		meshletVertices.clear();
+		Vec3 centerSum(0.f);
+		uint32_t triangleCount = 0;
+
+		auto newVertices = [&](uint32_t t) {
+			const uint32_t* tri = &indices[t * 3];
+			uint32_t count = 0;
+
+			for (uint32_t k = 0; k < 3; k++) {
+				bool repeated = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+				if (!repeated && vertexMeshlet[tri[k]] != meshlet) count++;
+			}
+			return count;
+			};
+
+		auto addTriangle = [&](uint32_t t) {
+			const uint32_t* tri = &indices[t * 3];
+
+			for (uint32_t k = 0; k < 3; k++) {
+				result.push_back(tri[k]);
+				if (vertexMeshlet[tri[k]] == meshlet) continue;
+
+				vertexMeshlet[tri[k]] = meshlet;
+				meshletVertices.push_back(tri[k]);
+			}
+
+			centerSum += centroids[t];
+			used[t] = 1;
+			triangleCount++;
+			emitted++;
+			};
+
+		while (used[cursor]) cursor++;
+		addTriangle(cursor);
+
+		while (triangleCount < maxTriangles) {
+			Vec3 center = centerSum / float(triangleCount);
+
+			uint32_t best = UINT32_MAX;
+			uint32_t bestNew = 4;
+			float bestDistance = FLT_MAX;
+
+			auto consider = [&](uint32_t t) {
+				if (used[t]) return;
+
+				uint32_t count = newVertices(t);
+				if (meshletVertices.size() + count > maxVertices || count > bestNew) return;
+
+				Vec3 offset = centroids[t] - center;
+				float distance = glm::dot(offset, offset);
+
+				if (count < bestNew || distance < bestDistance || (distance == bestDistance && t < best)) {
+					best = t;
+					bestNew = count;
+					bestDistance = distance;
+				}
+				};
+
+			for (uint32_t v : meshletVertices) {
+				uint32_t point = pointOf[v];
+				for (uint32_t a = adjacencyOffsets[point]; a < adjacencyOffsets[point + 1]; a++) {
+					consider(adjacency[a]);
+				}
+			}
+
+			// no free neighbours left, the closest of the next unused triangles keeps the meshlet from ending small
+			if (best == UINT32_MAX) {
+				uint32_t seen = 0;
+				for (uint32_t t = cursor; t < numTriangles && seen < MESHLET_SEED_WINDOW; t++) {
+					if (used[t]) continue;
+
+					consider(t);
+					seen++;
+				}
+			}
+
+			if (best == UINT32_MAX) break;
+			addTriangle(best);
+		}
+
+		outRanges.push_back(Vec2Uint(firstIndex, triangleCount * 3));
+	}
+
+	return result;
+}
+
+Spike::MeshUtils::ClusterBounds Spike::MeshUtils::ComputeClusterBounds(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices) {
+	ClusterBounds bounds{};
+	if (numIndices < 3 || !IndicesInRange(indices, numIndices, mesh.NumVertices)) return bounds;
+
+	auto position = [&](uint32_t v) {
+		const float* p = (const float*)((const uint8_t*)mesh.Positions + (size_t)v * mesh.PositionStride);
+		return Vec3(p[0], p[1], p[2]);
+		};
+
+	Vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+	for (uint32_t i = 0; i < numIndices; i++) {
+		minPos = glm::min(minPos, position(indices[i]));
+		maxPos = glm::max(maxPos, position(indices[i]));
+	}
+
+	bounds.Center = (minPos + maxPos) * 0.5f;
+	for (uint32_t i = 0; i < numIndices; i++) {
+		bounds.Radius = std::max(bounds.Radius, glm::length(position(indices[i]) - bounds.Center));
+	}
+
+	std::vector<Vec3> normals;
+	normals.reserve(numIndices / 3);
+
+	Vec3 normalSum(0.f);
+	for (uint32_t i = 0; i + 2 < numIndices; i += 3) {
+		Vec3 p0 = position(indices[i]);
+		Vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+
+		// degenerate triangles are never rasterized, so they don't widen the cone
+		float length = glm::length(normal);
+		if (length <= 0.f) continue;
+
+		normals.push_back(normal / length);
+		normalSum += normals.back();
+	}
+
+	float sumLength = glm::length(normalSum);
+	if (normals.empty() || sumLength <= 0.f) return bounds;
+
+	Vec3 axis = normalSum / sumLength;
+
+	float minDot = 1.f;
+	for (const Vec3& normal : normals) {
+		minDot = std::min(minDot, glm::dot(normal, axis));
+	}
+
+	if (minDot < MIN_CONE_DOT) return bounds;
+
+	bounds.ConeAxis = axis;
+	bounds.ConeCutoff = std::sqrt(1.f - minDot * minDot);
+	return bounds;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Engine/Core/Core.h>
+#include <Engine/Utils/MathUtils.h>
+#include <vector>
+
+namespace Spike {
+
+	namespace MeshUtils {
+
+		// per vertex data of a triangle list, read with byte strides so vertex arrays can be passed as they are
+		struct MeshView {
+
+			const float* Positions = nullptr;
+			uint32_t PositionStride = 0;
+			uint32_t NumVertices = 0;
+
+			// optional, attribute differences are added to the collapse cost scaled by their weights
+			const float* Attributes = nullptr;
+			uint32_t AttributeStride = 0;
+			const float* AttributeWeights = nullptr;
+			uint32_t NumAttributes = 0;
+		};
+
+		// quadric edge collapse down to the target index count or until the error limit is reached
+		// vertices are only collapsed onto other vertices, so the result indexes the same vertex array,
+		// border vertices and vertices sharing a position with others (uv or normal seams) are never moved
+		// the result only depends on the input, the same mesh always gives the same indices
+		// error is in position units, the distance of the furthest collapse from the original surface
+		std::vector<uint32_t> SimplifyMesh(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices,
+			uint32_t targetIndexCount, float maxError, float* outError = nullptr);
+
+		constexpr uint32_t MAX_SIMPLIFY_ATTRIBUTES = 8;
+
+		// fifo post transform cache the statistics are measured with, close to what current gpus reuse
+		constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+		// clusters of the overdraw order can be this much worse for the cache than the input
+		constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+		struct VertexCacheStats {
+
+			uint32_t VerticesTransformed = 0;
+
+			// transformed vertices per triangle, 3 without any reuse and around 0.5 at best for a grid
+			float ACMR = 0.f;
+
+			// transformed vertices per referenced vertex, 1 when every vertex is shaded once
+			float ATVR = 0.f;
+		};
+
+		VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+		// maps every vertex onto the first one with the same bytes, unique vertices keep their order
+		// indices become remap[index] and vertex v moves to remap[v]
+		std::vector<uint32_t> GenerateVertexRemap(const void* vertices, uint32_t vertexSize, uint32_t numVertices, uint32_t* outNumUnique = nullptr);
+
+		// Forsyth's linear speed ordering, triangles are picked greedily by the scores of their vertices,
+		// vertices score by their place in an lru cache and by how few triangles they have left
+		std::vector<uint32_t> OptimizeVertexCache(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices);
+
+		// cuts cache optimized indices into clusters and draws the outward facing ones first, so they occlude the rest
+		// a cluster is cut once its own acmr is within the threshold of the input's, so the cache cost stays bounded
+		std::vector<uint32_t> OptimizeOverdraw(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices,
+			float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+		// numbers vertices in the order the indices first use them, unreferenced vertices map to UINT32_MAX
+		std::vector<uint32_t> GenerateFetchRemap(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t* outNumUsed = nullptr);
+
+		// bounding sphere and normal cone of a cluster of triangles
+		struct ClusterBounds {
+
+			Vec3 Center = Vec3(0.f);
+			float Radius = 0.f;
+
+			// every triangle normal is within the cone around the axis, the cutoff is the sine of its half angle,
+			// a cluster only shows back faces to points with dot(center - point, axis) >= cutoff * (distance + radius) + radius
+			// the cutoff is 1 when normals spread too wide, the test never passes then
+			Vec3 ConeAxis = Vec3(0.f);
+			float ConeCutoff = 1.f;
+		};
+
+		// greedy clusters of at most maxVertices unique vertices and maxTriangles triangles, a cluster grows from its seed
+		// by the triangles adding the fewest new vertices and then by the closest ones, seeds follow the index order
+		// connectivity is taken from positions, so clusters don't stop at uv or normal seams
+		// triangles are reordered so every cluster is a contiguous range, ranges are (first index, index count) into the result
+		std::vector<uint32_t> BuildMeshlets(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices,
+			uint32_t maxVertices, uint32_t maxTriangles, std::vector<Vec2Uint>& outRanges);
+
+		// front faces are counter clockwise, as assimp imports them
+		ClusterBounds ComputeClusterBounds(const MeshView& mesh, const uint32_t* indices, uint32_t numIndices);
+	}
+}
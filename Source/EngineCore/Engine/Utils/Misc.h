@@ -5,6 +5,9 @@
 #include <bitset>
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <bit>
+#include <algorithm>
 
 namespace Spike {
 
@@ -32,41 +35,118 @@ namespace Spike {
 			return index;
 		}
 
-		void Release(uint32_t index) { Queue.push_back(index); }
+		void Release(uint32_t index) {
+			Queue.push_back(index);
+
+			// everything handed out came back, start over from zero
+			if (Queue.size() == NextIndex) {
+				Queue.clear();
+				NextIndex = 0;
+			}
+		}
+
+		// every grabbed index is below it
+		uint32_t GetRange() const { return NextIndex; }
 
 	private:
 		uint32_t NextIndex;
 		std::vector<uint32_t> Queue;
 	};
 
+	// IndexQueue for runs of indices, the first free run that fits is taken and released runs merge with their neighbours
+	struct RangeQueue {
+		RangeQueue() : End(0) {}
+
+		uint32_t Grab(uint32_t size) {
+			for (size_t i = 0; i < Free.size(); i++) {
+				if (Free[i].Size < size) continue;
+
+				uint32_t offset = Free[i].Offset;
+				Free[i].Offset += size;
+				Free[i].Size -= size;
+
+				if (Free[i].Size == 0) {
+					Free.erase(Free.begin() + i);
+				}
+				return offset;
+			}
+
+			uint32_t offset = End;
+			End += size;
+			return offset;
+		}
+
+		void Release(uint32_t offset, uint32_t size) {
+			auto it = std::lower_bound(Free.begin(), Free.end(), offset, [](const Run& run, uint32_t value) { return run.Offset < value; });
+			it = Free.insert(it, Run{ offset, size });
+
+			if (it + 1 != Free.end() && it->Offset + it->Size == (it + 1)->Offset) {
+				it->Size += (it + 1)->Size;
+				Free.erase(it + 1);
+			}
+
+			if (it != Free.begin() && (it - 1)->Offset + (it - 1)->Size == it->Offset) {
+				(it - 1)->Size += it->Size;
+				Free.erase(it);
+			}
+
+			// a free run at the end goes back to the unused space
+			if (Free.size() > 0 && Free.back().Offset + Free.back().Size == End) {
+				End = Free.back().Offset;
+				Free.pop_back();
+			}
+		}
+
+		// every grabbed run ends below it
+		uint32_t GetRange() const { return End; }
+
+	private:
+		struct Run {
+			uint32_t Offset;
+			uint32_t Size;
+		};
+
+		uint32_t End;
+		// sorted by offset
+		std::vector<Run> Free;
+	};
+
+	// packed records addressed by stable indices, storage grows and shrinks in whole pages
 	template<typename T>
 	class DenseBuffer {
 	public:
 		DenseBuffer()
-			: m_Nodes(nullptr), m_FreeHead(INVALID_IDX), m_Tail(INVALID_IDX), m_NextNode(0), m_Size(0), m_Ptr(nullptr) {}
-		DenseBuffer(T* ptr, uint32_t maxSize)
-			: m_Nodes(new Node[maxSize]), m_FreeHead(INVALID_IDX), m_Tail(INVALID_IDX), m_NextNode(0), m_Size(0), m_Ptr(ptr) {}
+			: m_Nodes(nullptr), m_OffsetNodes(nullptr), m_FreeHead(INVALID_IDX), m_NextNode(0), m_NodeCapacity(0), m_Size(0),
+			m_Capacity(0), m_PageSize(DEFAULT_PAGE_SIZE), m_Ptr(nullptr), m_DirtyWords(nullptr), m_HighWater(0), m_AnyDirty(false) {}
+
+		// page size is rounded up to whole dirty words, nothing is allocated before the first push
+		DenseBuffer(uint32_t pageSize) : DenseBuffer() { m_PageSize = std::max((pageSize + 63) & ~63u, 64u); }
 		DenseBuffer(const DenseBuffer& copy) = delete;
 
 		DenseBuffer(DenseBuffer&& move) noexcept {
 			m_Nodes = move.m_Nodes;
+			m_OffsetNodes = move.m_OffsetNodes;
 			m_Ptr = move.m_Ptr;
 			m_FreeHead = move.m_FreeHead;
 			m_NextNode = move.m_NextNode;
+			m_NodeCapacity = move.m_NodeCapacity;
 			m_Size = move.m_Size;
-			m_Tail = move.m_Tail;
+			m_Capacity = move.m_Capacity;
+			m_PageSize = move.m_PageSize;
+			m_DirtyWords = move.m_DirtyWords;
+			m_HighWater = move.m_HighWater;
+			m_AnyDirty.store(move.m_AnyDirty.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			move.m_Nodes = nullptr;
+			move.m_OffsetNodes = nullptr;
+			move.m_Ptr = nullptr;
+			move.m_DirtyWords = nullptr;
 		}
-		~DenseBuffer() { if (m_Nodes) delete[] m_Nodes; }
-
-		void Make(T* ptr, uint32_t maxSize) {
-			if (m_Nodes) delete[] m_Nodes;
-
-			m_Nodes = new Node[maxSize];
-			m_Ptr = ptr;
-			m_FreeHead = INVALID_IDX;
-			m_Tail = INVALID_IDX;
-			m_NextNode = 0;
-			m_Size = 0;
+		~DenseBuffer() { 
+			if (m_Nodes) delete[] m_Nodes; 
+			if (m_OffsetNodes) delete[] m_OffsetNodes;
+			if (m_Ptr) delete[] m_Ptr;
+			if (m_DirtyWords) delete[] m_DirtyWords;
 		}
 
 		uint32_t Push(T&& element) {
@@ -74,6 +154,7 @@ namespace Spike {
 			uint32_t nIndex = PushInternal(offset);
 
 			m_Ptr[offset] = std::move(element);
+			MarkDirty(offset);
 			return nIndex;
 		}
 
@@ -82,49 +163,188 @@ namespace Spike {
 			uint32_t nIndex = PushInternal(offset);
 
 			m_Ptr[offset] = element;
+			MarkDirty(offset);
 			return nIndex;
 		}
 
+		// the last record is moved into the freed offset, so records stay packed
 		void Pop(uint32_t idx) {
-			if (m_Size > 0 && idx < m_Size) {
+			if (idx >= m_NextNode || m_Nodes[idx].MemOffset == INVALID_IDX) return;
+
+			uint32_t offset = m_Nodes[idx].MemOffset;
+			uint32_t last = m_Size - 1;
+
+			if (offset != last) {
+				uint32_t lastNode = m_OffsetNodes[last];
 
-				Node& elNode = m_Nodes[idx];
-				Node& tailNode = m_Nodes[m_Tail];
+				m_Ptr[offset] = std::move(m_Ptr[last]);
+				m_Nodes[lastNode].MemOffset = offset;
+				m_OffsetNodes[offset] = lastNode;
+				MarkDirty(offset);
+			}
+
+			m_Nodes[idx].MemOffset = INVALID_IDX;
+			m_Nodes[idx].NextFree = m_FreeHead;
+			m_FreeHead = idx;
+			m_Size--;
 
-				m_Ptr[elNode.MemOffset] = std::move(m_Ptr[tailNode.MemOffset]);
-				m_Tail = tailNode.Prev;
+			// every index is free again, they can start over
+			if (m_Size == 0) {
+				m_FreeHead = INVALID_IDX;
+				m_NextNode = 0;
+			}
 
-				tailNode.Prev = elNode.Prev;
-				tailNode.MemOffset = elNode.MemOffset;
-				elNode.NextFree = m_FreeHead;
-				m_FreeHead = idx;
-				m_Size--;
+			// shrinks to half when a quarter is used, so a size going back and forth doesn't reallocate every time
+			if (m_Capacity > m_PageSize && m_Size * 4 <= m_Capacity) {
+				Reallocate(RoundToPages(std::max(m_Capacity / 2, m_Size)));
 			}
 		}
 
+		// drops every record, indices handed out before are invalid afterwards
+		void Clear() {
+			m_FreeHead = INVALID_IDX;
+			m_NextNode = 0;
+			m_Size = 0;
+
+			if (m_Capacity > m_PageSize) Reallocate(m_PageSize);
+		}
+
 		template<typename U>
 		void ForEach(U&& iterator) {
-			uint32_t nodeIdx = m_Tail;
-
-			for (uint32_t i = 0; i < m_Size; i++) {
-				// chech if node is not free (valid)
-				Node& n = m_Nodes[nodeIdx];
-				if (n.NextFree != INVALID_IDX) {
-					iterator(m_Ptr[n.MemOffset], nodeIdx);
-					nodeIdx = n.Prev;
-				}
+			for (uint32_t offset = 0; offset < m_Size; offset++) {
+				iterator(m_Ptr[offset], m_OffsetNodes[offset]);
 			}
 		}
 
+		// replaces the contents with a copy of another buffer, indices stay valid
+		// every record is marked dirty, so the copy is uploaded as a whole
+		void CopyFrom(const DenseBuffer& other) {
+			m_PageSize = other.m_PageSize;
+			Reallocate(other.m_Capacity);
+			ReserveNodes(other.m_NextNode);
+
+			std::copy(other.m_Nodes, other.m_Nodes + other.m_NextNode, m_Nodes);
+			std::copy(other.m_OffsetNodes, other.m_OffsetNodes + other.m_Size, m_OffsetNodes);
+			std::copy(other.m_Ptr, other.m_Ptr + other.m_Size, m_Ptr);
+
+			m_FreeHead = other.m_FreeHead;
+			m_NextNode = other.m_NextNode;
+			m_Size = other.m_Size;
+
+			for (uint32_t w = 0; w < m_Size / 64; w++) {
+				m_DirtyWords[w].store(~0ull, std::memory_order_relaxed);
+			}
+			if (m_Size % 64) m_DirtyWords[m_Size / 64].fetch_or((1ull << (m_Size % 64)) - 1, std::memory_order_relaxed);
+
+			m_HighWater = std::max(m_HighWater, m_Size);
+			m_AnyDirty.store(m_Size > 0, std::memory_order_relaxed);
+		}
+
 		uint32_t IndexToRawOffset(uint32_t idx) {
 			return m_Nodes[idx].MemOffset;
 		}
 
 		uint32_t Size() const { return m_Size; }
-		T& operator[](uint32_t idx) { return m_Ptr[m_Nodes[idx].MemOffset]; }
+
+		// records the storage holds before it reallocates, always whole pages
+		uint32_t GetCapacity() const { return m_Capacity; }
+		uint32_t GetPageSize() const { return m_PageSize; }
+
+		// mutable access counts as a write, the record is marked dirty
+		T& operator[](uint32_t idx) { 
+			uint32_t offset = m_Nodes[idx].MemOffset;
+
+			MarkDirty(offset);
+			return m_Ptr[offset]; 
+		}
+		const T& operator[](uint32_t idx) const { return m_Ptr[m_Nodes[idx].MemOffset]; }
+
+		const T* GetRawData() const { return m_Ptr; }
+
+		// safe to call from several threads at once
+		void MarkDirty(uint32_t offset) {
+			m_DirtyWords[offset / 64].fetch_or(1ull << (offset % 64), std::memory_order_relaxed);
+			m_AnyDirty.store(true, std::memory_order_relaxed);
+		}
+
+		bool HasDirty() const { return m_AnyDirty.load(std::memory_order_relaxed); }
+
+		// calls func(offset) for every dirty raw offset below the current size, in ascending order, and clears the marks
+		template<typename U>
+		void FlushDirty(U&& func) {
+			if (!HasDirty()) return;
+			m_AnyDirty.store(false, std::memory_order_relaxed);
+
+			// records popped past the end are dropped, the gpu never reads them
+			uint32_t numWords = (m_HighWater + 63) / 64;
+			for (uint32_t w = 0; w < numWords; w++) {
+
+				uint64_t bits = m_DirtyWords[w].exchange(0, std::memory_order_relaxed);
+				while (bits) {
+					uint32_t offset = w * 64 + (uint32_t)std::countr_zero(bits);
+					bits &= bits - 1;
+
+					if (offset < m_Size) func(offset);
+				}
+			}
+		}
+
+		inline static constexpr uint32_t DEFAULT_PAGE_SIZE = 1024;
 
 	private:
+		uint32_t RoundToPages(uint32_t count) const {
+			return std::max((count + m_PageSize - 1) / m_PageSize, 1u) * m_PageSize;
+		}
+
+		// moves the records and their dirty marks into storage of the new capacity, not thread safe
+		void Reallocate(uint32_t capacity) {
+			if (capacity == m_Capacity) return;
+
+			T* ptr = new T[capacity];
+			uint32_t* offsetNodes = new uint32_t[capacity];
+			std::atomic<uint64_t>* dirtyWords = new std::atomic<uint64_t>[capacity / 64]{};
+
+			uint32_t keep = std::min(m_Size, capacity);
+			if (m_Ptr) {
+				std::move(m_Ptr, m_Ptr + keep, ptr);
+				std::copy(m_OffsetNodes, m_OffsetNodes + keep, offsetNodes);
+
+				for (uint32_t w = 0; w < std::min(m_Capacity, capacity) / 64; w++) {
+					dirtyWords[w].store(m_DirtyWords[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+
+				delete[] m_Ptr;
+				delete[] m_OffsetNodes;
+				delete[] m_DirtyWords;
+			}
+
+			m_Ptr = ptr;
+			m_OffsetNodes = offsetNodes;
+			m_DirtyWords = dirtyWords;
+			m_Capacity = capacity;
+			m_HighWater = std::min(m_HighWater, capacity);
+		}
+
+		void ReserveNodes(uint32_t count) {
+			if (count <= m_NodeCapacity) return;
+
+			uint32_t capacity = std::max(m_NodeCapacity * 2, RoundToPages(count));
+			Node* nodes = new Node[capacity];
+
+			if (m_Nodes) {
+				std::copy(m_Nodes, m_Nodes + m_NextNode, nodes);
+				delete[] m_Nodes;
+			}
+
+			m_Nodes = nodes;
+			m_NodeCapacity = capacity;
+		}
+
 		uint32_t PushInternal(uint32_t& offset) {
+			if (m_Size == m_Capacity) {
+				Reallocate(RoundToPages(std::max(m_Capacity * 2, m_Size + 1)));
+			}
+
 			uint32_t nIndex = m_NextNode;
 
 			if (m_FreeHead != INVALID_IDX) {
@@ -132,38 +352,165 @@ namespace Spike {
 				m_FreeHead = m_Nodes[m_FreeHead].NextFree;
 			}
 			else {
+				ReserveNodes(m_NextNode + 1);
 				m_NextNode++;
 			}
 
 			Node& elNode = m_Nodes[nIndex];
-			elNode.Prev = m_Tail;
 			elNode.NextFree = INVALID_IDX;
 			elNode.MemOffset = m_Size;
 
-			m_Tail = nIndex;
+			m_OffsetNodes[m_Size] = nIndex;
 			m_Size++;
+			m_HighWater = std::max(m_HighWater, m_Size);
 			offset = elNode.MemOffset;
 			return nIndex;
 		}
 
 	private:
+		// free nodes have an invalid offset
 		struct Node {
-			uint32_t Prev;
 			uint32_t NextFree;
 			uint32_t MemOffset;
 		};
 
 		Node* m_Nodes;
+		// node of every raw offset, finds the record moved by Pop
+		uint32_t* m_OffsetNodes;
 		uint32_t m_FreeHead;
 		uint32_t m_NextNode;
-		uint32_t m_Tail;
+		uint32_t m_NodeCapacity;
 
 		uint32_t m_Size;
+		uint32_t m_Capacity;
+		uint32_t m_PageSize;
 		T* m_Ptr;
 
+		// one bit per raw offset
+		std::atomic<uint64_t>* m_DirtyWords;
+		uint32_t m_HighWater;
+		std::atomic<bool> m_AnyDirty;
+
 		inline static constexpr uint32_t INVALID_IDX = UINT32_MAX;
 	};
 
+	// open addressing hash map for 64 bit ids, linear probing over a power of two table
+	// 0 marks empty slots, so it can't be used as a key
+	template<typename T>
+	class FlatIDMap {
+	public:
+		FlatIDMap() : m_Size(0) {}
+
+		// returns false if the key is already in the map, the old value is kept
+		bool Insert(uint64_t key, const T& value) {
+			if (key == 0) return false;
+			if ((m_Size + 1) * 4 > m_Slots.size() * 3) Rehash(std::max<size_t>(m_Slots.size() * 2, 16));
+
+			size_t mask = m_Slots.size() - 1;
+			for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+				Slot& slot = m_Slots[i];
+
+				if (slot.Key == key) return false;
+				if (slot.Key == 0) {
+					slot.Key = key;
+					slot.Value = value;
+					m_Size++;
+					return true;
+				}
+			}
+		}
+
+		bool Remove(uint64_t key) {
+			if (m_Size == 0 || key == 0) return false;
+
+			size_t mask = m_Slots.size() - 1;
+			size_t i = Hash(key) & mask;
+
+			while (m_Slots[i].Key != key) {
+				if (m_Slots[i].Key == 0) return false;
+				i = (i + 1) & mask;
+			}
+
+			// shifts the rest of the cluster back instead of leaving tombstones
+			for (size_t next = (i + 1) & mask; m_Slots[next].Key != 0; next = (next + 1) & mask) {
+				size_t home = Hash(m_Slots[next].Key) & mask;
+
+				// entries whose home is cyclically in (i, next] are already reachable
+				if (((next - home) & mask) >= ((next - i) & mask)) {
+					m_Slots[i] = m_Slots[next];
+					i = next;
+				}
+			}
+
+			m_Slots[i].Key = 0;
+			m_Size--;
+			return true;
+		}
+
+		T* Find(uint64_t key) {
+			return const_cast<T*>(static_cast<const FlatIDMap*>(this)->Find(key));
+		}
+
+		const T* Find(uint64_t key) const {
+			if (m_Size == 0 || key == 0) return nullptr;
+
+			size_t mask = m_Slots.size() - 1;
+			for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+				const Slot& slot = m_Slots[i];
+
+				if (slot.Key == key) return &slot.Value;
+				if (slot.Key == 0) return nullptr;
+			}
+		}
+
+		void Reserve(size_t count) {
+			size_t needed = std::bit_ceil(count * 4 / 3 + 1);
+			if (needed > m_Slots.size()) Rehash(std::max<size_t>(needed, 16));
+		}
+
+		void Clear() {
+			m_Slots.clear();
+			m_Size = 0;
+		}
+
+		size_t Size() const { return m_Size; }
+
+	private:
+		struct Slot {
+			uint64_t Key = 0;
+			T Value{};
+		};
+
+		// ids can be sequential, so the bits are mixed before masking
+		static size_t Hash(uint64_t key) {
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			key *= 0xc4ceb9fe1a85ec53ull;
+			key ^= key >> 33;
+			return (size_t)key;
+		}
+
+		void Rehash(size_t capacity) {
+			std::vector<Slot> old = std::move(m_Slots);
+			m_Slots.assign(capacity, Slot{});
+
+			size_t mask = capacity - 1;
+			for (const Slot& slot : old) {
+				if (slot.Key == 0) continue;
+
+				size_t i = Hash(slot.Key) & mask;
+				while (m_Slots[i].Key != 0) i = (i + 1) & mask;
+
+				m_Slots[i] = slot;
+			}
+		}
+
+	private:
+		std::vector<Slot> m_Slots;
+		size_t m_Size;
+	};
+
 	// not thread safe implementation of ref counted pointer
 	class RefCounted {
 	public:
@@ -303,7 +650,7 @@ namespace Spike {
 			return m_Ptr == other;
 		}
 
-		bool Valid() { return m_Ptr != nullptr; }
+		bool Valid() const { return m_Ptr != nullptr; }
 
 	private:
 		mutable T* m_Ptr;
@@ -317,6 +664,69 @@ namespace Spike {
 		return Ref<T>(new T(std::forward<Args>(args)...));
 	}
 
+	// fixed size slots allocated in chunks and recycled through a free list, memory is only returned on destruction
+	// allocation and release can happen on different threads
+	template<typename T>
+	class ObjectPool {
+	public:
+		ObjectPool(uint32_t chunkSize = 256) : m_ChunkSize(chunkSize) {}
+		ObjectPool(const ObjectPool&) = delete;
+
+		// every object has to be released before the pool is destroyed
+		~ObjectPool() {
+			for (void* chunk : m_Chunks) {
+				::operator delete(chunk, std::align_val_t(alignof(T)));
+			}
+		}
+
+		template<typename... Args>
+		T* Allocate(Args&&... args) {
+			T* slot;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				if (m_Free.empty()) {
+					uint8_t* chunk = (uint8_t*)::operator new(sizeof(T) * m_ChunkSize, std::align_val_t(alignof(T)));
+					m_Chunks.push_back(chunk);
+
+					// pushed backwards, so slots are handed out in address order
+					for (uint32_t i = m_ChunkSize; i-- > 0;) {
+						m_Free.push_back((T*)(chunk + sizeof(T) * i));
+					}
+				}
+
+				slot = m_Free.back();
+				m_Free.pop_back();
+			}
+
+			return new (slot) T(std::forward<Args>(args)...);
+		}
+
+		void Release(T* object) {
+			object->~T();
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Free.push_back(object);
+		}
+
+		// takes the lock once for the whole batch
+		void Release(T* const* objects, size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				objects[i]->~T();
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Free.insert(m_Free.end(), objects, objects + count);
+		}
+
+	private:
+		uint32_t m_ChunkSize;
+
+		std::vector<void*> m_Chunks;
+		std::vector<T*> m_Free;
+		std::mutex m_Mutex;
+	};
+
 	template<typename T>
 	class ThreadSafeQueue {
 	public:
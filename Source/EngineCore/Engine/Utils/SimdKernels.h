@@ -0,0 +1,284 @@
+#pragma once
+
+#include <Engine/Utils/SimdMath.h>
+
+#include <immintrin.h>
+
+// kernels shared by the sse and avx translation units, only included by them
+// everything stays in an unnamed namespace, so avx encoded copies never get linked into the sse path
+
+namespace Spike {
+
+	namespace SimdMath::Avx {
+
+		// defined in SimdMathAvx.cpp, which is the only file built with avx enabled
+		void ComposeTRS(const TransformSoA& soa, const uint32_t* slots, uint32_t count, Mat4x4* out);
+		void MultiplyByParents(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents, uint32_t count);
+		void InverseAffine(const Mat4x4* in, Mat4x4* out, uint32_t count);
+		uint32_t FrustumCull(const Frustum& frustum, const AABB* boxes, uint32_t count, uint32_t* outVisible);
+	}
+
+	namespace {
+
+		// lane wrappers, kernels are written once and instantiated for sse and avx
+		// kernels assume the lane wrapper provides Width, Set1, Gather, StoreColumn and the operators below
+		// MultiplyByParentsBatch also needs LoadColumn, only the avx wrapper has it
+		struct Float4 {
+			__m128 V;
+
+			static constexpr uint32_t Width = 4;
+
+			static Float4 Set1(float value) { return { _mm_set1_ps(value) }; }
+			static Float4 Gather(const float* base, const uint32_t* idx, uint32_t stride) {
+				return { _mm_setr_ps(base[idx[0] * stride], base[idx[1] * stride], base[idx[2] * stride], base[idx[3] * stride]) };
+			}
+
+			// writes (x, y, z, w) of every lane as one matrix column
+			static void StoreColumn(Float4 x, Float4 y, Float4 z, Float4 w, Mat4x4* out, const uint32_t* idx, uint32_t column) {
+				_MM_TRANSPOSE4_PS(x.V, y.V, z.V, w.V);
+
+				_mm_storeu_ps(&out[idx[0]][column][0], x.V);
+				_mm_storeu_ps(&out[idx[1]][column][0], y.V);
+				_mm_storeu_ps(&out[idx[2]][column][0], z.V);
+				_mm_storeu_ps(&out[idx[3]][column][0], w.V);
+			}
+		};
+
+		inline Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.V, b.V) }; }
+		inline Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.V, b.V) }; }
+		inline Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.V, b.V) }; }
+		inline Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.V, b.V) }; }
+		inline Float4 operator&(Float4 a, Float4 b) { return { _mm_and_ps(a.V, b.V) }; }
+
+		// comparisons return all bits set in passing lanes
+		inline Float4 GreaterEqual(Float4 a, Float4 b) { return { _mm_cmpge_ps(a.V, b.V) }; }
+		inline Float4 Abs(Float4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.f), a.V) }; }
+		inline uint32_t MoveMask(Float4 a) { return (uint32_t)_mm_movemask_ps(a.V); }
+
+		// utility
+		template<typename T, typename F>
+		void ForEachBatch(const uint32_t* indices, uint32_t count, F&& func) {
+
+			uint32_t i = 0;
+			for (; i + T::Width <= count; i += T::Width) {
+				func(indices + i);
+			}
+
+			// pad the tail with the last index, it is just computed and written several times
+			if (i < count) {
+				uint32_t tail[T::Width];
+				for (uint32_t l = 0; l < T::Width; l++) {
+					tail[l] = indices[i + l < count ? i + l : count - 1];
+				}
+
+				func(tail);
+			}
+		}
+
+		template<typename T>
+		void ComposeTRSBatch(const TransformSoA& soa, const uint32_t* idx, Mat4x4* out) {
+
+			T qx = T::Gather(soa.RotationX, idx, 1);
+			T qy = T::Gather(soa.RotationY, idx, 1);
+			T qz = T::Gather(soa.RotationZ, idx, 1);
+			T qw = T::Gather(soa.RotationW, idx, 1);
+
+			T sx = T::Gather(soa.ScaleX, idx, 1);
+			T sy = T::Gather(soa.ScaleY, idx, 1);
+			T sz = T::Gather(soa.ScaleZ, idx, 1);
+
+			T one = T::Set1(1.f);
+			T two = T::Set1(2.f);
+			T zero = T::Set1(0.f);
+
+			T qxx = qx * qx, qyy = qy * qy, qzz = qz * qz;
+			T qxy = qx * qy, qxz = qx * qz, qyz = qy * qz;
+			T qwx = qw * qx, qwy = qw * qy, qwz = qw * qz;
+
+			// same as glm::mat3_cast, with columns scaled
+			T::StoreColumn((one - two * (qyy + qzz)) * sx, two * (qxy + qwz) * sx, two * (qxz - qwy) * sx, zero, out, idx, 0);
+			T::StoreColumn(two * (qxy - qwz) * sy, (one - two * (qxx + qzz)) * sy, two * (qyz + qwx) * sy, zero, out, idx, 1);
+			T::StoreColumn(two * (qxz + qwy) * sz, two * (qyz - qwx) * sz, (one - two * (qxx + qyy)) * sz, zero, out, idx, 2);
+
+			T::StoreColumn(T::Gather(soa.PositionX, idx, 1), T::Gather(soa.PositionY, idx, 1), T::Gather(soa.PositionZ, idx, 1), one, out, idx, 3);
+		}
+
+		template<typename T>
+		void InverseAffineBatch(const Mat4x4* in, const uint32_t* idx, Mat4x4* out) {
+			const float* base = &in[0][0][0];
+
+			auto load = [&](uint32_t column, uint32_t row) {
+				return T::Gather(base + column * 4 + row, idx, 16);
+			};
+
+			T a0x = load(0, 0), a0y = load(0, 1), a0z = load(0, 2);
+			T a1x = load(1, 0), a1y = load(1, 1), a1z = load(1, 2);
+			T a2x = load(2, 0), a2y = load(2, 1), a2z = load(2, 2);
+			T tx = load(3, 0), ty = load(3, 1), tz = load(3, 2);
+
+			// rows of the inverse are cross products of the columns, divided by the determinant
+			T r0x = a1y * a2z - a1z * a2y, r0y = a1z * a2x - a1x * a2z, r0z = a1x * a2y - a1y * a2x;
+			T r1x = a2y * a0z - a2z * a0y, r1y = a2z * a0x - a2x * a0z, r1z = a2x * a0y - a2y * a0x;
+			T r2x = a0y * a1z - a0z * a1y, r2y = a0z * a1x - a0x * a1z, r2z = a0x * a1y - a0y * a1x;
+
+			T invDet = T::Set1(1.f) / (a0x * r0x + a0y * r0y + a0z * r0z);
+
+			r0x = r0x * invDet; r0y = r0y * invDet; r0z = r0z * invDet;
+			r1x = r1x * invDet; r1y = r1y * invDet; r1z = r1z * invDet;
+			r2x = r2x * invDet; r2y = r2y * invDet; r2z = r2z * invDet;
+
+			T zero = T::Set1(0.f);
+
+			T::StoreColumn(r0x, r1x, r2x, zero, out, idx, 0);
+			T::StoreColumn(r0y, r1y, r2y, zero, out, idx, 1);
+			T::StoreColumn(r0z, r1z, r2z, zero, out, idx, 2);
+			T::StoreColumn(zero - (r0x * tx + r0y * ty + r0z * tz), zero - (r1x * tx + r1y * ty + r1z * tz),
+				zero - (r2x * tx + r2y * ty + r2z * tz), T::Set1(1.f), out, idx, 3);
+		}
+
+		// parents and children are affine, so the bottom row is never multiplied
+		// parents must not be in the same batch as their children
+		template<typename T>
+		void MultiplyByParentsBatch(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents) {
+			T p[4][3], unused;
+
+			for (uint32_t column = 0; column < 4; column++) {
+				T::LoadColumn(worlds, parents, column, p[column][0], p[column][1], p[column][2], unused);
+			}
+
+			// one local column at a time keeps the parent rows in registers
+			for (uint32_t column = 0; column < 4; column++) {
+				T lx, ly, lz, lw;
+				T::LoadColumn(locals, slots, column, lx, ly, lz, lw);
+
+				T x = p[0][0] * lx + p[1][0] * ly + p[2][0] * lz;
+				T y = p[0][1] * lx + p[1][1] * ly + p[2][1] * lz;
+				T z = p[0][2] * lx + p[1][2] * ly + p[2][2] * lz;
+
+				if (column == 3) {
+					x = x + p[3][0];
+					y = y + p[3][1];
+					z = z + p[3][2];
+				}
+
+				T::StoreColumn(x, y, z, T::Set1(column == 3 ? 1.f : 0.f), worlds, slots, column);
+			}
+		}
+
+		// bit per lane, set for boxes not fully outside any plane
+		template<typename T>
+		uint32_t FrustumCullBatch(const Frustum& frustum, const AABB* boxes, const uint32_t* idx) {
+			const float* base = &boxes[0].Min.x;
+			const uint32_t stride = sizeof(AABB) / sizeof(float);
+
+			T half = T::Set1(0.5f);
+
+			T minX = T::Gather(base + 0, idx, stride), minY = T::Gather(base + 1, idx, stride), minZ = T::Gather(base + 2, idx, stride);
+			T maxX = T::Gather(base + 3, idx, stride), maxY = T::Gather(base + 4, idx, stride), maxZ = T::Gather(base + 5, idx, stride);
+
+			T cx = (minX + maxX) * half, cy = (minY + maxY) * half, cz = (minZ + maxZ) * half;
+			T ex = (maxX - minX) * half, ey = (maxY - minY) * half, ez = (maxZ - minZ) * half;
+
+			T visible = GreaterEqual(T::Set1(0.f), T::Set1(0.f));
+			for (const Vec4& plane : frustum.Planes) {
+				T nx = T::Set1(plane.x), ny = T::Set1(plane.y), nz = T::Set1(plane.z);
+
+				// signed distance of the center plus the box radius projected on the normal
+				T distance = nx * cx + ny * cy + nz * cz + T::Set1(plane.w);
+				T radius = Abs(nx) * ex + Abs(ny) * ey + Abs(nz) * ez;
+
+				visible = visible & GreaterEqual(distance + radius, T::Set1(0.f));
+			}
+
+			return MoveMask(visible);
+		}
+
+		template<typename T>
+		void ComposeTRSImpl(const TransformSoA& soa, const uint32_t* slots, uint32_t count, Mat4x4* out) {
+
+			ForEachBatch<T>(slots, count, [&](const uint32_t* idx) {
+				ComposeTRSBatch<T>(soa, idx, out);
+				});
+		}
+
+		template<typename T>
+		void MultiplyByParentsImpl(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents, uint32_t count) {
+			uint32_t childSlots[256];
+			uint32_t childParents[256];
+
+			// roots are copied right away, children are packed so every lane has a parent to gather from
+			for (uint32_t first = 0; first < count; first += 256) {
+				uint32_t chunk = first + 256 < count ? 256 : count - first;
+				uint32_t numChildren = 0;
+
+				for (uint32_t i = first; i < first + chunk; i++) {
+					if (parents[i] == UINT32_MAX) {
+						worlds[slots[i]] = locals[slots[i]];
+						continue;
+					}
+
+					childSlots[numChildren] = slots[i];
+					childParents[numChildren] = parents[i];
+					numChildren++;
+				}
+
+				// the tail pads both lists with the last pair, so lanes stay matched
+				uint32_t i = 0;
+				for (; i + T::Width <= numChildren; i += T::Width) {
+					MultiplyByParentsBatch<T>(worlds, locals, childSlots + i, childParents + i);
+				}
+
+				if (i < numChildren) {
+					uint32_t tailSlots[T::Width], tailParents[T::Width];
+					for (uint32_t l = 0; l < T::Width; l++) {
+						uint32_t index = i + l < numChildren ? i + l : numChildren - 1;
+						tailSlots[l] = childSlots[index];
+						tailParents[l] = childParents[index];
+					}
+
+					MultiplyByParentsBatch<T>(worlds, locals, tailSlots, tailParents);
+				}
+			}
+		}
+
+		template<typename T>
+		void InverseAffineImpl(const Mat4x4* in, Mat4x4* out, uint32_t count) {
+			uint32_t indices[256];
+
+			// contiguous input, feed it in chunks of sequential indices
+			for (uint32_t first = 0; first < count; first += 256) {
+				uint32_t chunk = first + 256 < count ? 256 : count - first;
+
+				for (uint32_t i = 0; i < chunk; i++) {
+					indices[i] = first + i;
+				}
+
+				ForEachBatch<T>(indices, chunk, [&](const uint32_t* idx) {
+					InverseAffineBatch<T>(in, idx, out);
+					});
+			}
+		}
+
+		template<typename T>
+		uint32_t FrustumCullImpl(const Frustum& frustum, const AABB* boxes, uint32_t count, uint32_t* outVisible) {
+			uint32_t numVisible = 0;
+
+			for (uint32_t first = 0; first < count; first += T::Width) {
+				uint32_t lanes = first + T::Width < count ? T::Width : count - first;
+
+				// the tail repeats the last box, its lanes are ignored
+				uint32_t idx[T::Width];
+				for (uint32_t l = 0; l < T::Width; l++) {
+					idx[l] = first + (l < lanes ? l : lanes - 1);
+				}
+
+				uint32_t mask = FrustumCullBatch<T>(frustum, boxes, idx);
+				for (uint32_t l = 0; l < lanes; l++) {
+					if (mask & (1u << l)) outVisible[numVisible++] = first + l;
+				}
+			}
+
+			return numVisible;
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#include <Engine/Utils/SimdKernels.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Spike {
+
+	// avx needs both the cpu and the os saving the upper register halves
+	static bool HasAvx() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#else
+		return __builtin_cpu_supports("avx");
+#endif
+	}
+
+	static const bool s_UseAvx = HasAvx();
+
+	uint32_t SimdMath::GetBatchWidth() {
+		return s_UseAvx ? 8 : Float4::Width;
+	}
+
+	void SimdMath::ComposeTRS(const TransformSoA& soa, const uint32_t* slots, uint32_t count, Mat4x4* out) {
+		if (s_UseAvx) return Avx::ComposeTRS(soa, slots, count, out);
+
+		ComposeTRSImpl<Float4>(soa, slots, count, out);
+	}
+
+	void SimdMath::InverseAffine(const Mat4x4* in, Mat4x4* out, uint32_t count) {
+		if (s_UseAvx) return Avx::InverseAffine(in, out, count);
+
+		InverseAffineImpl<Float4>(in, out, count);
+	}
+
+	uint32_t SimdMath::FrustumCull(const Frustum& frustum, const AABB* boxes, uint32_t count, uint32_t* outVisible) {
+		if (s_UseAvx) return Avx::FrustumCull(frustum, boxes, count, outVisible);
+
+		return FrustumCullImpl<Float4>(frustum, boxes, count, outVisible);
+	}
+
+	Mat4x4 SimdMath::Multiply(const Mat4x4& a, const Mat4x4& b) {
+
+		__m128 a0 = _mm_loadu_ps(&a[0][0]);
+		__m128 a1 = _mm_loadu_ps(&a[1][0]);
+		__m128 a2 = _mm_loadu_ps(&a[2][0]);
+		__m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+		Mat4x4 result;
+		for (int c = 0; c < 4; c++) {
+
+			__m128 col = _mm_mul_ps(a0, _mm_set1_ps(b[c][0]));
+			col = _mm_add_ps(col, _mm_mul_ps(a1, _mm_set1_ps(b[c][1])));
+			col = _mm_add_ps(col, _mm_mul_ps(a2, _mm_set1_ps(b[c][2])));
+			col = _mm_add_ps(col, _mm_mul_ps(a3, _mm_set1_ps(b[c][3])));
+
+			_mm_storeu_ps(&result[c][0], col);
+		}
+
+		return result;
+	}
+
+	void SimdMath::MultiplyByParents(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents, uint32_t count) {
+		if (s_UseAvx) return Avx::MultiplyByParents(worlds, locals, slots, parents, count);
+
+		// 4 wide, transposing the matrices in and out costs more than the batch saves, one matrix per register stays faster
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t slot = slots[i];
+
+			worlds[slot] = (parents[i] != UINT32_MAX) ? Multiply(worlds[parents[i]], locals[slot]) : locals[slot];
+		}
+	}
+}
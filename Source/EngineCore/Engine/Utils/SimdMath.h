@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Engine/Utils/MathUtils.h>
+#include <Engine/Utils/Geometry.h>
+
+namespace Spike {
+
+	// transform components laid out in separate arrays, so several entities fit in one simd register
+	struct TransformSoA {
+
+		float* PositionX;
+		float* PositionY;
+		float* PositionZ;
+
+		// quaternion
+		float* RotationX;
+		float* RotationY;
+		float* RotationZ;
+		float* RotationW;
+
+		float* ScaleX;
+		float* ScaleY;
+		float* ScaleZ;
+	};
+
+	namespace SimdMath {
+
+		// number of transforms processed at once, 8 with avx and 4 with sse
+		uint32_t GetBatchWidth();
+
+		// out[slots[i]] = translate * rotate * scale of slots[i]
+		void ComposeTRS(const TransformSoA& soa, const uint32_t* slots, uint32_t count, Mat4x4* out);
+
+		// worlds[slots[i]] = worlds[parents[i]] * locals[slots[i]], UINT32_MAX parent means no parent
+		// matrices are expected to be affine, parents must be written before the call
+		void MultiplyByParents(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents, uint32_t count);
+
+		// expects the last row to be (0, 0, 0, 1)
+		void InverseAffine(const Mat4x4* in, Mat4x4* out, uint32_t count);
+
+		Mat4x4 Multiply(const Mat4x4& a, const Mat4x4& b);
+
+		// writes indices of boxes touching the frustum into outVisible, returns their count
+		uint32_t FrustumCull(const Frustum& frustum, const AABB* boxes, uint32_t count, uint32_t* outVisible);
+	}
+}
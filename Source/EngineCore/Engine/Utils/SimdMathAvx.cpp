@@ -0,0 +1,82 @@
+#include <Engine/Utils/SimdKernels.h>
+
+// built with avx enabled, only called after SimdMath.cpp checked the cpu supports it
+
+namespace Spike {
+
+	namespace {
+
+		struct Float8 {
+			__m256 V;
+
+			static constexpr uint32_t Width = 8;
+
+			static Float8 Set1(float value) { return { _mm256_set1_ps(value) }; }
+			static Float8 Gather(const float* base, const uint32_t* idx, uint32_t stride) {
+				return { _mm256_setr_ps(base[idx[0] * stride], base[idx[1] * stride], base[idx[2] * stride], base[idx[3] * stride],
+					base[idx[4] * stride], base[idx[5] * stride], base[idx[6] * stride], base[idx[7] * stride]) };
+			}
+
+			// same 4x4 transpose as sse, done on both halves at once, lane l holds idx[l] and lane l + 4 holds idx[l + 4]
+			static void LoadColumn(const Mat4x4* in, const uint32_t* idx, uint32_t column, Float8& x, Float8& y, Float8& z, Float8& w) {
+				__m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&in[idx[0]][column][0])), _mm_loadu_ps(&in[idx[4]][column][0]), 1);
+				__m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&in[idx[1]][column][0])), _mm_loadu_ps(&in[idx[5]][column][0]), 1);
+				__m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&in[idx[2]][column][0])), _mm_loadu_ps(&in[idx[6]][column][0]), 1);
+				__m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&in[idx[3]][column][0])), _mm_loadu_ps(&in[idx[7]][column][0]), 1);
+
+				__m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpacklo_ps(r2, r3);
+				__m256 t2 = _mm256_unpackhi_ps(r0, r1), t3 = _mm256_unpackhi_ps(r2, r3);
+
+				x.V = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				y.V = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				z.V = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				w.V = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			static void StoreColumn(Float8 x, Float8 y, Float8 z, Float8 w, Mat4x4* out, const uint32_t* idx, uint32_t column) {
+				__m256 t0 = _mm256_unpacklo_ps(x.V, y.V), t1 = _mm256_unpacklo_ps(z.V, w.V);
+				__m256 t2 = _mm256_unpackhi_ps(x.V, y.V), t3 = _mm256_unpackhi_ps(z.V, w.V);
+
+				__m256 c0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 c1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 c2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 c3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+				_mm_storeu_ps(&out[idx[0]][column][0], _mm256_castps256_ps128(c0));
+				_mm_storeu_ps(&out[idx[1]][column][0], _mm256_castps256_ps128(c1));
+				_mm_storeu_ps(&out[idx[2]][column][0], _mm256_castps256_ps128(c2));
+				_mm_storeu_ps(&out[idx[3]][column][0], _mm256_castps256_ps128(c3));
+				_mm_storeu_ps(&out[idx[4]][column][0], _mm256_extractf128_ps(c0, 1));
+				_mm_storeu_ps(&out[idx[5]][column][0], _mm256_extractf128_ps(c1, 1));
+				_mm_storeu_ps(&out[idx[6]][column][0], _mm256_extractf128_ps(c2, 1));
+				_mm_storeu_ps(&out[idx[7]][column][0], _mm256_extractf128_ps(c3, 1));
+			}
+		};
+
+		inline Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.V, b.V) }; }
+		inline Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.V, b.V) }; }
+		inline Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.V, b.V) }; }
+		inline Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.V, b.V) }; }
+		inline Float8 operator&(Float8 a, Float8 b) { return { _mm256_and_ps(a.V, b.V) }; }
+
+		inline Float8 GreaterEqual(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.V, b.V, _CMP_GE_OQ) }; }
+		inline Float8 Abs(Float8 a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.V) }; }
+		inline uint32_t MoveMask(Float8 a) { return (uint32_t)_mm256_movemask_ps(a.V); }
+	}
+
+	void SimdMath::Avx::ComposeTRS(const TransformSoA& soa, const uint32_t* slots, uint32_t count, Mat4x4* out) {
+		ComposeTRSImpl<Float8>(soa, slots, count, out);
+	}
+
+	void SimdMath::Avx::MultiplyByParents(Mat4x4* worlds, const Mat4x4* locals, const uint32_t* slots, const uint32_t* parents, uint32_t count) {
+		MultiplyByParentsImpl<Float8>(worlds, locals, slots, parents, count);
+	}
+
+	void SimdMath::Avx::InverseAffine(const Mat4x4* in, Mat4x4* out, uint32_t count) {
+		InverseAffineImpl<Float8>(in, out, count);
+	}
+
+	uint32_t SimdMath::Avx::FrustumCull(const Frustum& frustum, const AABB* boxes, uint32_t count, uint32_t* outVisible) {
+		return FrustumCullImpl<Float8>(frustum, boxes, count, outVisible);
+	}
+}
@@ -1,14 +1,21 @@
 #include <Engine/World/Components.h>
 #include <Engine/Core/Application.h>
 #include <Engine/Renderer/FrameRenderer.h>
+#include <Engine/Utils/MathUtils.h>
 
-#define INVALID_BATCH_IDX UINT32_MAX
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
+#define INVALID_GROUP_IDX UINT32_MAX
 
 namespace Spike {
 
 	void HierarchyComponent::SetParent(Entity parent, bool inLocalSpace) {
 		assert(m_Self != parent && "Trying to parent entity to self, which is forbidden!");
 
+		// world transform from the last update, kept when reparenting outside of local space
+		Mat4x4 world = m_Self.GetComponent<TransformComponent>().GetWorldTranform();
+
 		if (m_Parent) {
 			auto& parentComp = m_Parent.GetComponent<HierarchyComponent>();
 
@@ -26,24 +33,61 @@ namespace Spike {
 			}
 		}
 
+		else if (parent) {
+			m_Owner->UnSetEntityRoot(m_Self);
+		}
+
 		m_Parent = parent;
 		if (parent) {
 			auto& parentComp = parent.GetComponent<HierarchyComponent>();
 			parentComp.m_Children.push_back(m_Self);
+		}
 
-			auto& parentTransform = parent.GetComponent<TransformComponent>();
+		// moves the whole subtree to its new depth
+		m_Owner->UpdateHierarchyLevel(m_Self);
 
-			if (!inLocalSpace)
-			    m_Self.GetComponent<TransformComponent>().UpdateParentTransform(parentTransform.GetWorldTranform());
-		}
-		else {
-			m_Self.GetComponent<TransformComponent>().UpdateParentTransform(Mat4x4(1.f));
+		auto& transform = m_Self.GetComponent<TransformComponent>();
+
+		if (!inLocalSpace) {
+			Mat4x4 parentWorld = parent ? parent.GetComponent<TransformComponent>().GetWorldTranform() : Mat4x4(1.f);
+			Mat4x4 local = glm::inverse(parentWorld) * world;
+
+			Vec3 position, scale, skew;
+			Quaternion rotation;
+			Vec4 perspective;
+			if (glm::decompose(local, scale, rotation, position, skew, perspective)) {
+
+				// rotation is stored as yaw * pitch * roll euler angles
+				Vec3 euler;
+				glm::extractEulerAngleYXZ(glm::toMat4(rotation), euler.y, euler.x, euler.z);
+
+				transform.SetPosition(position);
+				transform.SetRotation(euler);
+				transform.SetScale(scale);
+			}
+			else {
+				ENGINE_WARN("Failed to keep world transform of entity: {}, parent transform is degenerate", m_Name);
+			}
 		}
+
+		// world matrix is rebuilt against the new parent on the next transform update
+		transform.MarkDirty();
 	}
 
-	HierarchyComponent::~HierarchyComponent() {
-		for (auto& c : m_Children) {
-			c.Destroy();
+	HierarchyComponent::HierarchyComponent(Entity self, const HierarchyComponent& source, World* owner) :
+		BaseEntityComponent(self),
+		m_Name(source.m_Name),
+		m_ID(source.m_ID),
+		m_LayerMask(source.m_LayerMask),
+		m_Depth(source.m_Depth),
+		m_LevelIndex(source.m_LevelIndex),
+		m_Owner(owner)
+	{
+		if (source.m_Parent) m_Parent = Entity(owner, source.m_Parent.GetHandle());
+
+		m_Children.reserve(source.m_Children.size());
+		for (const Entity& child : source.m_Children) {
+			m_Children.emplace_back(owner, child.GetHandle());
 		}
 	}
 
@@ -69,239 +113,330 @@ namespace Spike {
 			SetParent(parent, true);
 		}
 
+		uint32_t layerMask;
 		stream >> m_Name;
-		stream >> m_LayerMask;
+		stream >> layerMask;
+
+		SetLayerMask(layerMask);
+	}
+
+	void HierarchyComponent::SetLayerMask(uint32_t mask) {
+		if (m_LayerMask == mask) return;
+		m_LayerMask = mask;
+
+		// instances of the mesh carry the mask for the cull pass
+		if (m_Self.HasComponent<StaticMeshComponent>()) {
+			GFrameRenderer->SubmitToFrameQueue([mask, proxy = m_Self.GetComponent<StaticMeshComponent>().GetProxy()]() {
+				proxy->SetLayerMask(mask);
+				});
+		}
 	}
 
 	TransformComponent::TransformComponent(Entity self) : 
 		BaseEntityComponent(self),
-		m_Position(0.f, 0.f, 0.f),
+		m_Slot(self.GetWorld()->GetTransformStore().Allocate()),
 	    m_Rotation(0.f, 0.f, 0.f),
-	    m_Scale(1.f, 1.f, 1.f) 
+		m_Dirty(false)
 	{
-		UpdateTransformMatrix();
+		MarkDirty();
 	}
 
-	void TransformComponent::SetPosition(const Vec3& value) {
-		m_Position = value;
-		UpdateTransformMatrix();
+	TransformComponent::TransformComponent(Entity self, const TransformComponent& source) :
+		BaseEntityComponent(self),
+		m_Slot(source.m_Slot),
+		m_Rotation(source.m_Rotation),
+		m_Dirty(source.m_Dirty)
+	{}
+
+	TransformComponent::~TransformComponent() {
+		if (m_Slot != TransformStore::INVALID_SLOT) {
+			GetStore().Release(m_Slot);
+		}
 	}
 
-	void TransformComponent::SetRotation(const Vec3& value) {
-		m_Rotation = value;
-		UpdateTransformMatrix();
+	TransformComponent::TransformComponent(TransformComponent&& other) noexcept :
+		BaseEntityComponent(other.m_Self),
+		m_Slot(other.m_Slot),
+		m_Rotation(other.m_Rotation),
+		m_Dirty(other.m_Dirty)
+	{
+		other.m_Slot = TransformStore::INVALID_SLOT;
 	}
 
-	void TransformComponent::SetScale(const Vec3& value) {
-		m_Scale = value;
-		UpdateTransformMatrix();
+	TransformComponent& TransformComponent::operator=(TransformComponent&& other) noexcept {
+		m_Self = other.m_Self;
+		m_Rotation = other.m_Rotation;
+		m_Dirty = other.m_Dirty;
+
+		// the old slot is released together with the moved-from component
+		std::swap(m_Slot, other.m_Slot);
+		return *this;
 	}
 
-	void TransformComponent::UpdateTransformMatrix(const Mat4x4* parentMat) {
+	TransformStore& TransformComponent::GetStore() const {
+		return m_Self.GetWorld()->GetTransformStore();
+	}
 
-		Mat4x4 T = glm::translate(Mat4x4(1.0f), m_Position);
+	Vec3 TransformComponent::GetPosition() const {
+		return GetStore().GetPosition(m_Slot);
+	}
+
+	Vec3 TransformComponent::GetScale() const {
+		return GetStore().GetScale(m_Slot);
+	}
+
+	const Mat4x4& TransformComponent::GetWorldTranform() const {
+		return GetStore().GetWorld(m_Slot);
+	}
+
+	void TransformComponent::SetPosition(const Vec3& value) {
+		GetStore().SetPosition(m_Slot, value);
+		MarkDirty();
+	}
+
+	void TransformComponent::SetRotation(const Vec3& value) {
+		m_Rotation = value;
 
 		Quaternion pitchRotation = glm::angleAxis(m_Rotation.x, Vec3{ 1.f, 0.f, 0.f });
 		Quaternion yawRotation = glm::angleAxis(m_Rotation.y, Vec3{ 0.f, 1.f, 0.f });
 		Quaternion rollRotation = glm::angleAxis(m_Rotation.z, Vec3{ 0.f, 0.f, 1.f });
 
-		Mat4x4 R = glm::toMat4(yawRotation * pitchRotation * rollRotation);
-		Mat4x4 S = glm::scale(glm::mat4(1.0f), m_Scale);
-
-		m_WorldTransform = T * R * S;
-		if (parentMat) {
-			m_WorldTransform *= *parentMat;
-		}
-
-		// call callbacks on change
-		{
-			if (m_Self.HasComponent<StaticMeshComponent>()) {
-				auto& comp = m_Self.GetComponent<StaticMeshComponent>();
-				comp.OnEntityMove(m_Position, m_Rotation, m_Scale, m_WorldTransform);
-			}
+		GetStore().SetRotation(m_Slot, yawRotation * pitchRotation * rollRotation);
+		MarkDirty();
+	}
 
-			if (m_Self.HasComponent<LightComponent>()) {
-				auto& comp = m_Self.GetComponent<LightComponent>();
-				comp.OnEntityMove(m_Position, m_Rotation, m_Scale, m_WorldTransform);
-			}
-		}
+	void TransformComponent::SetScale(const Vec3& value) {
+		GetStore().SetScale(m_Slot, value);
+		MarkDirty();
 	}
 
-	void TransformComponent::UpdateParentTransform(const Mat4x4& mat) {
-		UpdateTransformMatrix(&mat);
+	void TransformComponent::MarkDirty() {
+		if (m_Dirty) return;
+
+		m_Dirty = true;
+		m_Self.GetWorld()->MarkTransformDirty(m_Self);
 	}
 
 	void TransformComponent::Serialize(BinaryWriteStream& stream) {
-		stream << m_Position;
+		stream << GetPosition();
 		stream << m_Rotation;
-		stream << m_Scale;
-		stream << m_WorldTransform;
+		stream << GetScale();
+		stream << GetWorldTranform();
 	}
 
 	void TransformComponent::Deserialize(BinaryReadStream& stream) {
-		stream >> m_Position;
-		stream >> m_Rotation;
-		stream >> m_Scale;
-		stream >> m_WorldTransform;
+		Vec3 position, rotation, scale;
+
+		stream >> position;
+		stream >> rotation;
+		stream >> scale;
+		stream >> GetStore().GetWorld(m_Slot);
+
+		SetPosition(position);
+		SetRotation(rotation);
+		SetScale(scale);
+	}
+
+
+	// entities without layers are drawn in the default one
+	static uint32_t GetInstanceLayers(uint32_t layerMask) {
+		return layerMask != 0 ? layerMask : DEFAULT_LAYER_MASK;
+	}
+
+	StaticMeshProxy::StaticMeshProxy(RHIWorldProxy* wProxy, const Mat4x4& transform, uint32_t layerMask) 
+		: m_WorldProxy(wProxy), m_Mesh(nullptr), m_LastTransform(transform), m_LayerMask(GetInstanceLayers(layerMask)) {}
+
+	// instances of meshlet groups keep a visibility bit per meshlet between frames
+	static uint32_t GetMeshletVisibilityWords(const RHIWorldProxy* wProxy, uint32_t group) {
+		return group != INVALID_GROUP_IDX ? (wProxy->GroupsVB[group].MeshletCount + 31) / 32 : 0;
 	}
 
+	static void ReleaseMeshletVisibility(RHIWorldProxy* wProxy, uint32_t dataIndex, uint32_t group) {
+		uint32_t words = GetMeshletVisibilityWords(wProxy, group);
+		if (words == 0) return;
 
-	StaticMeshProxy::StaticMeshProxy(RHIWorldProxy* wProxy, const Mat4x4& transform) : m_WorldProxy(wProxy), m_LastTransform(transform) {}
+		const DenseBuffer<ObjectGPUData>& objects = wProxy->ObjectsVB;
+		wProxy->MeshletVisibilityQueue.Release(objects[dataIndex].MeshletVisibilityOffset, words);
+	}
 
 	StaticMeshProxy::~StaticMeshProxy() {
 		for (int i = 0; i < m_DataIndices.size(); i++) {
+			ReleaseMeshletVisibility(m_WorldProxy, m_DataIndices[i], m_Groups[i]);
+			m_WorldProxy->VisibilityQueue.Release(m_WorldProxy->ObjectsVB[m_DataIndices[i]].VisibilityIdx);
 			m_WorldProxy->ObjectsVB.Pop(m_DataIndices[i]);
-			
-			if (m_Materials.size() > 0) {
-				if (m_Materials[i].second != INVALID_BATCH_IDX) {
-					RemoveFromBatch(m_Materials[i].second);
-				}
+
+			if (m_Groups[i] != INVALID_GROUP_IDX) {
+				m_WorldProxy->ReleaseInstanceGroup(m_Groups[i]);
 			}
 		}
 	}
 
+	void StaticMeshProxy::CopyRecords(const StaticMeshProxy& source) {
+		m_DataIndices = source.m_DataIndices;
+		m_Groups = source.m_Groups;
+		m_Materials = source.m_Materials;
+		m_Mesh = source.m_Mesh;
+		m_LastTransform = source.m_LastTransform;
+		m_LayerMask = source.m_LayerMask;
+	}
+
+	static void WriteTransformRows(ObjectGPUData& obj, const Mat4x4& transform) {
+		for (int i = 0; i < 3; i++) {
+			obj.TransformRows[i] = Vec4(transform[0][i], transform[1][i], transform[2][i], transform[3][i]);
+		}
+	}
+
 	void StaticMeshProxy::OnTransformChange(const Mat4x4& newTransform) {
 		m_LastTransform = newTransform;
 
 		for (auto idx : m_DataIndices) {
-
-			ObjectGPUData& obj = m_WorldProxy->ObjectsVB[idx];
-			obj.GlobalTransform = m_LastTransform;
-			obj.InverseTransform = glm::inverse(m_LastTransform);
+			WriteTransformRows(m_WorldProxy->ObjectsVB[idx], m_LastTransform);
 		}
 	}
 
-	void StaticMeshProxy::PushMaterial(RHIMaterial* mat) {
-		m_Materials.push_back({});
-		SetMaterial(mat, m_Materials.size() - 1, true);
-	}
-
-	void StaticMeshProxy::RemoveFromBatch(uint32_t idx) {
-		WorldDrawBatch& b = m_WorldProxy->Batches[idx];
+	void StaticMeshProxy::SetLayerMask(uint32_t layerMask) {
+		m_LayerMask = GetInstanceLayers(layerMask);
 
-		if (b.CommandsCount > 1) {
-			b.CommandsCount--;
-		}
-		else {
-			b.Shader = nullptr;
-			b.CommandsCount = 0;
+		for (auto idx : m_DataIndices) {
+			m_WorldProxy->ObjectsVB[idx].LayerMask = m_LayerMask;
 		}
 	}
 
-	uint32_t StaticMeshProxy::FindBatch(RHIShader* shader) {
-		uint32_t idx = INVALID_BATCH_IDX;
+	void StaticMeshProxy::UpdateGroup(uint32_t index) {
+		uint32_t group = INVALID_GROUP_IDX;
+
+		if (m_Mesh && index < m_Materials.size()) {
+			group = m_WorldProxy->AcquireInstanceGroup(m_Mesh, index, m_Materials[index]);
+		}
 
-		for (int i = 0; i < m_WorldProxy->Batches.size(); i++) {
-			auto& b = m_WorldProxy->Batches[i];
+		ObjectGPUData& obj = m_WorldProxy->ObjectsVB[m_DataIndices[index]];
 
-			if (b.Shader == shader || !b.Shader) {
-				idx = i;
-				b.CommandsCount++;
+		// the visibility run is kept while the meshlet count stays, stale bits only change what the next prepass draws
+		uint32_t oldWords = GetMeshletVisibilityWords(m_WorldProxy, m_Groups[index]);
+		uint32_t newWords = GetMeshletVisibilityWords(m_WorldProxy, group);
 
-				if (!b.Shader) b.Shader = shader;
+		if (oldWords != newWords) {
+			if (oldWords > 0) {
+				m_WorldProxy->MeshletVisibilityQueue.Release(obj.MeshletVisibilityOffset, oldWords);
 			}
+			obj.MeshletVisibilityOffset = newWords > 0 ? m_WorldProxy->MeshletVisibilityQueue.Grab(newWords) : INVALID_MESHLET_VISIBILITY;
 		}
 
-		if (idx == INVALID_BATCH_IDX) {
-			idx = (uint32_t)m_WorldProxy->Batches.size();
-			m_WorldProxy->Batches.push_back(WorldDrawBatch{ .CommandsCount = 1, .Shader = shader });
+		// released after acquiring, so a group the instance stays in isn't freed on the way
+		if (m_Groups[index] != INVALID_GROUP_IDX) {
+			m_WorldProxy->ReleaseInstanceGroup(m_Groups[index]);
 		}
 
-		return idx;
+		m_Groups[index] = group;
+		obj.GroupIndex = group;
 	}
 
-	void StaticMeshProxy::PopMaterial() {
-		RemoveFromBatch(m_Materials.back().second);
+	void StaticMeshProxy::PushMaterial(RHIMaterial* mat) {
+		m_Materials.push_back(mat);
 
-		if (m_DataIndices.size() >= m_Materials.size()) {
-			m_WorldProxy->ObjectsVB[m_DataIndices[m_Materials.size() - 1]].MaterialBufferIndex = INVALID_SHADER_INDEX;
-		}
-		m_Materials.pop_back();
+		uint32_t index = (uint32_t)m_Materials.size() - 1;
+		if (index < m_DataIndices.size()) UpdateGroup(index);
 	}
 
-	void StaticMeshProxy::SetMaterial(RHIMaterial* mat, uint32_t index, bool isNew) {
-		auto& matHolder = m_Materials[index];
-		matHolder.first = mat;
-
-		// check if material actually influences any of submeshes
-		if (m_DataIndices.size() > index) {
-			bool needNewBatch = isNew;
+	void StaticMeshProxy::PopMaterial() {
+		m_Materials.pop_back();
 
-			if (!needNewBatch) {
-				if (matHolder.first->GetShader() != mat->GetShader()) {
-					RemoveFromBatch(matHolder.second);
-					needNewBatch = true;
-				}
-			}
+		uint32_t index = (uint32_t)m_Materials.size();
+		if (index < m_DataIndices.size()) UpdateGroup(index);
+	}
 
-			ObjectGPUData& obj = m_WorldProxy->ObjectsVB[m_DataIndices[index]];
-			obj.MaterialBufferIndex = mat->GetDataIndex();
+	void StaticMeshProxy::SetMaterial(RHIMaterial* mat, uint32_t index) {
+		if (m_Materials[index] == mat) return;
+		m_Materials[index] = mat;
 
-			if (needNewBatch) {
-				matHolder.second = obj.DrawBatchID = FindBatch(mat->GetShader());
-			}
-		}
-		else {
-			matHolder.second = INVALID_BATCH_IDX;
-		}
+		// check if material actually influences any of submeshes
+		if (index < m_DataIndices.size()) UpdateGroup(index);
 	}
 
 	void StaticMeshProxy::SetMesh(RHIMesh* mesh) {
+		uint32_t numSubMeshes = (uint32_t)mesh->GetDesc().SubMeshes.size();
+
 		// remove all not needed prev sub-mesh proxies
-		for (int i = mesh->GetDesc().SubMeshes.size(); i < m_DataIndices.size(); i++) {
+		for (uint32_t i = numSubMeshes; i < m_DataIndices.size(); i++) {
+			ReleaseMeshletVisibility(m_WorldProxy, m_DataIndices[i], m_Groups[i]);
 			m_WorldProxy->VisibilityQueue.Release(m_WorldProxy->ObjectsVB[m_DataIndices[i]].VisibilityIdx);
 			m_WorldProxy->ObjectsVB.Pop(m_DataIndices[i]);
 
-			if (m_Materials.size() > i) {
-				RemoveFromBatch(m_Materials[i].second);
+			if (m_Groups[i] != INVALID_GROUP_IDX) {
+				m_WorldProxy->ReleaseInstanceGroup(m_Groups[i]);
 			}
-		} 
+		}
 
-		// add missing sub-mesh proxies
-		for (int i = m_DataIndices.size(); i < mesh->GetDesc().SubMeshes.size(); i++) {
-			m_DataIndices.push_back(m_WorldProxy->ObjectsVB.Push(ObjectGPUData{.VisibilityIdx = m_WorldProxy->VisibilityQueue.Grab()}));
+		if (m_DataIndices.size() > numSubMeshes) {
+			m_DataIndices.resize(numSubMeshes);
+			m_Groups.resize(numSubMeshes);
+		}
 
-			if (m_Materials.size() > i) {
-				if (m_Materials[i].second == INVALID_BATCH_IDX) {
-					m_Materials[i].second = FindBatch(m_Materials[i].first->GetShader());
-				}
-				else {
-					m_WorldProxy->Batches[m_Materials[i].second].CommandsCount++;
-				}
-			}
+		// add missing sub-mesh proxies
+		for (uint32_t i = (uint32_t)m_DataIndices.size(); i < numSubMeshes; i++) {
+			ObjectGPUData obj{};
+			obj.GroupIndex = INVALID_GROUP_IDX;
+			obj.VisibilityIdx = m_WorldProxy->VisibilityQueue.Grab();
+			obj.LayerMask = m_LayerMask;
+			obj.MeshletVisibilityOffset = INVALID_MESHLET_VISIBILITY;
+			WriteTransformRows(obj, m_LastTransform);
+
+			m_DataIndices.push_back(m_WorldProxy->ObjectsVB.Push(obj));
+			m_Groups.push_back(INVALID_GROUP_IDX);
 		}
-		 
-		for (int i = 0; i < mesh->GetDesc().SubMeshes.size(); i++) {
-			const SubMesh& sMesh = mesh->GetDesc().SubMeshes[i];
-
-			ObjectGPUData& obj = m_WorldProxy->ObjectsVB[m_DataIndices[i]];
-			obj.BoundsOrigin = Vec4(mesh->GetBoundsOrigin(), mesh->GetBoundsRadius());
-			obj.GlobalTransform = m_LastTransform;
-			obj.InverseTransform = glm::inverse(m_LastTransform);
-			obj.FirstIndex = sMesh.FirstIndex;
-			obj.IndexCount = sMesh.IndexCount;
-			obj.IndexBufferAddress = mesh->GetIndexBuffer()->GetGPUAddress();
-			obj.VertexBufferAddress = mesh->GetVertexBuffer()->GetGPUAddress();
-			obj.MaterialBufferIndex = (m_Materials.size() > i) ? m_Materials[i].first->GetDataIndex() : INVALID_SHADER_INDEX;
-			obj.DrawBatchID = (m_Materials.size() > i) ? m_Materials[i].second : INVALID_SHADER_INDEX;
+
+		m_Mesh = mesh;
+		for (uint32_t i = 0; i < numSubMeshes; i++) {
+			UpdateGroup(i);
 		}
 	}
 
+	static uint32_t GetEntityLayers(Entity entity) {
+		return entity.HasComponent<HierarchyComponent>() ? entity.GetComponent<HierarchyComponent>().GetLayerMask() : 0;
+	}
+
 	StaticMeshComponent::StaticMeshComponent(Entity entity) : BaseEntityComponent(entity), m_Mesh(nullptr) {
-		m_Proxy = new StaticMeshProxy(entity.GetWorld()->GetProxy(), 
-		    entity.GetComponent<TransformComponent>().GetWorldTranform());
+		RHIWorldProxy* worldProxy = entity.GetWorld()->GetProxy();
+		m_Proxy = worldProxy->MeshProxyPool.Allocate(worldProxy, entity.GetComponent<TransformComponent>().GetWorldTranform(), GetEntityLayers(entity));
 	}
 
 	StaticMeshComponent::~StaticMeshComponent() {
-		GFrameRenderer->SubmitToFrameQueue([proxy = m_Proxy]() {
-			delete proxy;
-			});
+
+		// the world takes the proxy when the whole entity is destroyed and releases it in a batch
+		if (m_Proxy) {
+			GFrameRenderer->SubmitToFrameQueue([worldProxy = m_Self.GetWorld()->GetProxy(), proxy = m_Proxy]() {
+				worldProxy->MeshProxyPool.Release(proxy);
+				});
+			m_Self.GetWorld()->MarkBoundsDirty(m_Self);
+		}
 	}
 
-	void StaticMeshComponent::OnEntityMove(const Vec3& pos, const Vec3& rot, const Vec3& scale, const Mat4x4& world) {
-		GFrameRenderer->SubmitToFrameQueue([=, proxy = m_Proxy]() {
-			proxy->OnTransformChange(world);
-			});
+	StaticMeshComponent::StaticMeshComponent(Entity entity, const StaticMeshComponent& source) :
+		BaseEntityComponent(entity),
+		m_Mesh(source.m_Mesh),
+		m_Materials(source.m_Materials)
+	{
+		RHIWorldProxy* worldProxy = entity.GetWorld()->GetProxy();
+		m_Proxy = worldProxy->MeshProxyPool.Allocate(worldProxy, entity.GetComponent<TransformComponent>().GetWorldTranform(), GetEntityLayers(entity));
+	}
+
+	StaticMeshComponent::StaticMeshComponent(StaticMeshComponent&& other) noexcept :
+		BaseEntityComponent(other.m_Self),
+		m_Mesh(std::move(other.m_Mesh)),
+		m_Materials(std::move(other.m_Materials)),
+		m_Proxy(other.m_Proxy)
+	{
+		other.m_Proxy = nullptr;
+	}
+
+	StaticMeshComponent& StaticMeshComponent::operator=(StaticMeshComponent&& other) noexcept {
+		m_Self = other.m_Self;
+		m_Mesh = std::move(other.m_Mesh);
+		m_Materials = std::move(other.m_Materials);
+
+		// the old proxy is released together with the moved-from component
+		std::swap(m_Proxy, other.m_Proxy);
+		return *this;
 	}
 
 	void StaticMeshComponent::SetMesh(Ref<Mesh> mesh) {
@@ -311,6 +446,8 @@ namespace Spike {
 			proxy->SetMesh(rhiMesh);
 			});
 		m_Mesh = mesh;
+
+		m_Self.GetWorld()->MarkBoundsDirty(m_Self);
 	}
 
 	void StaticMeshComponent::SetMaterial(Ref<Material> mat, uint32_t index) {
@@ -443,27 +580,74 @@ namespace Spike {
 		m_OuterConeCos(0.f),
 		m_Type(ELightType::ENone)
 	{
-		m_Proxy = new LightProxy(entity.GetWorld()->GetProxy());
+		m_Proxy = entity.GetWorld()->GetProxy()->LightProxyPool.Allocate(entity.GetWorld()->GetProxy());
 
-		Vec3 pos = m_Self.GetComponent<TransformComponent>().GetPosition();
-		Vec3 rot = m_Self.GetComponent<TransformComponent>().GetRotation();
+		const Mat4x4& world = m_Self.GetComponent<TransformComponent>().GetWorldTranform();
+		Vec3 pos = Vec3(world[3]);
+		Vec3 dir = LightComponent::GetWorldDirection(world);
 
-		GFrameRenderer->SubmitToFrameQueue([proxy = m_Proxy, pos, rot]() {
-			proxy->Init(pos, rot);
+		GFrameRenderer->SubmitToFrameQueue([proxy = m_Proxy, pos, dir]() {
+			proxy->Init(pos, dir);
 			});
 	}
 
+	Vec3 LightComponent::GetWorldDirection(const Mat4x4& world) {
+		return glm::normalize(Vec3(world * Vec4(MathUtils::ForwardVec3(), 0.f)));
+	}
+
 	LightComponent::~LightComponent() {
-		GFrameRenderer->SubmitToFrameQueue([proxy = m_Proxy]() {
-			delete proxy;
-			});
+		if (m_Proxy) {
+			GFrameRenderer->SubmitToFrameQueue([worldProxy = m_Self.GetWorld()->GetProxy(), proxy = m_Proxy]() {
+				worldProxy->LightProxyPool.Release(proxy);
+				});
+			m_Self.GetWorld()->MarkBoundsDirty(m_Self);
+		}
 	}
 
-	void LightComponent::OnEntityMove(const Vec3& pos, const Vec3& rot, const Vec3& scale, const Mat4x4& world) {
-		GFrameRenderer->SubmitToFrameQueue([pos, rot, proxy = m_Proxy]() {
-			proxy->SetPosition(pos);
-			proxy->SetDirection(rot);
-			});
+	LightComponent::LightComponent(Entity entity, const LightComponent& source) :
+		BaseEntityComponent(entity),
+		m_Proxy(entity.GetWorld()->GetProxy()->LightProxyPool.Allocate(entity.GetWorld()->GetProxy())),
+		m_Intensity(source.m_Intensity),
+		m_Range(source.m_Range),
+		m_Color(source.m_Color),
+		m_LightLinear(source.m_LightLinear),
+		m_LightQuadratic(source.m_LightQuadratic),
+		m_LightConstant(source.m_LightConstant),
+		m_InnerConeCos(source.m_InnerConeCos),
+		m_OuterConeCos(source.m_OuterConeCos),
+		m_Type(source.m_Type)
+	{}
+
+	LightComponent::LightComponent(LightComponent&& other) noexcept :
+		BaseEntityComponent(other.m_Self),
+		m_Proxy(other.m_Proxy),
+		m_Intensity(other.m_Intensity),
+		m_Range(other.m_Range),
+		m_Color(other.m_Color),
+		m_LightLinear(other.m_LightLinear),
+		m_LightQuadratic(other.m_LightQuadratic),
+		m_LightConstant(other.m_LightConstant),
+		m_InnerConeCos(other.m_InnerConeCos),
+		m_OuterConeCos(other.m_OuterConeCos),
+		m_Type(other.m_Type)
+	{
+		other.m_Proxy = nullptr;
+	}
+
+	LightComponent& LightComponent::operator=(LightComponent&& other) noexcept {
+		m_Self = other.m_Self;
+		m_Intensity = other.m_Intensity;
+		m_Range = other.m_Range;
+		m_Color = other.m_Color;
+		m_LightLinear = other.m_LightLinear;
+		m_LightQuadratic = other.m_LightQuadratic;
+		m_LightConstant = other.m_LightConstant;
+		m_InnerConeCos = other.m_InnerConeCos;
+		m_OuterConeCos = other.m_OuterConeCos;
+		m_Type = other.m_Type;
+
+		std::swap(m_Proxy, other.m_Proxy);
+		return *this;
 	}
 
 	void LightComponent::SetIntensity(float value) {
@@ -480,6 +664,7 @@ namespace Spike {
 		GFrameRenderer->SubmitToFrameQueue([value, proxy = m_Proxy]() {
 			proxy->SetRange(value);
 			});
+		m_Self.GetWorld()->MarkBoundsDirty(m_Self);
 	}
 
 	void LightComponent::SetColor(const Vec4& value) {
@@ -520,6 +705,7 @@ namespace Spike {
 		GFrameRenderer->SubmitToFrameQueue([type, proxy = m_Proxy]() {
 			proxy->SetType((uint8_t)type);
 			});
+		m_Self.GetWorld()->MarkBoundsDirty(m_Self);
 	}
 
 	void LightComponent::SetInnerConeCos(float value) {
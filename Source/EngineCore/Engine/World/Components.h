@@ -11,7 +11,6 @@ namespace Spike {
 		BaseEntityComponent(Entity entity) : m_Self(entity) {}
 		virtual ~BaseEntityComponent() = default;
 
-		virtual void OnEntityMove(const Vec3& pos, const Vec3& rot, const Vec3& scale, const Mat4x4& world) {}
 		virtual void Serialize(BinaryWriteStream& stream) = 0;
 		virtual void Deserialize(BinaryReadStream& stream) = 0;
 
@@ -22,15 +21,21 @@ namespace Spike {
 	class HierarchyComponent : public BaseEntityComponent {
 	public:
 		HierarchyComponent(Entity self, UUID id, World* owner)
-			: BaseEntityComponent(self), m_Owner(owner), m_LayerMask(0), m_ID(id) {}
-		virtual ~HierarchyComponent() override;
+			: BaseEntityComponent(self), m_Owner(owner), m_LayerMask(0), m_ID(id), m_Depth(0), m_LevelIndex(UINT32_MAX) {}
+
+		// copy for a cloned world with the same entity handles, relations are moved to the owner world
+		HierarchyComponent(Entity self, const HierarchyComponent& source, World* owner);
+		// children are destroyed by the world together with their parent
+		virtual ~HierarchyComponent() override = default;
 
 		void SetName(const std::string& value) { m_Name = value; }
 		const std::string& GetName() const { return m_Name; }
 
+		// the mesh of the entity is drawn in the views whose mask shares a layer with it
 		uint32_t GetLayerMask() const { return m_LayerMask; }
-		void AddLayer(uint32_t layer) { m_LayerMask |= layer; }
-		void RemoveLayer(uint32_t layer) { m_LayerMask &= ~layer; }
+		void AddLayer(uint32_t layer) { SetLayerMask(m_LayerMask | layer); }
+		void RemoveLayer(uint32_t layer) { SetLayerMask(m_LayerMask & ~layer); }
+		void SetLayerMask(uint32_t mask);
 
 		UUID GetID() const { return m_ID; }
 		Entity GetParent() const { return m_Parent; }
@@ -39,6 +44,9 @@ namespace Spike {
 		const std::vector<Entity>& GetChildren() const { return m_Children; }
 		World* GetOwnerWorld() { return m_Owner; }
 
+		// 0 for root entities
+		uint32_t GetDepth() const { return m_Depth; }
+
 		virtual void Serialize(BinaryWriteStream& stream) override;
 		virtual void Deserialize(BinaryReadStream& stream) override;
 
@@ -50,57 +58,87 @@ namespace Spike {
 		Entity m_Parent;
 		std::vector<Entity> m_Children;  
 
+		// position in the world's hierarchy levels
+		uint32_t m_Depth;
+		uint32_t m_LevelIndex;
+
 		World* m_Owner;
+
+		friend class World;
+		friend class WorldLoader;
 	};
 
 	class TransformComponent : public BaseEntityComponent {
 	public:
 		TransformComponent(Entity self);
-		virtual ~TransformComponent() override {}
+		virtual ~TransformComponent() override;
+
+		// copy for a cloned world, the slot is the same, the store is copied by the world as a whole
+		TransformComponent(Entity self, const TransformComponent& source);
+
+		// the slot moves with the component, so the moved-from one doesn't release it
+		TransformComponent(TransformComponent&& other) noexcept;
+		TransformComponent& operator=(TransformComponent&& other) noexcept;
 
-		const Vec3& GetPosition() const { return m_Position; }
+		Vec3 GetPosition() const;
 		const Vec3& GetRotation() const { return m_Rotation; }
-		const Vec3& GetScale() const { return m_Scale; }
-		const Mat4x4& GetWorldTranform() const { return m_WorldTransform; }
+		Vec3 GetScale() const;
+		const Mat4x4& GetWorldTranform() const;
 
+		// changes only mark the transform dirty, world matrices are updated once per frame by the world
 		void SetPosition(const Vec3& value);
 		void SetRotation(const Vec3& value);
 		void SetScale(const Vec3& value);
 
-		void UpdateParentTransform(const Mat4x4& mat);
+		bool IsDirty() const { return m_Dirty; }
+		void MarkDirty();
+
+		// index of the transform in the world's transform store
+		uint32_t GetSlot() const { return m_Slot; }
 
 		virtual void Serialize(BinaryWriteStream& stream) override;
 		virtual void Deserialize(BinaryReadStream& stream) override;
 
 	private:
-		void UpdateTransformMatrix(const Mat4x4* parentMat = nullptr);
+		TransformStore& GetStore() const;
+
+	private:
+		uint32_t m_Slot;
 
-    private:
-		Vec3 m_Position;
+		// euler angles as edited, the store keeps the quaternion
 		Vec3 m_Rotation;
-		Vec3 m_Scale;
-		Mat4x4 m_WorldTransform;
+		bool m_Dirty;
+
+		friend class World;
 	};
 
 	class StaticMeshProxy {
 	public:
-		StaticMeshProxy(RHIWorldProxy* wProxy, const Mat4x4& transform);
+		StaticMeshProxy(RHIWorldProxy* wProxy, const Mat4x4& transform, uint32_t layerMask);
 		~StaticMeshProxy();
 
 		void OnTransformChange(const Mat4x4& newTransform);
-		void SetMaterial(RHIMaterial* mat, uint32_t index, bool isNew = false);
+		void SetLayerMask(uint32_t layerMask);
+		void SetMaterial(RHIMaterial* mat, uint32_t index);
 		void PushMaterial(RHIMaterial* mat);
 		void PopMaterial();
 		void SetMesh(RHIMesh* mesh);
 
+		// takes the records of a proxy in a cloned world, the world proxy records must be copied along
+		void CopyRecords(const StaticMeshProxy& source);
+
 	private:
-		void RemoveFromBatch(uint32_t idx);
-		uint32_t FindBatch(RHIShader* shader);
+		// moves the submesh instance into the group of its current mesh and material
+		void UpdateGroup(uint32_t index);
 
 	private:
+		// instance record and group per submesh, submeshes without a material have no group and aren't drawn
 		std::vector<uint32_t> m_DataIndices;
-		std::vector<std::pair<RHIMaterial*, uint32_t>> m_Materials;
+		std::vector<uint32_t> m_Groups;
+		std::vector<RHIMaterial*> m_Materials;
+		RHIMesh* m_Mesh;
 		Mat4x4 m_LastTransform;
+		uint32_t m_LayerMask;
 		RHIWorldProxy* m_WorldProxy;
 	};
 
@@ -109,12 +147,23 @@ namespace Spike {
 		StaticMeshComponent(Entity entity);
 		virtual ~StaticMeshComponent() override;
 
+		// copy for a cloned world, gets a new proxy, its records are copied by the world on the render thread
+		StaticMeshComponent(Entity entity, const StaticMeshComponent& source);
+
+		// the proxy moves with the component, so the moved-from one doesn't release it
+		StaticMeshComponent(StaticMeshComponent&& other) noexcept;
+		StaticMeshComponent& operator=(StaticMeshComponent&& other) noexcept;
+
 		void SetMesh(Ref<Mesh> mesh);
 		void SetMaterial(Ref<Material> mat, uint32_t index);
 		void PushMaterial(Ref<Material> mat);
 		void PopMaterial();
 
-		virtual void OnEntityMove(const Vec3& pos, const Vec3& rot, const Vec3& scale, const Mat4x4& world) override;
+		StaticMeshProxy* GetProxy() { return m_Proxy; }
+
+		const Ref<Mesh>& GetMesh() const { return m_Mesh; }
+		const std::vector<Ref<Material>>& GetMaterials() const { return m_Materials; }
+
 		virtual void Serialize(BinaryWriteStream& stream) override;
 		virtual void Deserialize(BinaryReadStream& stream) override;
 
@@ -123,6 +172,8 @@ namespace Spike {
 		Ref<Mesh> m_Mesh;
 		std::vector<Ref<Material>> m_Materials;
 		StaticMeshProxy* m_Proxy;
+
+		friend class World;
 	};
 
 	class LightProxy {
@@ -144,6 +195,8 @@ namespace Spike {
 		void SetInnerConeCos(float value);
 		void SetOuterConeCos(float value);
 
+		void CopyRecords(const LightProxy& source) { m_DataIndex = source.m_DataIndex; }
+
 	private:
 		uint32_t m_DataIndex;
 		RHIWorldProxy* m_WorldProxy;
@@ -161,6 +214,11 @@ namespace Spike {
 		LightComponent(Entity entity);
 		virtual ~LightComponent() override;
 
+		LightComponent(Entity entity, const LightComponent& source);
+
+		LightComponent(LightComponent&& other) noexcept;
+		LightComponent& operator=(LightComponent&& other) noexcept;
+
 		void SetIntensity(float value);
 		void SetRange(float value);
 		void SetColor(const Vec4& value);
@@ -181,7 +239,11 @@ namespace Spike {
 		const Vec4& GetColor() const { return m_Color; }
 		ELightType GetType() const { return m_Type; }
 
-		virtual void OnEntityMove(const Vec3& pos, const Vec3& rot, const Vec3& scale, const Mat4x4& world) override;
+		LightProxy* GetProxy() { return m_Proxy; }
+
+		// light forward axis in world space
+		static Vec3 GetWorldDirection(const Mat4x4& world);
+
 		virtual void Serialize(BinaryWriteStream& stream) override;
 		virtual void Deserialize(BinaryReadStream& stream) override;
 
@@ -198,6 +260,8 @@ namespace Spike {
 		float m_OuterConeCos;
 
 		ELightType m_Type;
+
+		friend class World;
 	};
 
 	class CameraComponent : public BaseEntityComponent {
@@ -0,0 +1,347 @@
+#include <Engine/World/DynamicBVH.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace Spike {
+
+	// utility
+	static constexpr uint32_t MAX_LEAF_SIZE = 4;
+	static constexpr uint32_t MAX_DEPTH = 48;
+	static constexpr uint32_t NUM_BINS = 16;
+
+	// how much looser than right after the build the tree can get from refits
+	static constexpr float MAX_COST_RATIO = 1.5f;
+
+	uint32_t DynamicBVH::Insert(const AABB& bounds, uint32_t userData) {
+		uint32_t proxy;
+
+		if (!m_FreeProxies.empty()) {
+			proxy = m_FreeProxies.back();
+			m_FreeProxies.pop_back();
+		}
+		else {
+			proxy = (uint32_t)m_Bounds.size();
+
+			m_Bounds.emplace_back();
+			m_UserData.push_back(INVALID_PROXY);
+			m_PrimitiveIndices.push_back(INVALID_PROXY);
+		}
+
+		m_Bounds[proxy] = bounds;
+		m_UserData[proxy] = userData;
+
+		m_Pending.push_back(proxy);
+		m_NumAlive++;
+
+		return proxy;
+	}
+
+	void DynamicBVH::SetBounds(uint32_t proxy, const AABB& bounds) {
+		m_Bounds[proxy] = bounds;
+
+		uint32_t prim = m_PrimitiveIndices[proxy];
+		if (prim != INVALID_PROXY) m_PrimitiveBounds[prim] = bounds;
+	}
+
+	void DynamicBVH::Remove(uint32_t proxy) {
+		if (!IsAlive(proxy)) return;
+
+		uint32_t prim = m_PrimitiveIndices[proxy];
+		if (prim != INVALID_PROXY) {
+			m_PrimitiveBounds[prim] = AABB();
+			m_PrimitiveUserData[prim] = INVALID_PROXY;
+			m_PrimitiveIndices[proxy] = INVALID_PROXY;
+		}
+
+		m_Bounds[proxy] = AABB();
+		m_UserData[proxy] = INVALID_PROXY;
+		m_Released.push_back(proxy);
+
+		m_NumAlive--;
+		m_NumDead++;
+		m_NeedsRefit = true;
+	}
+
+	void DynamicBVH::Refit() {
+		bool rebuild = m_Pending.size() > 64 + m_NumAlive / 32 || m_NumDead > 64 + m_NumAlive / 4;
+
+		if (!rebuild && m_NeedsRefit && !m_Nodes.empty()) {
+
+			// children are always after their parent, so one backwards pass updates the whole tree
+			float cost = 0.f;
+
+			for (uint32_t i = (uint32_t)m_Nodes.size(); i-- > 0;) {
+				Node& node = m_Nodes[i];
+
+				if (node.IsLeaf()) {
+					AABB bounds{};
+					for (uint32_t p = node.LeftOrFirst; p < node.LeftOrFirst + node.Count; p++) {
+						bounds.Extend(m_PrimitiveBounds[p]);
+					}
+
+					node.Min = bounds.Min;
+					node.Max = bounds.Max;
+					cost += bounds.GetSurfaceArea() * (float)node.Count;
+				}
+				else {
+					const Node& left = m_Nodes[node.LeftOrFirst];
+					const Node& right = m_Nodes[node.LeftOrFirst + 1];
+
+					node.Min = glm::min(left.Min, right.Min);
+					node.Max = glm::max(left.Max, right.Max);
+					cost += node.GetBounds().GetSurfaceArea();
+				}
+			}
+
+			float rootArea = m_Nodes[0].GetBounds().GetSurfaceArea();
+			rebuild = rootArea > 0.f && cost / rootArea > m_BuildCost * MAX_COST_RATIO;
+		}
+
+		m_NeedsRefit = false;
+		if (rebuild) Rebuild();
+	}
+
+	void DynamicBVH::Rebuild() {
+		m_Nodes.clear();
+		m_PrimitiveBounds.clear();
+		m_PrimitiveUserData.clear();
+		m_Pending.clear();
+
+		m_FreeProxies.insert(m_FreeProxies.end(), m_Released.begin(), m_Released.end());
+		m_Released.clear();
+		m_NumDead = 0;
+		m_NeedsRefit = false;
+
+		// proxies in leaf order, copied into the primitive arrays once the tree is built
+		std::vector<uint32_t> primitives{};
+
+		for (uint32_t proxy = 0; proxy < (uint32_t)m_Bounds.size(); proxy++) {
+			m_PrimitiveIndices[proxy] = INVALID_PROXY;
+			if (IsAlive(proxy)) primitives.push_back(proxy);
+		}
+
+		uint32_t count = (uint32_t)primitives.size();
+		if (count == 0) {
+			m_BuildCost = 0.f;
+			return;
+		}
+
+		std::vector<Vec3> centers(m_Bounds.size());
+		for (uint32_t proxy : primitives) {
+			centers[proxy] = m_Bounds[proxy].GetCenter();
+		}
+
+		m_Nodes.reserve(count * 2);
+		m_Nodes.push_back(Node{ Vec3(0.f), 0, Vec3(0.f), count });
+
+		struct BuildEntry {
+			uint32_t Node;
+			uint32_t Depth;
+		};
+
+		std::vector<BuildEntry> stack{ { 0, 0 } };
+
+		while (!stack.empty()) {
+			BuildEntry entry = stack.back();
+			stack.pop_back();
+
+			uint32_t first = m_Nodes[entry.Node].LeftOrFirst;
+			uint32_t num = m_Nodes[entry.Node].Count;
+
+			AABB bounds{}, centerBounds{};
+			for (uint32_t i = first; i < first + num; i++) {
+				bounds.Extend(m_Bounds[primitives[i]]);
+				centerBounds.Extend(centers[primitives[i]]);
+			}
+
+			m_Nodes[entry.Node].Min = bounds.Min;
+			m_Nodes[entry.Node].Max = bounds.Max;
+
+			if (num <= MAX_LEAF_SIZE || entry.Depth >= MAX_DEPTH) continue;
+
+			Vec3 extent = centerBounds.Max - centerBounds.Min;
+			int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+			// every center is at the same spot, nothing to split by
+			if (extent[axis] <= 0.f) continue;
+
+			float binScale = (float)NUM_BINS / extent[axis];
+			auto getBin = [&](uint32_t proxy) {
+				return std::min((uint32_t)((centers[proxy][axis] - centerBounds.Min[axis]) * binScale), NUM_BINS - 1);
+				};
+
+			uint32_t binCounts[NUM_BINS]{};
+			AABB binBounds[NUM_BINS]{};
+
+			for (uint32_t i = first; i < first + num; i++) {
+				uint32_t bin = getBin(primitives[i]);
+
+				binCounts[bin]++;
+				binBounds[bin].Extend(m_Bounds[primitives[i]]);
+			}
+
+			// sweep from the right, then evaluate every split plane from the left
+			float rightCosts[NUM_BINS]{};
+			{
+				AABB right{};
+				uint32_t rightCount = 0;
+
+				for (uint32_t b = NUM_BINS - 1; b > 0; b--) {
+					right.Extend(binBounds[b]);
+					rightCount += binCounts[b];
+
+					rightCosts[b] = right.GetSurfaceArea() * rightCount;
+				}
+			}
+
+			float bestCost = FLT_MAX;
+			uint32_t bestSplit = 0;
+			{
+				AABB left{};
+				uint32_t leftCount = 0;
+
+				for (uint32_t b = 0; b < NUM_BINS - 1; b++) {
+					left.Extend(binBounds[b]);
+					leftCount += binCounts[b];
+
+					float cost = left.GetSurfaceArea() * leftCount + rightCosts[b + 1];
+					if (leftCount > 0 && leftCount < num && cost < bestCost) {
+						bestCost = cost;
+						bestSplit = b + 1;
+					}
+				}
+			}
+
+			uint32_t* begin = primitives.data() + first;
+			uint32_t* mid = nullptr;
+
+			if (bestCost < FLT_MAX) {
+				mid = std::partition(begin, begin + num, [&](uint32_t proxy) { return getBin(proxy) < bestSplit; });
+			}
+			else {
+				// everything fell into one bin, split in the middle instead
+				mid = begin + num / 2;
+				std::nth_element(begin, mid, begin + num, [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+			}
+
+			uint32_t leftCount = (uint32_t)(mid - begin);
+			uint32_t left = (uint32_t)m_Nodes.size();
+
+			m_Nodes.push_back(Node{ Vec3(0.f), first, Vec3(0.f), leftCount });
+			m_Nodes.push_back(Node{ Vec3(0.f), first + leftCount, Vec3(0.f), num - leftCount });
+
+			m_Nodes[entry.Node].LeftOrFirst = left;
+			m_Nodes[entry.Node].Count = 0;
+
+			stack.push_back({ left, entry.Depth + 1 });
+			stack.push_back({ left + 1, entry.Depth + 1 });
+		}
+
+		m_PrimitiveBounds.resize(count);
+		m_PrimitiveUserData.resize(count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t proxy = primitives[i];
+
+			m_PrimitiveBounds[i] = m_Bounds[proxy];
+			m_PrimitiveUserData[i] = m_UserData[proxy];
+			m_PrimitiveIndices[proxy] = i;
+		}
+
+		m_BuildCost = ComputeCost();
+	}
+
+	float DynamicBVH::ComputeCost() const {
+		if (m_Nodes.empty()) return 0.f;
+
+		float rootArea = m_Nodes[0].GetBounds().GetSurfaceArea();
+		if (rootArea <= 0.f) return 0.f;
+
+		float cost = 0.f;
+		for (const Node& node : m_Nodes) {
+			cost += node.GetBounds().GetSurfaceArea() * (node.IsLeaf() ? (float)node.Count : 1.f);
+		}
+
+		return cost / rootArea;
+	}
+
+	bool DynamicBVH::Raycast(const Ray& ray, float maxDistance, uint32_t& outUserData, float& outDistance) const {
+		outUserData = INVALID_PROXY;
+		outDistance = maxDistance;
+
+		Raycast(ray, maxDistance, [&](uint32_t userData, float distance) {
+			if (distance < outDistance) {
+				outDistance = distance;
+				outUserData = userData;
+			}
+			return outDistance;
+			});
+
+		return outUserData != INVALID_PROXY;
+	}
+
+	void DynamicBVH::QueryNearest(const Vec3& point, uint32_t k, std::vector<uint32_t>& outUserData) const {
+		outUserData.clear();
+		if (k == 0) return;
+
+		using Candidate = std::pair<float, uint32_t>;
+
+		// max heap of the best k by user data, the worst one on top
+		std::vector<Candidate> best{};
+		best.reserve(k + 1);
+
+		auto consider = [&](const AABB& bounds, uint32_t userData) {
+			if (userData == INVALID_PROXY) return;
+
+			float distance = bounds.DistanceSquared(point);
+			if (best.size() == k) {
+				if (distance >= best.front().first) return;
+
+				std::pop_heap(best.begin(), best.end());
+				best.pop_back();
+			}
+
+			best.emplace_back(distance, userData);
+			std::push_heap(best.begin(), best.end());
+			};
+
+		for (uint32_t proxy : m_Pending) {
+			consider(m_Bounds[proxy], m_UserData[proxy]);
+		}
+
+		if (!m_Nodes.empty()) {
+
+			// closest nodes first, stops once no node can beat the current k-th proxy
+			std::vector<Candidate> queue{ { m_Nodes[0].GetBounds().DistanceSquared(point), 0 } };
+
+			while (!queue.empty()) {
+				std::pop_heap(queue.begin(), queue.end(), std::greater<Candidate>());
+				auto [distance, nodeIdx] = queue.back();
+				queue.pop_back();
+
+				if (best.size() == k && distance >= best.front().first) break;
+				const Node& node = m_Nodes[nodeIdx];
+
+				if (node.IsLeaf()) {
+					for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++) {
+						consider(m_PrimitiveBounds[i], m_PrimitiveUserData[i]);
+					}
+					continue;
+				}
+
+				for (uint32_t child = node.LeftOrFirst; child < node.LeftOrFirst + 2; child++) {
+					queue.emplace_back(m_Nodes[child].GetBounds().DistanceSquared(point), child);
+					std::push_heap(queue.begin(), queue.end(), std::greater<Candidate>());
+				}
+			}
+		}
+
+		std::sort_heap(best.begin(), best.end());
+
+		outUserData.reserve(best.size());
+		for (const Candidate& candidate : best) {
+			outUserData.push_back(candidate.second);
+		}
+	}
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <Engine/Utils/Geometry.h>
+#include <vector>
+
+namespace Spike {
+
+	// bounding volume hierarchy over proxies with user data, built top down with a binned sah
+	// moving proxies only refit the tree, it is rebuilt once refits made it too loose or enough proxies were added or removed
+	// proxies added since the last build are kept in a flat list and tested one by one
+	class DynamicBVH {
+	public:
+		DynamicBVH() : m_NumAlive(0), m_NumDead(0), m_BuildCost(0.f), m_NeedsRefit(false) {}
+
+		uint32_t Insert(const AABB& bounds, uint32_t userData);
+		void Remove(uint32_t proxy);
+
+		// doesn't change the tree, safe to call from several threads for different proxies, MarkMoved must follow
+		void SetBounds(uint32_t proxy, const AABB& bounds);
+		void Update(uint32_t proxy, const AABB& bounds) { SetBounds(proxy, bounds); m_NeedsRefit = true; }
+		void MarkMoved() { m_NeedsRefit = true; }
+
+		// refits node bounds after Update, rebuilds the tree if it got too loose
+		void Refit();
+		void Rebuild();
+
+		const AABB& GetBounds(uint32_t proxy) const { return m_Bounds[proxy]; }
+		uint32_t GetUserData(uint32_t proxy) const { return m_UserData[proxy]; }
+		uint32_t GetNumProxies() const { return m_NumAlive; }
+
+		// func(userData) for every proxy touching the frustum
+		template<typename Func>
+		void QueryFrustum(const Frustum& frustum, Func&& func) const;
+
+		// coarse version for batched tests, func(bounds, userData, count) for every leaf touching the frustum,
+		// entries can be outside the frustum and have INVALID_PROXY user data for removed proxies
+		template<typename Func>
+		void QueryFrustumLeaves(const Frustum& frustum, Func&& func) const;
+
+		template<typename Func>
+		void QueryBox(const AABB& box, Func&& func) const;
+
+		template<typename Func>
+		void QuerySphere(const Vec3& center, float radius, Func&& func) const;
+
+		// func(userData, boxDistance) for proxies hit by the ray, closest nodes first,
+		// returns the new max distance, so exact tests can shorten the ray
+		template<typename Func>
+		void Raycast(const Ray& ray, float maxDistance, Func&& func) const;
+
+		// closest proxy bounds hit by the ray, returns false on a miss
+		bool Raycast(const Ray& ray, float maxDistance, uint32_t& outUserData, float& outDistance) const;
+
+		// up to k proxies closest to the point, sorted by distance to their bounds
+		void QueryNearest(const Vec3& point, uint32_t k, std::vector<uint32_t>& outUserData) const;
+
+		static constexpr uint32_t INVALID_PROXY = UINT32_MAX;
+
+	private:
+		// children of an internal node are stored next to each other, always after their parent
+		struct Node {
+
+			Vec3 Min;
+			uint32_t LeftOrFirst; // first child or first primitive
+			Vec3 Max;
+			uint32_t Count; // 0 for internal nodes
+
+			bool IsLeaf() const { return Count > 0; }
+			AABB GetBounds() const { return AABB(Min, Max); }
+		};
+
+		bool IsAlive(uint32_t proxy) const { return m_UserData[proxy] != INVALID_PROXY; }
+
+		// every leaf primitive is tested against its node, so they are read in leaf order from copies
+		// user data of removed primitives is INVALID_PROXY
+		bool IsPrimitiveAlive(uint32_t prim) const { return m_PrimitiveUserData[prim] != INVALID_PROXY; }
+
+		// sum of node areas relative to the root, how expensive an average query is
+		float ComputeCost() const;
+
+		template<typename Test, typename Func>
+		void Traverse(Test&& test, Func&& func) const;
+
+	private:
+		std::vector<Node> m_Nodes;
+
+		// in leaf order
+		std::vector<AABB> m_PrimitiveBounds;
+		std::vector<uint32_t> m_PrimitiveUserData;
+
+		// by proxy, primitive index is INVALID_PROXY for proxies not in the tree yet
+		std::vector<AABB> m_Bounds;
+		std::vector<uint32_t> m_UserData;
+		std::vector<uint32_t> m_PrimitiveIndices;
+
+		std::vector<uint32_t> m_Pending;
+
+		// proxies removed since the last build stay in the tree until then, so they can't be reused before
+		std::vector<uint32_t> m_FreeProxies;
+		std::vector<uint32_t> m_Released;
+
+		uint32_t m_NumAlive;
+		uint32_t m_NumDead;
+
+		float m_BuildCost;
+		bool m_NeedsRefit;
+	};
+
+	template<typename Test, typename Func>
+	void DynamicBVH::Traverse(Test&& test, Func&& func) const {
+
+		// test(bounds) returns EOutside, EIntersect, or EInside to skip tests for the whole subtree
+		if (!m_Nodes.empty()) {
+			struct Entry { uint32_t Node; bool Inside; };
+
+			Entry stack[64];
+			uint32_t stackSize = 0;
+			stack[stackSize++] = { 0, false };
+
+			while (stackSize > 0) {
+				Entry entry = stack[--stackSize];
+				const Node& node = m_Nodes[entry.Node];
+
+				bool inside = entry.Inside;
+				if (!inside) {
+					EFrustumTest result = test(node.GetBounds());
+
+					if (result == EFrustumTest::EOutside) continue;
+					inside = result == EFrustumTest::EInside;
+				}
+
+				if (node.IsLeaf()) {
+					for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++) {
+						if (!IsPrimitiveAlive(i)) continue;
+
+						if (inside || test(m_PrimitiveBounds[i]) != EFrustumTest::EOutside) func(m_PrimitiveUserData[i]);
+					}
+					continue;
+				}
+
+				stack[stackSize++] = { node.LeftOrFirst, inside };
+				stack[stackSize++] = { node.LeftOrFirst + 1, inside };
+			}
+		}
+
+		for (uint32_t proxy : m_Pending) {
+			if (IsAlive(proxy) && test(m_Bounds[proxy]) != EFrustumTest::EOutside) func(m_UserData[proxy]);
+		}
+	}
+
+	template<typename Func>
+	void DynamicBVH::QueryFrustum(const Frustum& frustum, Func&& func) const {
+		Traverse([&](const AABB& bounds) { return frustum.TestAABB(bounds); }, func);
+	}
+
+	template<typename Func>
+	void DynamicBVH::QueryFrustumLeaves(const Frustum& frustum, Func&& func) const {
+
+		if (!m_Nodes.empty()) {
+			uint32_t stack[64];
+			uint32_t stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0) {
+				const Node& node = m_Nodes[stack[--stackSize]];
+				if (frustum.TestAABB(node.GetBounds()) == EFrustumTest::EOutside) continue;
+
+				if (node.IsLeaf()) {
+					func(&m_PrimitiveBounds[node.LeftOrFirst], &m_PrimitiveUserData[node.LeftOrFirst], node.Count);
+					continue;
+				}
+
+				stack[stackSize++] = node.LeftOrFirst;
+				stack[stackSize++] = node.LeftOrFirst + 1;
+			}
+		}
+
+		// pending proxies aren't stored in order, removed ones already have INVALID_PROXY user data
+		for (uint32_t proxy : m_Pending) {
+			func(&m_Bounds[proxy], &m_UserData[proxy], 1);
+		}
+	}
+
+	template<typename Func>
+	void DynamicBVH::QueryBox(const AABB& box, Func&& func) const {
+
+		Traverse([&](const AABB& bounds) {
+			if (!box.Overlaps(bounds)) return EFrustumTest::EOutside;
+
+			bool inside = glm::all(glm::lessThanEqual(box.Min, bounds.Min)) && glm::all(glm::greaterThanEqual(box.Max, bounds.Max));
+			return inside ? EFrustumTest::EInside : EFrustumTest::EIntersect;
+			}, func);
+	}
+
+	template<typename Func>
+	void DynamicBVH::QuerySphere(const Vec3& center, float radius, Func&& func) const {
+		Traverse([&](const AABB& bounds) { return bounds.OverlapsSphere(center, radius) ? EFrustumTest::EIntersect : EFrustumTest::EOutside; }, func);
+	}
+
+	template<typename Func>
+	void DynamicBVH::Raycast(const Ray& ray, float maxDistance, Func&& func) const {
+
+		for (uint32_t proxy : m_Pending) {
+			if (!IsAlive(proxy)) continue;
+
+			float distance = ray.Intersect(m_Bounds[proxy], maxDistance);
+			if (distance != FLT_MAX) maxDistance = func(m_UserData[proxy], distance);
+		}
+
+		if (m_Nodes.empty()) return;
+
+		struct Entry { uint32_t Node; float Distance; };
+
+		Entry stack[64];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = { 0, ray.Intersect(m_Nodes[0].GetBounds(), maxDistance) };
+
+		while (stackSize > 0) {
+			Entry entry = stack[--stackSize];
+
+			// the ray could have been shortened since the node was pushed
+			if (entry.Distance > maxDistance) continue;
+			const Node& node = m_Nodes[entry.Node];
+
+			if (node.IsLeaf()) {
+				for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++) {
+					if (!IsPrimitiveAlive(i)) continue;
+
+					float distance = ray.Intersect(m_PrimitiveBounds[i], maxDistance);
+					if (distance != FLT_MAX) maxDistance = func(m_PrimitiveUserData[i], distance);
+				}
+				continue;
+			}
+
+			Entry left = { node.LeftOrFirst, ray.Intersect(m_Nodes[node.LeftOrFirst].GetBounds(), maxDistance) };
+			Entry right = { node.LeftOrFirst + 1, ray.Intersect(m_Nodes[node.LeftOrFirst + 1].GetBounds(), maxDistance) };
+
+			if (left.Distance > right.Distance) std::swap(left, right);
+
+			// closer child is pushed last, so it's visited first
+			if (right.Distance != FLT_MAX) stack[stackSize++] = right;
+			if (left.Distance != FLT_MAX) stack[stackSize++] = left;
+		}
+	}
+}
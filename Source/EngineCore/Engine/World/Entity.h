@@ -16,7 +16,7 @@ namespace Spike {
 		Entity(World* world, entt::entity handle) : m_World(world), m_Handle(handle) {}
 		~Entity() {}
 
-		World* GetWorld() { return m_World; }
+		World* GetWorld() const { return m_World; }
 		entt::entity GetHandle() const { return m_Handle; }
 		void Destroy() { m_World->DestroyEntity(*this); }
 
@@ -71,4 +71,52 @@ namespace Spike {
 		World* m_World;
 		entt::entity m_Handle;
  	};
+
+	// persistent reference by the entity's id, the handle is only a cache
+	// a cached handle is used while its generation is alive and still belongs to the id,
+	// otherwise the id is looked up again, so references survive the entity being unloaded and loaded back
+	class EntityRef {
+	public:
+		EntityRef() : m_ID(0), m_Handle(entt::null) {}
+		EntityRef(UUID id) : m_ID(id), m_Handle(entt::null) {}
+		EntityRef(Entity entity);
+
+		// null entity if the referenced entity isn't in the world
+		Entity Resolve(World* world) const;
+
+		UUID GetID() const { return m_ID; }
+
+		bool operator==(const EntityRef& other) const { return (uint64_t)m_ID == (uint64_t)other.m_ID; }
+		bool operator!=(const EntityRef& other) const { return !(*this == other); }
+
+		operator bool() const { return (uint64_t)m_ID != 0; }
+
+	private:
+		UUID m_ID;
+		mutable entt::entity m_Handle;
+	};
+
+	// defined here, copies need the complete entity
+	template<typename T>
+	void World::RegisterClonableComponent() {
+
+		GetComponentCloners().push_back([](const entt::registry& src, entt::registry& dst, World* dstWorld) {
+			const auto* pool = src.storage<T>();
+			if (!pool || pool->empty()) return;
+
+			auto& dstPool = dst.storage<T>();
+			dstPool.reserve(pool->size());
+
+			if constexpr (std::is_constructible_v<T, Entity, const T&>) {
+				for (auto [handle, component] : pool->each()) {
+					dstPool.emplace(handle, Entity(dstWorld, handle), component);
+				}
+			}
+			else {
+				// plain copies, trivially copyable pools end up as memory copies
+				const entt::sparse_set& entities = *pool;
+				dstPool.insert(entities.begin(), entities.end(), pool->begin());
+			}
+			});
+	}
 }
@@ -0,0 +1,141 @@
+#include <Engine/World/TransformStore.h>
+
+#include <new>
+#include <cstring>
+
+namespace Spike {
+
+	// utility
+	static constexpr size_t STORE_ALIGNMENT = 32;
+
+	template<typename T>
+	static T* AllocateArray(uint32_t count) {
+		return (T*)::operator new(sizeof(T) * count, std::align_val_t(STORE_ALIGNMENT));
+	}
+
+	template<typename T>
+	static void FreeArray(T* ptr) {
+		::operator delete(ptr, std::align_val_t(STORE_ALIGNMENT));
+	}
+
+	template<typename T>
+	static void GrowArray(T*& ptr, uint32_t oldCount, uint32_t newCount) {
+		T* data = AllocateArray<T>(newCount);
+
+		if (ptr) {
+			memcpy(data, ptr, sizeof(T) * oldCount);
+			FreeArray(ptr);
+		}
+		ptr = data;
+	}
+
+	TransformStore::TransformStore(uint32_t capacity) : m_SoA{}, m_Locals(nullptr), m_Worlds(nullptr), m_Capacity(0), m_Count(0) {
+		Grow(capacity);
+	}
+
+	TransformStore::~TransformStore() {
+
+		for (float* arr : { m_SoA.PositionX, m_SoA.PositionY, m_SoA.PositionZ, m_SoA.RotationX, m_SoA.RotationY,
+			m_SoA.RotationZ, m_SoA.RotationW, m_SoA.ScaleX, m_SoA.ScaleY, m_SoA.ScaleZ }) {
+
+			FreeArray(arr);
+		}
+
+		FreeArray(m_Locals);
+		FreeArray(m_Worlds);
+	}
+
+	void TransformStore::Grow(uint32_t capacity) {
+
+		for (float** arr : { &m_SoA.PositionX, &m_SoA.PositionY, &m_SoA.PositionZ, &m_SoA.RotationX, &m_SoA.RotationY,
+			&m_SoA.RotationZ, &m_SoA.RotationW, &m_SoA.ScaleX, &m_SoA.ScaleY, &m_SoA.ScaleZ }) {
+
+			GrowArray(*arr, m_Count, capacity);
+		}
+
+		GrowArray(m_Locals, m_Count, capacity);
+		GrowArray(m_Worlds, m_Count, capacity);
+
+		m_Capacity = capacity;
+	}
+
+	void TransformStore::CopyFrom(const TransformStore& other) {
+
+		// nothing worth keeping, the arrays are regrown without copying
+		m_Count = 0;
+		if (m_Capacity < other.m_Count) Grow(other.m_Capacity);
+
+		const float* src[] = { other.m_SoA.PositionX, other.m_SoA.PositionY, other.m_SoA.PositionZ, other.m_SoA.RotationX, other.m_SoA.RotationY,
+			other.m_SoA.RotationZ, other.m_SoA.RotationW, other.m_SoA.ScaleX, other.m_SoA.ScaleY, other.m_SoA.ScaleZ };
+		float* dst[] = { m_SoA.PositionX, m_SoA.PositionY, m_SoA.PositionZ, m_SoA.RotationX, m_SoA.RotationY,
+			m_SoA.RotationZ, m_SoA.RotationW, m_SoA.ScaleX, m_SoA.ScaleY, m_SoA.ScaleZ };
+
+		for (uint32_t i = 0; i < 10; i++) {
+			memcpy(dst[i], src[i], sizeof(float) * other.m_Count);
+		}
+
+		memcpy(m_Locals, other.m_Locals, sizeof(Mat4x4) * other.m_Count);
+		memcpy(m_Worlds, other.m_Worlds, sizeof(Mat4x4) * other.m_Count);
+
+		m_Count = other.m_Count;
+		m_FreeSlots = other.m_FreeSlots;
+	}
+
+	uint32_t TransformStore::Allocate() {
+		uint32_t slot;
+
+		if (!m_FreeSlots.empty()) {
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else {
+			if (m_Count == m_Capacity) {
+				Grow(m_Capacity * 2);
+			}
+
+			slot = m_Count++;
+		}
+
+		SetPosition(slot, Vec3(0.f));
+		SetRotation(slot, Quaternion(1.f, 0.f, 0.f, 0.f));
+		SetScale(slot, Vec3(1.f));
+
+		m_Locals[slot] = Mat4x4(1.f);
+		m_Worlds[slot] = Mat4x4(1.f);
+
+		return slot;
+	}
+
+	void TransformStore::Reserve(uint32_t count) {
+		uint32_t required = m_Count + count;
+		if (required <= m_Capacity) return;
+
+		uint32_t capacity = m_Capacity;
+		while (capacity < required) capacity *= 2;
+
+		Grow(capacity);
+	}
+
+	void TransformStore::Release(uint32_t slot) {
+		m_FreeSlots.push_back(slot);
+	}
+
+	void TransformStore::SetPosition(uint32_t slot, const Vec3& value) {
+		m_SoA.PositionX[slot] = value.x;
+		m_SoA.PositionY[slot] = value.y;
+		m_SoA.PositionZ[slot] = value.z;
+	}
+
+	void TransformStore::SetRotation(uint32_t slot, const Quaternion& value) {
+		m_SoA.RotationX[slot] = value.x;
+		m_SoA.RotationY[slot] = value.y;
+		m_SoA.RotationZ[slot] = value.z;
+		m_SoA.RotationW[slot] = value.w;
+	}
+
+	void TransformStore::SetScale(uint32_t slot, const Vec3& value) {
+		m_SoA.ScaleX[slot] = value.x;
+		m_SoA.ScaleY[slot] = value.y;
+		m_SoA.ScaleZ[slot] = value.z;
+	}
+}
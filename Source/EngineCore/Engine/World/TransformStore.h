@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Engine/Utils/SimdMath.h>
+#include <vector>
+
+namespace Spike {
+
+	// owns transforms of every entity in a world, indexed by slot
+	// arrays are reallocated on growth, so pointers into the store are valid only until the next Allocate
+	class TransformStore {
+	public:
+		TransformStore(uint32_t capacity = 1024);
+		~TransformStore();
+
+		TransformStore(const TransformStore& other) = delete;
+		TransformStore& operator=(const TransformStore& other) = delete;
+
+		uint32_t Allocate();
+		void Release(uint32_t slot);
+
+		// makes room for count more slots, so bulk allocation doesn't regrow the arrays
+		void Reserve(uint32_t count);
+
+		// replaces every slot with the other store's, slots stay the same
+		void CopyFrom(const TransformStore& other);
+
+		Vec3 GetPosition(uint32_t slot) const { return Vec3(m_SoA.PositionX[slot], m_SoA.PositionY[slot], m_SoA.PositionZ[slot]); }
+		Quaternion GetRotation(uint32_t slot) const { return Quaternion(m_SoA.RotationW[slot], m_SoA.RotationX[slot], m_SoA.RotationY[slot], m_SoA.RotationZ[slot]); }
+		Vec3 GetScale(uint32_t slot) const { return Vec3(m_SoA.ScaleX[slot], m_SoA.ScaleY[slot], m_SoA.ScaleZ[slot]); }
+
+		void SetPosition(uint32_t slot, const Vec3& value);
+		void SetRotation(uint32_t slot, const Quaternion& value);
+		void SetScale(uint32_t slot, const Vec3& value);
+
+		Mat4x4& GetLocal(uint32_t slot) { return m_Locals[slot]; }
+		Mat4x4& GetWorld(uint32_t slot) { return m_Worlds[slot]; }
+		const Mat4x4& GetWorld(uint32_t slot) const { return m_Worlds[slot]; }
+
+		Mat4x4* GetLocals() { return m_Locals; }
+		Mat4x4* GetWorlds() { return m_Worlds; }
+		const TransformSoA& GetSoA() const { return m_SoA; }
+
+		// every valid slot is below capacity
+		uint32_t GetCapacity() const { return m_Capacity; }
+
+		static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+	private:
+		void Grow(uint32_t capacity);
+
+	private:
+		TransformSoA m_SoA;
+		Mat4x4* m_Locals;
+		Mat4x4* m_Worlds;
+
+		uint32_t m_Capacity;
+		uint32_t m_Count;
+		std::vector<uint32_t> m_FreeSlots;
+	};
+}
@@ -0,0 +1,101 @@
+#include <Engine/World/ViewCuller.h>
+#include <Engine/World/Components.h>
+#include <Engine/Utils/SimdMath.h>
+
+#include <algorithm>
+
+namespace Spike {
+
+	void ViewCuller::Cull(World* world, const ViewCullDesc& desc, std::vector<Entity>& outVisible) {
+		outVisible.clear();
+		m_Stats = {};
+
+		m_CandidateBounds.clear();
+		m_CandidateHandles.clear();
+
+		Frustum frustum = Frustum::FromViewProj(desc.ViewProj);
+
+		// whole leaves are collected and tested in batches below
+		world->GetSpatialIndex().QueryFrustumLeaves(frustum, [&](const AABB* bounds, const uint32_t* userData, uint32_t count) {
+			for (uint32_t i = 0; i < count; i++) {
+				if (userData[i] == DynamicBVH::INVALID_PROXY) continue;
+
+				m_CandidateBounds.push_back(bounds[i]);
+				m_CandidateHandles.push_back(userData[i]);
+			}
+			});
+
+		uint32_t numCandidates = (uint32_t)m_CandidateBounds.size();
+		m_Visible.resize(numCandidates);
+
+		uint32_t numVisible = SimdMath::FrustumCull(frustum, m_CandidateBounds.data(), numCandidates, m_Visible.data());
+
+		m_Stats.NumCandidates = numCandidates;
+		m_Stats.NumInFrustum = numVisible;
+
+		if (desc.OcclusionCulling) {
+			RasterizeOccluders(world, desc, numVisible);
+		}
+
+		outVisible.reserve(numVisible);
+		for (uint32_t i = 0; i < numVisible; i++) {
+			uint32_t candidate = m_Visible[i];
+
+			if (m_Stats.NumOccluders > 0 && m_Occlusion.IsOccluded(m_CandidateBounds[candidate], desc.ViewProj)) {
+				m_Stats.NumOccluded++;
+				continue;
+			}
+
+			outVisible.emplace_back(world, (entt::entity)m_CandidateHandles[candidate]);
+		}
+	}
+
+	void ViewCuller::RasterizeOccluders(World* world, const ViewCullDesc& desc, uint32_t numVisible) {
+		m_Occluders.clear();
+
+		float screenArea = (float)(m_Occlusion.GetWidth() * m_Occlusion.GetHeight());
+
+		for (uint32_t i = 0; i < numVisible; i++) {
+			entt::entity handle = (entt::entity)m_CandidateHandles[m_Visible[i]];
+			if (!world->EntityHasComponent<StaticMeshComponent>(handle)) continue;
+
+			const Ref<Mesh>& mesh = world->GetEntityComponent<StaticMeshComponent>(handle).GetMesh();
+			if (!mesh.Valid()) continue;
+
+			// without cpu data the arrays are released once the mesh is uploaded
+			RHIMesh* resource = mesh->GetResource();
+			if (!resource->GetDesc().NeedCPUData || resource->GetIndices().empty()) continue;
+
+			Vec4 rect;
+			float depth;
+			if (!m_Occlusion.ProjectBox(m_CandidateBounds[m_Visible[i]], desc.ViewProj, rect, depth)) continue;
+
+			float width = std::clamp(rect.z, 0.f, (float)m_Occlusion.GetWidth()) - std::clamp(rect.x, 0.f, (float)m_Occlusion.GetWidth());
+			float height = std::clamp(rect.w, 0.f, (float)m_Occlusion.GetHeight()) - std::clamp(rect.y, 0.f, (float)m_Occlusion.GetHeight());
+
+			float area = width * height / screenArea;
+			if (area >= desc.MinOccluderArea) m_Occluders.emplace_back(area, m_Visible[i]);
+		}
+
+		uint32_t numOccluders = std::min((uint32_t)m_Occluders.size(), desc.MaxOccluders);
+		std::partial_sort(m_Occluders.begin(), m_Occluders.begin() + numOccluders, m_Occluders.end(), std::greater<std::pair<float, uint32_t>>());
+
+		m_Occlusion.Clear();
+
+		for (uint32_t i = 0; i < numOccluders; i++) {
+			entt::entity handle = (entt::entity)m_CandidateHandles[m_Occluders[i].second];
+
+			RHIMesh* resource = world->GetEntityComponent<StaticMeshComponent>(handle).GetMesh()->GetResource();
+			const Mat4x4& transform = world->GetEntityComponent<TransformComponent>(handle).GetWorldTranform();
+
+			const std::vector<Vertex>& vertices = resource->GetVertices();
+			const std::vector<uint32_t>& indices = resource->GetIndices();
+
+			m_Occlusion.RasterizeTriangles(desc.ViewProj * transform, &vertices[0].Position.x, sizeof(Vertex), (uint32_t)vertices.size(),
+				indices.data(), (uint32_t)indices.size());
+		}
+
+		m_Occlusion.BuildTiles();
+		m_Stats.NumOccluders = numOccluders;
+	}
+}
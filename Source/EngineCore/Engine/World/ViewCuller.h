@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Engine/World/Entity.h>
+#include <Engine/Renderer/SoftwareOcclusion.h>
+
+namespace Spike {
+
+	struct ViewCullDesc {
+
+		Mat4x4 ViewProj;
+
+		bool OcclusionCulling = true;
+
+		// the biggest visible meshes on screen are rasterized as occluders, they need cpu data (MeshDesc::NeedCPUData)
+		uint32_t MaxOccluders = 16;
+		float MinOccluderArea = 0.01f; // fraction of the screen
+	};
+
+	struct ViewCullStats {
+
+		uint32_t NumCandidates = 0;
+		uint32_t NumInFrustum = 0;
+		uint32_t NumOccluders = 0;
+		uint32_t NumOccluded = 0;
+	};
+
+	// cpu visibility for views without a gpu culling pass, like shadow, secondary, or headless views
+	// candidates come from the world's spatial index, are frustum tested in simd batches,
+	// then tested against a software depth buffer with the biggest occluders in view
+	class ViewCuller {
+	public:
+		ViewCuller(uint32_t occlusionWidth = 256, uint32_t occlusionHeight = 128) : m_Occlusion(occlusionWidth, occlusionHeight) {}
+
+		void Cull(World* world, const ViewCullDesc& desc, std::vector<Entity>& outVisible);
+
+		const ViewCullStats& GetStats() const { return m_Stats; }
+		const SoftwareOcclusionBuffer& GetOcclusionBuffer() const { return m_Occlusion; }
+
+	private:
+		void RasterizeOccluders(World* world, const ViewCullDesc& desc, uint32_t numVisible);
+
+	private:
+		SoftwareOcclusionBuffer m_Occlusion;
+		ViewCullStats m_Stats;
+
+		// kept between calls to avoid allocations
+		std::vector<AABB> m_CandidateBounds;
+		std::vector<uint32_t> m_CandidateHandles;
+		std::vector<uint32_t> m_Visible;
+		std::vector<std::pair<float, uint32_t>> m_Occluders;
+	};
+}
@@ -3,22 +3,39 @@
 #include <Engine/Core/Application.h>
 #include <Engine/World/Entity.h>
 #include <Engine/World/Components.h>
+#include <Engine/Multithreading/JobSystem.h>
+#include <Engine/Renderer/RenderGraph.h>
+#include <Engine/Renderer/GfxDevice.h>
+#include <Engine/Renderer/Mesh.h>
+#include <Engine/Renderer/Material.h>
 
-namespace Spike {
+#include <Engine/World/WorldFormat.h>
+#include <Engine/World/WorldLoader.h>
+#include <Engine/Serialization/MappedFile.h>
+
+#include <Generated/SceneScatter.h>
 
-	RHIWorldProxy::RHIWorldProxy() {
+namespace Spike {
 
+	RHIWorldProxy::RHIWorldProxy() :
+		NumViews(1), ViewInstancesStride(OBJECTS_PAGE_SIZE), ViewGroupLodsStride(GROUPS_PAGE_SIZE * MESH_MAX_LODS),
+		ViewVisibilityStride(OBJECTS_PAGE_SIZE), ViewMeshletCommandsStride(OBJECTS_PAGE_SIZE), ViewMeshletVisibilityStride(OBJECTS_PAGE_SIZE),
+		ObjectsVB(OBJECTS_PAGE_SIZE), LightsVB(LIGHTS_PAGE_SIZE), GroupsVB(GROUPS_PAGE_SIZE),
+		m_GroupCountsChanged(false), m_BatchCountsChanged(false), m_MeshletCommandsCount(0)
+	{
+		// every scene buffer starts with a single page and is resized with its records before uploads
 		{
 			BufferDesc desc{};
-			desc.Size = sizeof(LightGPUData) * MAX_LIGHTS_PER_WORLD;
-			desc.UsageFlags = EBufferUsageFlags::EStorage;
-			desc.MemUsage = EBufferMemUsage::ECPUToGPU;
+			desc.Size = sizeof(LightGPUData) * LIGHTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopySrc | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
 
 			LightsBuffer = new RHIBuffer(desc);
 		}
 		{
+			// one command per group and lod at most
 			BufferDesc desc{};
-			desc.Size = sizeof(DrawIndirectCommand) * MAX_DRAW_OBJECTS_PER_WORLD;
+			desc.Size = sizeof(DrawIndirectCommand) * GROUPS_PAGE_SIZE * MESH_MAX_LODS;
 			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::EIndirect;
 			desc.MemUsage = EBufferMemUsage::EGPUOnly;
 
@@ -26,7 +43,7 @@ namespace Spike {
 		}
 		{
 			BufferDesc desc{};
-			desc.Size = sizeof(uint32_t) * MAX_SHADERS_PER_WORLD;
+			desc.Size = sizeof(uint32_t) * VIEW_DRAW_COUNTS;
 			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::EIndirect | EBufferUsageFlags::ECopyDst;
 			desc.MemUsage = EBufferMemUsage::EGPUOnly;
 
@@ -34,19 +51,70 @@ namespace Spike {
 		}
 		{
 			BufferDesc desc{};
-			desc.Size = sizeof(ObjectGPUData) * MAX_DRAW_OBJECTS_PER_WORLD;
-			desc.UsageFlags = EBufferUsageFlags::EStorage;
-			desc.MemUsage = EBufferMemUsage::ECPUToGPU;
+			desc.Size = sizeof(DrawIndirectCommand) * OBJECTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::EIndirect;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			MeshletCommandsBuffer = new RHIBuffer(desc);
+		}
+		{
+			// dispatch arguments of the meshlet stage followed by the queue size of every view
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * (4 + MAX_RENDER_VIEWS);
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::EIndirect | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			MeshletDispatchBuffer = new RHIBuffer(desc);
+		}
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(ObjectGPUData) * OBJECTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopySrc | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
 
 			ObjectsBuffer = new RHIBuffer(desc);
 		}
 		{
 			BufferDesc desc{};
-			desc.Size = sizeof(uint32_t) * MAX_DRAW_OBJECTS_PER_WORLD;
+			desc.Size = sizeof(InstanceGroupGPUData) * GROUPS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopySrc | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			GroupsBuffer = new RHIBuffer(desc);
+		}
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * GROUPS_PAGE_SIZE * MESH_MAX_LODS;
 			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopyDst;
 			desc.MemUsage = EBufferMemUsage::EGPUOnly;
 
+			GroupCountsBuffer = new RHIBuffer(desc);
+		}
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * OBJECTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			VisibleInstancesBuffer = new RHIBuffer(desc);
+			InstanceSlotsBuffer = new RHIBuffer(desc);
+		}
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * OBJECTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopySrc | EBufferUsageFlags::ECopyDst;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
 			VisibilityBuffer = new RHIBuffer(desc);
+			MeshletVisibilityBuffer = new RHIBuffer(desc);
+		}
+		{
+			BufferDesc desc{};
+			desc.Size = sizeof(uint32_t) * OBJECTS_PAGE_SIZE;
+			desc.UsageFlags = EBufferUsageFlags::EStorage;
+			desc.MemUsage = EBufferMemUsage::EGPUOnly;
+
+			MeshletQueueBuffer = new RHIBuffer(desc);
 		}
 	}
 
@@ -56,12 +124,452 @@ namespace Spike {
 		DrawCommandsBuffer->InitRHI();
 		DrawCountsBuffer->InitRHI();
 		ObjectsBuffer->InitRHI();
+		GroupsBuffer->InitRHI();
+		GroupCountsBuffer->InitRHI();
+		VisibleInstancesBuffer->InitRHI();
+		InstanceSlotsBuffer->InitRHI();
 		VisibilityBuffer->InitRHI();
+		MeshletQueueBuffer->InitRHI();
+		MeshletDispatchBuffer->InitRHI();
+		MeshletCommandsBuffer->InitRHI();
+		MeshletVisibilityBuffer->InitRHI();
+
+		ShaderDesc desc{};
+		desc.Type = EShaderType::ECompute;
+		desc.Name = "SceneScatter";
+
+		m_ScatterShader = GShaderManager->GetShaderFromCache(desc);
+	}
+
+	void RHIWorldProxy::CopyRecordsFrom(const RHIWorldProxy& other) {
+		ObjectsVB.CopyFrom(other.ObjectsVB);
+		GroupsVB.CopyFrom(other.GroupsVB);
+		LightsVB.CopyFrom(other.LightsVB);
+
+		m_GroupLookup = other.m_GroupLookup;
+		m_Groups = other.m_Groups;
+		m_FreeGroups = other.m_FreeGroups;
+		m_GroupCountsChanged = true;
+
+		Batches = other.Batches;
+		m_BatchLookup = other.m_BatchLookup;
+		m_FreeBatches = other.m_FreeBatches;
+		m_BatchCountsChanged = true;
+
+		VisibilityQueue = other.VisibilityQueue;
+		MeshletVisibilityQueue = other.MeshletVisibilityQueue;
+		SunData = other.SunData;
+	}
+
+	uint32_t RHIWorldProxy::AcquireInstanceGroup(RHIMesh* mesh, uint32_t subMesh, RHIMaterial* material) {
+		InstanceGroupKey key{ mesh, subMesh, material };
+		m_GroupCountsChanged = true;
+
+		auto it = m_GroupLookup.find(key);
+		if (it != m_GroupLookup.end()) {
+			m_Groups[it->second].NumInstances++;
+			return it->second;
+		}
+
+		const SubMesh& sMesh = mesh->GetDesc().SubMeshes[subMesh];
+
+		InstanceGroupGPUData data{};
+		data.BoundsOrigin = Vec4(mesh->GetBoundsOrigin(), mesh->GetBoundsRadius());
+		data.IndexBufferAddress = mesh->GetIndexBuffer()->GetGPUAddress();
+		data.VertexBufferAddress = mesh->GetVertexBuffer()->GetGPUAddress();
+		data.LodFirstIndex[0] = sMesh.FirstIndex;
+		data.LodIndexCount[0] = sMesh.IndexCount;
+		data.LodErrors[0] = 0.f;
+		data.LodCount = 1;
+
+		for (const SubMeshLOD& lod : mesh->GetDesc().LODs) {
+			if (lod.SubMesh != subMesh || data.LodCount == MESH_MAX_LODS) continue;
+
+			data.LodFirstIndex[data.LodCount] = lod.FirstIndex;
+			data.LodIndexCount[data.LodCount] = lod.IndexCount;
+			data.LodErrors[data.LodCount] = lod.Error;
+			data.LodCount++;
+		}
+
+		// meshlets of a submesh follow each other
+		const std::vector<Meshlet>& meshlets = mesh->GetDesc().Meshlets;
+		for (uint32_t i = 0; i < (uint32_t)meshlets.size(); i++) {
+			if (meshlets[i].SubMesh != subMesh) continue;
+
+			if (data.MeshletCount == 0) {
+				data.MeshletBufferAddress = mesh->GetMeshletBuffer()->GetGPUAddress() + sizeof(Meshlet) * i;
+			}
+			data.MeshletCount++;
+		}
+
+		const ShaderDesc& shaderDesc = material->GetShader()->GetDesc();
+		if (!shaderDesc.CullBackFaces) {
+			data.MeshletConeCulling = MESHLET_CONES_OFF;
+		}
+		else {
+			data.MeshletConeCulling = shaderDesc.FrontFace == EFrontFace::EClockWise ? MESHLET_CONES_FRONT : MESHLET_CONES_MIRRORED;
+		}
+		data.MaterialBufferIndex = material->GetDataIndex();
+		data.DrawBatchID = FindBatch(material->GetShader());
+
+		uint32_t group;
+		if (!m_FreeGroups.empty()) {
+			group = m_FreeGroups.back();
+			m_FreeGroups.pop_back();
+
+			GroupsVB[group] = data;
+		}
+		else {
+			group = GroupsVB.Push(data);
+			m_Groups.emplace_back();
+		}
+
+		m_Groups[group] = InstanceGroup{ key, 1 };
+		m_GroupLookup.emplace(key, group);
+
+		return group;
+	}
+
+	void RHIWorldProxy::ReleaseInstanceGroup(uint32_t group) {
+		InstanceGroup& g = m_Groups[group];
+		m_GroupCountsChanged = true;
+
+		if (--g.NumInstances > 0) return;
+
+		InstanceGroupGPUData& data = GroupsVB[group];
+		RemoveFromBatch(data.DrawBatchID);
+
+		// left in place without instances, the command pass skips it until it's reused
+		data.LodCount = 0;
+		data.MeshletCount = 0;
+		data.DrawBatchID = INVALID_SHADER_INDEX;
+
+		m_GroupLookup.erase(g.Key);
+		m_FreeGroups.push_back(group);
+
+		// nothing is drawn anymore, the group storage can shrink back to a page
+		if (m_GroupLookup.empty()) {
+			m_Groups.clear();
+			m_FreeGroups.clear();
+			GroupsVB.Clear();
+		}
+	}
+
+	void RHIWorldProxy::UpdateInstanceOffsets() {
+		if (!m_GroupCountsChanged) return;
+		m_GroupCountsChanged = false;
+
+		// only groups whose range actually moved are written, so they're the only ones uploaded
+		const DenseBuffer<InstanceGroupGPUData>& groups = GroupsVB;
+		uint32_t offset = 0;
+
+		for (uint32_t i = 0; i < (uint32_t)m_Groups.size(); i++) {
+			uint32_t count = m_Groups[i].NumInstances;
+
+			if (groups[i].InstanceOffset != offset || groups[i].InstanceCount != count) {
+				InstanceGroupGPUData& data = GroupsVB[i];
+				data.InstanceOffset = offset;
+				data.InstanceCount = count;
+			}
+
+			offset += count;
+		}
+	}
+
+	void RHIWorldProxy::UpdateMeshletCommandOffsets() {
+		if (!m_GroupCountsChanged && !m_BatchCountsChanged) return;
+
+		for (WorldDrawBatch& b : Batches) {
+			b.MeshletCommandsCount = 0;
+		}
+
+		// every meshlet of every instance can be visible at once
+		const DenseBuffer<InstanceGroupGPUData>& groups = GroupsVB;
+		for (uint32_t i = 0; i < (uint32_t)m_Groups.size(); i++) {
+			uint32_t batch = groups[i].DrawBatchID;
+			if (m_Groups[i].NumInstances == 0 || batch == INVALID_SHADER_INDEX) continue;
+
+			Batches[batch].MeshletCommandsCount += m_Groups[i].NumInstances * groups[i].MeshletCount;
+		}
+
+		uint32_t offset = 0;
+		for (WorldDrawBatch& b : Batches) {
+			b.MeshletCommandOffset = offset;
+			offset += b.MeshletCommandsCount;
+		}
+
+		m_MeshletCommandsCount = offset;
+	}
+
+	uint32_t RHIWorldProxy::FindBatch(RHIShader* shader) {
+		m_BatchCountsChanged = true;
+
+		auto it = m_BatchLookup.find(shader);
+		if (it != m_BatchLookup.end()) {
+			Batches[it->second].CommandsCount++;
+			return it->second;
+		}
+
+		if (m_FreeBatches.empty() && Batches.size() >= MAX_SHADERS_PER_WORLD) {
+			ENGINE_ERROR("Too many shaders in a world, max is: {}", MAX_SHADERS_PER_WORLD);
+			return INVALID_SHADER_INDEX;
+		}
+
+		uint32_t idx;
+		if (!m_FreeBatches.empty()) {
+			idx = m_FreeBatches.back();
+			m_FreeBatches.pop_back();
+		}
+		else {
+			idx = (uint32_t)Batches.size();
+			Batches.emplace_back();
+		}
+
+		Batches[idx] = WorldDrawBatch{ .CommandsCount = 1, .CommandOffset = 0, .Shader = shader, .MeshletCommandsCount = 0, .MeshletCommandOffset = 0 };
+		m_BatchLookup.emplace(shader, idx);
+
+		return idx;
+	}
+
+	void RHIWorldProxy::RemoveFromBatch(uint32_t idx) {
+		if (idx == INVALID_SHADER_INDEX) return;
+
+		WorldDrawBatch& b = Batches[idx];
+		m_BatchCountsChanged = true;
+
+		if (--b.CommandsCount > 0) return;
+
+		m_BatchLookup.erase(b.Shader);
+		b.Shader = nullptr;
 
-		ObjectsVB.Make((ObjectGPUData*)ObjectsBuffer->GetMappedData(), MAX_DRAW_OBJECTS_PER_WORLD);
-		LightsVB.Make((LightGPUData*)LightsBuffer->GetMappedData(), MAX_LIGHTS_PER_WORLD);
+		// trailing slots are dropped right away, holes wait for the compaction
+		if (idx == Batches.size() - 1) {
+			Batches.pop_back();
+		}
+		else {
+			m_FreeBatches.push_back(idx);
+		}
+	}
+
+	void RHIWorldProxy::CompactBatches() {
+		if (m_FreeBatches.empty() || m_FreeBatches.size() * 4 < Batches.size()) return;
+
+		std::vector<uint32_t> remap(Batches.size(), INVALID_SHADER_INDEX);
+		uint32_t count = 0;
+
+		for (uint32_t i = 0; i < (uint32_t)Batches.size(); i++) {
+			if (!Batches[i].Shader) continue;
+
+			remap[i] = count;
+			if (i != count) {
+				Batches[count] = Batches[i];
+				m_BatchLookup[Batches[count].Shader] = count;
+			}
+			count++;
+		}
+
+		Batches.resize(count);
+		m_FreeBatches.clear();
+		m_BatchCountsChanged = true;
+
+		// only groups of moved batches are rewritten and uploaded
+		const DenseBuffer<InstanceGroupGPUData>& groups = GroupsVB;
+		for (uint32_t i = 0; i < (uint32_t)m_Groups.size(); i++) {
+			if (m_Groups[i].NumInstances == 0) continue;
+
+			uint32_t batch = groups[i].DrawBatchID;
+			if (batch != INVALID_SHADER_INDEX && remap[batch] != batch) {
+				GroupsVB[i].DrawBatchID = remap[batch];
+			}
+		}
+	}
+
+	void RHIWorldProxy::UpdateBatchOffsets() {
+		if (!m_BatchCountsChanged) return;
+		m_BatchCountsChanged = false;
+
+		uint32_t offset = 0;
+		for (WorldDrawBatch& b : Batches) {
+			b.CommandOffset = offset;
+			offset += b.CommandsCount * MESH_MAX_LODS;
+		}
+	}
+
+	// recreates the buffer with a new size, old contents are copied over on the gpu when asked,
+	// the old buffer is destroyed once frames using it are done
+	static void ResizeBuffer(RHICommandBuffer* cmd, RHIBuffer*& buffer, size_t size, bool keepContents) {
+		if (buffer->GetSize() == size) return;
+
+		BufferDesc desc = buffer->GetDesc();
+		desc.Size = size;
+
+		RHIBuffer* resized = new RHIBuffer(desc);
+		resized->InitRHI();
+
+		if (keepContents) {
+			size_t copySize = std::min(buffer->GetSize(), size);
+
+			GRHIDevice->BarrierBuffer(cmd, buffer, copySize, 0, EGPUAccessFlags::ESRV | EGPUAccessFlags::EUAV, EGPUAccessFlags::ECopySrc);
+			GRHIDevice->CopyBuffer(cmd, buffer, resized, 0, 0, copySize);
+			GRHIDevice->BarrierBuffer(cmd, resized, copySize, 0, EGPUAccessFlags::ECopyDst, EGPUAccessFlags::ESRV);
+		}
+
+		buffer->ReleaseRHI();
+		delete buffer;
+		buffer = resized;
+	}
+
+	// in whole pages, doubles when more is needed and halves once under a quarter is used
+	static uint32_t GetViewCapacity(uint32_t capacity, uint32_t needed, uint32_t pageSize) {
+		uint32_t newCapacity = capacity;
+
+		if (needed > capacity) {
+			newCapacity = std::max(capacity * 2, needed);
+		}
+		else if (capacity > pageSize && needed * 4 <= capacity) {
+			newCapacity = std::max(capacity / 2, needed);
+		}
+
+		return std::max((newCapacity + pageSize - 1) / pageSize, 1u) * pageSize;
+	}
+
+	// every view keeps its own slice, so they are copied one by one when the slice size changes
+	static void ResizeViewSlices(RHICommandBuffer* cmd, RHIBuffer*& buffer, uint32_t stride, uint32_t newStride, uint32_t numViews) {
+		size_t size = sizeof(uint32_t) * newStride * numViews;
+		if (stride == newStride && buffer->GetSize() == size) return;
+
+		BufferDesc desc = buffer->GetDesc();
+		desc.Size = size;
+
+		RHIBuffer* resized = new RHIBuffer(desc);
+		resized->InitRHI();
+
+		uint32_t oldViews = uint32_t(buffer->GetSize() / (sizeof(uint32_t) * stride));
+		size_t copySize = sizeof(uint32_t) * std::min(stride, newStride);
+
+		GRHIDevice->BarrierBuffer(cmd, buffer, buffer->GetSize(), 0, EGPUAccessFlags::ESRV | EGPUAccessFlags::EUAV, EGPUAccessFlags::ECopySrc);
+		for (uint32_t view = 0; view < std::min(oldViews, numViews); view++) {
+			GRHIDevice->CopyBuffer(cmd, buffer, resized, sizeof(uint32_t) * stride * view, sizeof(uint32_t) * newStride * view, copySize);
+		}
+		GRHIDevice->BarrierBuffer(cmd, resized, resized->GetSize(), 0, EGPUAccessFlags::ECopyDst, EGPUAccessFlags::ESRV);
+
+		buffer->ReleaseRHI();
+		delete buffer;
+		buffer = resized;
+	}
+
+	void RHIWorldProxy::ResizeSceneBuffers(RHICommandBuffer* cmd) {
+		auto capacity = [](const auto& records) {
+			return std::max(records.GetCapacity(), records.GetPageSize());
+			};
+
+		// buffers are bound by the features every frame, so new ones are picked up without anything else
+		ResizeBuffer(cmd, ObjectsBuffer, sizeof(ObjectGPUData) * capacity(ObjectsVB), true);
+		ResizeBuffer(cmd, GroupsBuffer, sizeof(InstanceGroupGPUData) * capacity(GroupsVB), true);
+		ResizeBuffer(cmd, LightsBuffer, sizeof(LightGPUData) * capacity(LightsVB), true);
+
+		// written by every cull pass, nothing to keep
+		ViewInstancesStride = capacity(ObjectsVB);
+		ViewGroupLodsStride = capacity(GroupsVB) * MESH_MAX_LODS;
+
+		ResizeBuffer(cmd, VisibleInstancesBuffer, sizeof(uint32_t) * ViewInstancesStride * NumViews, false);
+		ResizeBuffer(cmd, InstanceSlotsBuffer, sizeof(uint32_t) * ViewInstancesStride * NumViews, false);
+		ResizeBuffer(cmd, GroupCountsBuffer, sizeof(uint32_t) * ViewGroupLodsStride * NumViews, false);
+		ResizeBuffer(cmd, DrawCommandsBuffer, sizeof(DrawIndirectCommand) * ViewGroupLodsStride * NumViews, false);
+		ResizeBuffer(cmd, DrawCountsBuffer, sizeof(uint32_t) * VIEW_DRAW_COUNTS * NumViews, false);
+		ResizeBuffer(cmd, MeshletQueueBuffer, sizeof(uint32_t) * ViewInstancesStride * NumViews, false);
+
+		ViewMeshletCommandsStride = GetViewCapacity(ViewMeshletCommandsStride, m_MeshletCommandsCount, OBJECTS_PAGE_SIZE);
+		ResizeBuffer(cmd, MeshletCommandsBuffer, sizeof(DrawIndirectCommand) * ViewMeshletCommandsStride * NumViews, false);
+
+		// last frame visibility drives the next prepass, so it's carried over
+		uint32_t visibilityStride = GetViewCapacity(ViewVisibilityStride, VisibilityQueue.GetRange(), OBJECTS_PAGE_SIZE);
+		ResizeViewSlices(cmd, VisibilityBuffer, ViewVisibilityStride, visibilityStride, NumViews);
+		ViewVisibilityStride = visibilityStride;
+
+		uint32_t meshletVisibilityStride = GetViewCapacity(ViewMeshletVisibilityStride, MeshletVisibilityQueue.GetRange(), OBJECTS_PAGE_SIZE);
+		ResizeViewSlices(cmd, MeshletVisibilityBuffer, ViewMeshletVisibilityStride, meshletVisibilityStride, NumViews);
+		ViewMeshletVisibilityStride = meshletVisibilityStride;
+	}
+
+	void RHIWorldProxy::SetNumViews(uint32_t numViews) {
+		NumViews = std::clamp(numViews, 1u, MAX_RENDER_VIEWS);
+	}
+
+	void RHIWorldProxy::UploadDirtyData(RHICommandBuffer* cmd) {
+
+		CompactBatches();
+		UpdateMeshletCommandOffsets();
+		UpdateBatchOffsets();
+		UpdateInstanceOffsets();
+		ResizeSceneBuffers(cmd);
+
+		ScatterDirtyRecords(cmd, ObjectsVB, ObjectsBuffer);
+		ScatterDirtyRecords(cmd, GroupsVB, GroupsBuffer);
+		ScatterDirtyRecords(cmd, LightsVB, LightsBuffer);
+	}
+
+	template<typename T>
+	void RHIWorldProxy::ScatterDirtyRecords(RHICommandBuffer* cmd, DenseBuffer<T>& records, RHIBuffer* dst) {
+		static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+
+		m_DirtyOffsets.clear();
+		records.FlushDirty([this](uint32_t offset) {
+			m_DirtyOffsets.push_back(offset);
+			});
+
+		if (m_DirtyOffsets.empty()) return;
+
+		uint32_t count = (uint32_t)m_DirtyOffsets.size();
+		uint32_t payloadOffset = (sizeof(uint32_t) * count + 15) & ~15u;
+
+		// pooled upload buffers are matched by size, so round it up to reuse them between frames
+		size_t uploadSize = 64 * 1024;
+		while (uploadSize < payloadOffset + sizeof(T) * count) uploadSize <<= 1;
+
+		BufferDesc uploadDesc{};
+		uploadDesc.Size = uploadSize;
+		uploadDesc.UsageFlags = EBufferUsageFlags::EStorage;
+		uploadDesc.MemUsage = EBufferMemUsage::ECPUToGPU;
+
+		RHIBuffer* upload = GRDGPool->GetOrCreateBuffer(uploadDesc);
+		{
+			uint8_t* data = (uint8_t*)upload->GetMappedData();
+			memcpy(data, m_DirtyOffsets.data(), sizeof(uint32_t) * count);
+
+			T* payload = (T*)(data + payloadOffset);
+			const T* src = records.GetRawData();
+
+			for (uint32_t i = 0; i < count; i++) {
+				payload[i] = src[m_DirtyOffsets[i]];
+			}
+		}
+
+		RHIBindingSet* scatterSet = GRDGPool->GetOrCreateBindingSet(m_ScatterShader->GetLayouts()[0]);
+		scatterSet->AddBufferWrite(0, 0, EShaderResourceType::EBufferSRV, upload, upload->GetSize(), 0);
+		scatterSet->AddBufferWrite(1, 0, EShaderResourceType::EBufferUAV, dst, dst->GetSize(), 0);
+
+		// grid stride loop, keeps the group count below dispatch limits for big uploads
+		const uint32_t groupSize = 64;
+		const uint32_t maxGroups = 4096;
+		uint32_t groupCount = std::min(GetComputeGroupCount(count * (uint32_t)(sizeof(T) / sizeof(uint32_t)), groupSize), maxGroups);
+
+		SceneScatterPushData pushData{};
+		pushData.RecordCount = count;
+		pushData.RecordWords = sizeof(T) / sizeof(uint32_t);
+		pushData.PayloadOffset = payloadOffset;
+		pushData.ThreadStride = groupCount * groupSize;
+
+		GRHIDevice->BarrierBuffer(cmd, dst, dst->GetSize(), 0, EGPUAccessFlags::ESRV, EGPUAccessFlags::EUAVCompute);
+
+		GRHIDevice->BindShader(cmd, m_ScatterShader, { scatterSet }, &pushData);
+		GRHIDevice->DispatchCompute(cmd, groupCount, 1, 1);
+
+		GRHIDevice->BarrierBuffer(cmd, dst, dst->GetSize(), 0, EGPUAccessFlags::EUAVCompute, EGPUAccessFlags::ESRV);
 	}
 
+	RHIWorldProxy::~RHIWorldProxy() {}
+
 	void RHIWorldProxy::ReleaseRHI() {
 
 		LightsBuffer->ReleaseRHIImmediate();
@@ -72,8 +580,24 @@ namespace Spike {
 		delete DrawCountsBuffer;
 		ObjectsBuffer->ReleaseRHIImmediate();
 		delete ObjectsBuffer;
+		GroupsBuffer->ReleaseRHIImmediate();
+		delete GroupsBuffer;
+		GroupCountsBuffer->ReleaseRHIImmediate();
+		delete GroupCountsBuffer;
+		VisibleInstancesBuffer->ReleaseRHIImmediate();
+		delete VisibleInstancesBuffer;
+		InstanceSlotsBuffer->ReleaseRHIImmediate();
+		delete InstanceSlotsBuffer;
 		VisibilityBuffer->ReleaseRHIImmediate();
 		delete VisibilityBuffer;
+		MeshletQueueBuffer->ReleaseRHIImmediate();
+		delete MeshletQueueBuffer;
+		MeshletDispatchBuffer->ReleaseRHIImmediate();
+		delete MeshletDispatchBuffer;
+		MeshletCommandsBuffer->ReleaseRHIImmediate();
+		delete MeshletCommandsBuffer;
+		MeshletVisibilityBuffer->ReleaseRHIImmediate();
+		delete MeshletVisibilityBuffer;
 	}
 
 	World::World() {
@@ -93,34 +617,633 @@ namespace Spike {
 			});
 	}
 
+	Ref<World> World::Create() {
+		return CreateRef<World>();
+	}
+
+	Ref<World> World::Create(const std::filesystem::path& path) {
+		MappedFile file(path);
+
+		if (!file.IsOpen()) {
+			ENGINE_ERROR("Failed to open world file at: {}", path.string());
+			return nullptr;
+		}
+
+		return Create(file.GetData(), file.GetSize());
+	}
+
+	Ref<World> World::Create(const uint8_t* data, size_t size) {
+		WorldLoader loader(data, size);
+		if (!loader.IsValid()) return nullptr;
+
+		Ref<World> w = CreateRef<World>();
+		loader.Step(w.Get());
+
+		return w;
+	}
+
 	void World::SaveAs(const std::filesystem::path& path) {
+
+		// levels hold every live entity, parents always before children
+		std::vector<entt::entity> order{};
+
+		for (const HierarchyLevel& level : m_HierarchyLevels) {
+			order.insert(order.end(), level.Entities.begin(), level.Entities.end());
+		}
+
+		WriteEntities(path, order);
+	}
+
+	void World::SaveAs(const std::filesystem::path& path, const std::vector<Entity>& roots) {
+		std::vector<entt::entity> order{};
+
+		for (const Entity& root : roots) {
+			if (m_Registry.valid(root.GetHandle())) order.push_back(root.GetHandle());
+		}
+
+		// breadth first, so parents are written before their children
+		for (size_t i = 0; i < order.size(); i++) {
+			for (const Entity& child : m_Registry.get<HierarchyComponent>(order[i]).GetChildren()) {
+				if (m_Registry.valid(child.GetHandle())) order.push_back(child.GetHandle());
+			}
+		}
+
+		WriteEntities(path, order);
+	}
+
+	void World::WriteEntities(const std::filesystem::path& path, const std::vector<entt::entity>& order) {
 		BinaryWriteStream stream(path);
 		if (!stream.IsOpen()) {
 			ENGINE_ERROR("Failed to create world file at: {}", path.string());
 			return;
 		}
 
-		stream << m_Entities.size();
-		for (auto& e : m_Entities) {
-			e.GetComponent<TransformComponent>().Serialize(stream);
-			e.GetComponent<HierarchyComponent>().Serialize(stream);
+		std::unordered_map<entt::entity, uint32_t> fileIndices{};
+		for (uint32_t i = 0; i < (uint32_t)order.size(); i++) {
+			fileIndices[order[i]] = i;
+		}
+
+		uint32_t numEntities = (uint32_t)order.size();
+
+		std::vector<uint64_t> assetIDs{};
+		std::unordered_map<uint64_t, uint32_t> assetIndices{};
+
+		auto addAsset = [&](const Asset* asset) {
+			if (!asset) return WORLD_FILE_INVALID_INDEX;
+
+			auto [it, inserted] = assetIndices.try_emplace((uint64_t)asset->GetUUID(), (uint32_t)assetIDs.size());
+			if (inserted) assetIDs.push_back((uint64_t)asset->GetUUID());
+
+			return it->second;
+			};
+
+		std::vector<uint64_t> entityIDs(numEntities);
+		std::vector<Vec3> positions(numEntities), rotations(numEntities), scales(numEntities);
+		std::vector<uint32_t> parents(numEntities), layerMasks(numEntities), nameOffsets(numEntities + 1);
+		std::string names{};
+
+		std::vector<uint32_t> meshEntities{}, meshAssets{}, firstMaterials{}, materialAssets{};
+
+		std::vector<uint32_t> lightEntities{}, lightTypes{};
+		std::vector<Vec4> lightColors{};
+		std::vector<float> lightFloats[7];
+
+		for (uint32_t i = 0; i < numEntities; i++) {
+			entt::entity handle = order[i];
+
+			auto& transform = m_Registry.get<TransformComponent>(handle);
+			auto& hierarchy = m_Registry.get<HierarchyComponent>(handle);
+
+			entityIDs[i] = (uint64_t)hierarchy.GetID();
+
+			positions[i] = transform.GetPosition();
+			rotations[i] = transform.GetRotation();
+			scales[i] = transform.GetScale();
+
+			Entity parent = hierarchy.GetParent();
+			// parents outside of the saved set make the entity a root in the file
+			auto parentIt = parent ? fileIndices.find(parent.GetHandle()) : fileIndices.end();
+			parents[i] = parentIt != fileIndices.end() ? parentIt->second : WORLD_FILE_INVALID_INDEX;
+			layerMasks[i] = hierarchy.GetLayerMask();
+
+			nameOffsets[i] = (uint32_t)names.size();
+			names += hierarchy.GetName();
+
+			if (StaticMeshComponent* mesh = m_Registry.try_get<StaticMeshComponent>(handle)) {
+
+				meshEntities.push_back(i);
+				meshAssets.push_back(addAsset(mesh->GetMesh().Get()));
+				firstMaterials.push_back((uint32_t)materialAssets.size());
+
+				for (const Ref<Material>& mat : mesh->GetMaterials()) {
+					materialAssets.push_back(addAsset(mat.Get()));
+				}
+			}
+
+			if (LightComponent* light = m_Registry.try_get<LightComponent>(handle)) {
+
+				lightEntities.push_back(i);
+				lightTypes.push_back((uint32_t)light->GetType());
+				lightColors.push_back(light->GetColor());
+
+				lightFloats[0].push_back(light->GetIntensity());
+				lightFloats[1].push_back(light->GetRange());
+				lightFloats[2].push_back(light->GetLightConstant());
+				lightFloats[3].push_back(light->GetLightLinear());
+				lightFloats[4].push_back(light->GetLightQuadratic());
+				lightFloats[5].push_back(light->GetInnerConeCos());
+				lightFloats[6].push_back(light->GetOuterConeCos());
+			}
+		}
+
+		nameOffsets[numEntities] = (uint32_t)names.size();
+		firstMaterials.push_back((uint32_t)materialAssets.size());
+
+		std::vector<WorldChunkWriter> chunks{};
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::EEntityIDs, numEntities);
+			chunk.Column(entityIDs);
+		}
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::EAssetIDs, (uint32_t)assetIDs.size());
+			chunk.Column(assetIDs);
+		}
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::ETransform, numEntities);
+			chunk.Column(positions);
+			chunk.Column(rotations);
+			chunk.Column(scales);
+		}
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::EHierarchy, numEntities);
+			chunk.Column(parents);
+			chunk.Column(layerMasks);
+			chunk.Column(nameOffsets);
+			chunk.Column(names.data(), names.size());
+		}
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::EStaticMesh, (uint32_t)meshEntities.size());
+			chunk.Column(meshEntities);
+			chunk.Column(meshAssets);
+			chunk.Column(firstMaterials);
+			chunk.Column(materialAssets);
+		}
+		{
+			WorldChunkWriter& chunk = chunks.emplace_back(EWorldChunkType::ELight, (uint32_t)lightEntities.size());
+			chunk.Column(lightEntities);
+			chunk.Column(lightTypes);
+			chunk.Column(lightColors);
+
+			for (auto& column : lightFloats) {
+				chunk.Column(column);
+			}
+		}
+
+		WorldFileHeader header{};
+		header.Magic = WORLD_FILE_MAGIC;
+		header.Version = WORLD_FILE_VERSION;
+		header.NumEntities = numEntities;
+		header.NumChunks = (uint32_t)chunks.size();
+
+		size_t tableSize = sizeof(WorldFileHeader) + sizeof(WorldChunkDesc) * chunks.size();
+		uint64_t offset = WorldChunkWriter::AlignUp(tableSize);
+
+		std::vector<uint8_t> table(offset, 0);
+		memcpy(table.data(), &header, sizeof(WorldFileHeader));
+
+		for (size_t i = 0; i < chunks.size(); i++) {
+
+			WorldChunkDesc desc{};
+			desc.Type = chunks[i].GetType();
+			desc.Count = chunks[i].GetCount();
+			desc.Offset = offset;
+			desc.Size = chunks[i].GetData().size();
 
+			memcpy(table.data() + sizeof(WorldFileHeader) + sizeof(WorldChunkDesc) * i, &desc, sizeof(WorldChunkDesc));
+			offset += desc.Size;
+		}
 
+		stream.WriteRaw(table.data(), table.size());
+		for (const WorldChunkWriter& chunk : chunks) {
+			stream.WriteRaw(chunk.GetData().data(), chunk.GetData().size());
 		}
 	}
 
-	Ref<World> World::Create(BinaryReadStream& stream) {
-		Ref<World> w = CreateRef<World>();
-		s_Current = w.Get();
-		return w;
+	void World::Tick(float deltaTime) {
+		FlushDestroyedEntities();
+
+		// systems on workers can move entities, dirty lists are locked meanwhile
+		m_RunningSystems = true;
+		m_Systems.Run(deltaTime);
+		m_RunningSystems = false;
+
+		UpdateTransforms();
+		UpdateSpatialIndex();
+	}
+
+	void World::MarkTransformDirty(Entity entity) {
+		if (m_RunningSystems) {
+			std::lock_guard<std::mutex> lock(m_DirtyMutex);
+			m_DirtyTransforms.push_back(entity.GetHandle());
+		}
+		else {
+			m_DirtyTransforms.push_back(entity.GetHandle());
+		}
+	}
+
+	void World::UpdateTransforms() {
+		if (m_DirtyTransforms.empty()) return;
+
+		struct LightUpdate {
+			LightProxy* Proxy;
+			Vec3 Position;
+			Vec3 Direction;
+		};
+
+		m_WorldChanged.assign(m_Transforms.GetCapacity(), 0);
+
+		std::vector<uint32_t> dirtySlots{};
+		uint32_t minDepth = UINT32_MAX;
+
+		for (entt::entity handle : m_DirtyTransforms) {
+			if (!m_Registry.valid(handle)) continue;
+
+			auto& transform = m_Registry.get<TransformComponent>(handle);
+			if (!transform.m_Dirty) continue;
+
+			transform.m_Dirty = false;
+			dirtySlots.push_back(transform.m_Slot);
+			m_WorldChanged[transform.m_Slot] = 1;
+
+			minDepth = std::min(minDepth, m_Registry.get<HierarchyComponent>(handle).m_Depth);
+		}
+
+		m_DirtyTransforms.clear();
+		if (dirtySlots.empty()) return;
+
+		const uint32_t composeBatch = 1024;
+		const uint32_t levelBatch = 256;
+
+		GJobSystem->ParallelFor((uint32_t)dirtySlots.size(), composeBatch, [&](uint32_t first, uint32_t last) {
+			SimdMath::ComposeTRS(m_Transforms.GetSoA(), dirtySlots.data() + first, last - first, m_Transforms.GetLocals());
+			});
+
+		// levels above the shallowest dirty entity can't change
+		for (uint32_t depth = minDepth; depth < (uint32_t)m_HierarchyLevels.size(); depth++) {
+			HierarchyLevel& level = m_HierarchyLevels[depth];
+
+			GJobSystem->ParallelFor((uint32_t)level.Slots.size(), levelBatch, [&](uint32_t first, uint32_t last) {
+				uint32_t slots[levelBatch];
+				uint32_t parents[levelBatch];
+				uint32_t count = 0;
+
+				auto flush = [&]() {
+					SimdMath::MultiplyByParents(m_Transforms.GetWorlds(), m_Transforms.GetLocals(), slots, parents, count);
+					count = 0;
+				};
+
+				for (uint32_t i = first; i < last; i++) {
+					uint32_t slot = level.Slots[i];
+					uint32_t parent = level.ParentSlots[i];
+
+					if (!m_WorldChanged[slot] && (parent == TransformStore::INVALID_SLOT || !m_WorldChanged[parent])) continue;
+
+					m_WorldChanged[slot] = 1;
+					slots[count] = slot;
+					parents[count] = parent;
+
+					if (++count == levelBatch) flush();
+				}
+				flush();
+				});
+		}
+
+		std::vector<StaticMeshProxy*> meshProxies{};
+		std::vector<Mat4x4> meshTransforms{};
+		std::vector<LightUpdate> lightUpdates{};
+
+		for (uint32_t depth = minDepth; depth < (uint32_t)m_HierarchyLevels.size(); depth++) {
+			HierarchyLevel& level = m_HierarchyLevels[depth];
+
+			for (uint32_t i = 0; i < (uint32_t)level.Slots.size(); i++) {
+				uint32_t slot = level.Slots[i];
+				if (!m_WorldChanged[slot]) continue;
+
+				entt::entity handle = level.Entities[i];
+				const Mat4x4& world = m_Transforms.GetWorld(slot);
+
+				if (StaticMeshComponent* mesh = m_Registry.try_get<StaticMeshComponent>(handle)) {
+					meshProxies.push_back(mesh->GetProxy());
+					meshTransforms.push_back(world);
+					m_DirtyBounds.push_back(handle);
+				}
+				if (LightComponent* light = m_Registry.try_get<LightComponent>(handle)) {
+					lightUpdates.push_back(LightUpdate{ light->GetProxy(), Vec3(world[3]), LightComponent::GetWorldDirection(world) });
+					m_DirtyBounds.push_back(handle);
+				}
+			}
+		}
+
+		if (meshProxies.empty() && lightUpdates.empty()) return;
+
+		GFrameRenderer->SubmitToFrameQueue([meshProxies = std::move(meshProxies), meshTransforms = std::move(meshTransforms),
+			lightUpdates = std::move(lightUpdates)]() {
+
+			// every proxy owns its own object buffer entries, so they are written straight from the workers
+			const uint32_t meshBatch = 256;
+			GJobSystem->ParallelFor((uint32_t)meshProxies.size(), meshBatch, [&](uint32_t first, uint32_t last) {
+				for (uint32_t i = first; i < last; i++) {
+					meshProxies[i]->OnTransformChange(meshTransforms[i]);
+				}
+				});
+
+			for (const LightUpdate& update : lightUpdates) {
+				update.Proxy->SetPosition(update.Position);
+				update.Proxy->SetDirection(update.Direction);
+			}
+			});
+	}
+
+	void World::MarkBoundsDirty(Entity entity) {
+		if (m_RunningSystems) {
+			std::lock_guard<std::mutex> lock(m_DirtyMutex);
+			m_DirtyBounds.push_back(entity.GetHandle());
+		}
+		else {
+			m_DirtyBounds.push_back(entity.GetHandle());
+		}
+	}
+
+	bool World::HasBounds(entt::entity handle) const {
+		const StaticMeshComponent* mesh = m_Registry.try_get<StaticMeshComponent>(handle);
+		const LightComponent* light = m_Registry.try_get<LightComponent>(handle);
+
+		return (mesh && mesh->GetMesh().Valid()) || (light && light->GetType() != ELightType::ENone);
+	}
+
+	AABB World::ComputeBounds(entt::entity handle) const {
+		const Mat4x4& world = m_Transforms.GetWorld(m_Registry.get<TransformComponent>(handle).m_Slot);
+		AABB bounds{};
+
+		if (const StaticMeshComponent* mesh = m_Registry.try_get<StaticMeshComponent>(handle); mesh && mesh->GetMesh().Valid()) {
+			RHIMesh* resource = mesh->GetMesh()->GetResource();
+
+			// bounding sphere of the mesh, scaled by the largest axis
+			Vec3 center = Vec3(world * Vec4(resource->GetBoundsOrigin(), 1.f));
+			float scale = std::max(std::max(glm::length(Vec3(world[0])), glm::length(Vec3(world[1]))), glm::length(Vec3(world[2])));
+
+			bounds.Extend(AABB::FromSphere(center, resource->GetBoundsRadius() * scale));
+		}
+
+		if (const LightComponent* light = m_Registry.try_get<LightComponent>(handle); light && light->GetType() != ELightType::ENone) {
+			bounds.Extend(AABB::FromSphere(Vec3(world[3]), light->GetRange()));
+		}
+
+		return bounds;
+	}
+
+	void World::UpdateSpatialIndex() {
+
+		if (!m_DirtyBounds.empty()) {
+			std::sort(m_DirtyBounds.begin(), m_DirtyBounds.end());
+			m_DirtyBounds.erase(std::unique(m_DirtyBounds.begin(), m_DirtyBounds.end()), m_DirtyBounds.end());
+
+			// proxies are added and removed first, bounds of the rest are then computed on workers
+			std::vector<std::pair<entt::entity, uint32_t>> updates{};
+			updates.reserve(m_DirtyBounds.size());
+
+			for (entt::entity handle : m_DirtyBounds) {
+				if (!m_Registry.valid(handle)) continue;
+
+				uint32_t idx = (uint32_t)entt::to_entity(handle);
+				if (idx >= m_SpatialProxies.size()) m_SpatialProxies.resize(idx + 1, DynamicBVH::INVALID_PROXY);
+
+				uint32_t& proxy = m_SpatialProxies[idx];
+
+				if (!HasBounds(handle)) {
+					if (proxy != DynamicBVH::INVALID_PROXY) m_SpatialIndex.Remove(proxy);
+
+					proxy = DynamicBVH::INVALID_PROXY;
+					continue;
+				}
+
+				if (proxy == DynamicBVH::INVALID_PROXY) proxy = m_SpatialIndex.Insert(AABB(), (uint32_t)handle);
+				updates.emplace_back(handle, proxy);
+			}
+
+			m_DirtyBounds.clear();
+
+			const uint32_t boundsBatch = 512;
+			GJobSystem->ParallelFor((uint32_t)updates.size(), boundsBatch, [&](uint32_t first, uint32_t last) {
+				for (uint32_t i = first; i < last; i++) {
+					m_SpatialIndex.SetBounds(updates[i].second, ComputeBounds(updates[i].first));
+				}
+				});
+
+			m_SpatialIndex.MarkMoved();
+		}
+
+		m_SpatialIndex.Refit();
+	}
+
+	uint32_t World::RegisterSystem(const SystemDesc& desc, SystemScheduler::SystemFunc&& func) {
+		return m_Systems.Add(desc, std::move(func), this, m_Registry);
+	}
+
+	void World::UnregisterSystem(uint32_t id) {
+		m_Systems.Remove(id);
+	}
+
+	Entity World::GetEntityByID(UUID id) const {
+		const entt::entity* handle = m_EntityMap.Find(id);
+		return handle ? Entity(const_cast<World*>(this), *handle) : Entity();
+	}
+
+	EntityRef::EntityRef(Entity entity) : m_ID(0), m_Handle(entt::null) {
+		if (entity) {
+			m_ID = entity.GetComponent<HierarchyComponent>().GetID();
+			m_Handle = entity.GetHandle();
+		}
+	}
+
+	Entity EntityRef::Resolve(World* world) const {
+		if (!m_ID) return Entity();
+
+		// the generation check of the handle catches destroyed entities, the id catches handles from another world
+		if (m_Handle != entt::null && world->IsEntityValid(m_Handle) && world->EntityHasComponent<HierarchyComponent>(m_Handle)
+			&& world->GetEntityComponent<HierarchyComponent>(m_Handle).GetID() == m_ID) {
+			return Entity(world, m_Handle);
+		}
+
+		Entity entity = world->GetEntityByID(m_ID);
+		m_Handle = entity.GetHandle();
+
+		return entity;
+	}
+
+	Entity World::RaycastBounds(const Ray& ray, float maxDistance, float* outDistance) {
+		uint32_t userData;
+		float distance;
+
+		if (!m_SpatialIndex.Raycast(ray, maxDistance, userData, distance)) return Entity();
+
+		if (outDistance) *outDistance = distance;
+		return Entity(this, (entt::entity)userData);
+	}
+
+	void World::InsertIntoLevel(Entity entity, uint32_t depth) {
+		auto& hierarchy = entity.GetComponent<HierarchyComponent>();
+
+		if (m_HierarchyLevels.size() <= depth) {
+			m_HierarchyLevels.resize(depth + 1);
+		}
+
+		HierarchyLevel& level = m_HierarchyLevels[depth];
+		Entity parent = hierarchy.GetParent();
+
+		hierarchy.m_Depth = depth;
+		hierarchy.m_LevelIndex = (uint32_t)level.Entities.size();
+
+		level.Entities.push_back(entity.GetHandle());
+		level.Slots.push_back(entity.GetComponent<TransformComponent>().m_Slot);
+		level.ParentSlots.push_back(parent ? parent.GetComponent<TransformComponent>().m_Slot : TransformStore::INVALID_SLOT);
+	}
+
+	void World::RemoveFromLevel(Entity entity) {
+		auto& hierarchy = entity.GetComponent<HierarchyComponent>();
+		if (hierarchy.m_LevelIndex == UINT32_MAX) return;
+
+		HierarchyLevel& level = m_HierarchyLevels[hierarchy.m_Depth];
+		uint32_t idx = hierarchy.m_LevelIndex;
+
+		// swap with the last entry, and fix up its index
+		if (idx != (uint32_t)level.Entities.size() - 1) {
+			entt::entity moved = level.Entities.back();
+			m_Registry.get<HierarchyComponent>(moved).m_LevelIndex = idx;
+		}
+
+		SwapDelete(level.Entities, idx);
+		SwapDelete(level.Slots, idx);
+		SwapDelete(level.ParentSlots, idx);
+
+		hierarchy.m_LevelIndex = UINT32_MAX;
+	}
+
+	void World::UpdateHierarchyLevel(Entity entity) {
+		std::vector<Entity> stack{ entity };
+
+		while (!stack.empty()) {
+			Entity current = stack.back();
+			stack.pop_back();
+
+			auto& hierarchy = current.GetComponent<HierarchyComponent>();
+			Entity parent = hierarchy.GetParent();
+
+			RemoveFromLevel(current);
+			InsertIntoLevel(current, parent ? parent.GetComponent<HierarchyComponent>().m_Depth + 1 : 0);
+
+			for (const Entity& child : hierarchy.GetChildren()) {
+				stack.push_back(child);
+			}
+		}
+	}
+
+	std::vector<World::ComponentCloneFunc>& World::GetComponentCloners() {
+		static std::vector<ComponentCloneFunc> cloners{};
+		return cloners;
 	}
 
-	void World::Tick() {
+	Ref<World> World::Clone() {
+		Ref<World> clone = World::Create();
+		World* dst = clone.Get();
 
-		// tick the world
+		// same handles in the copy, so everything indexed by them is copied as is
+		const auto& entities = m_Registry.storage<entt::entity>();
+		dst->m_Registry.storage<entt::entity>().reserve(entities.size());
+
+		for (auto [handle] : entities.each()) {
+			(void)dst->m_Registry.create(handle);
+		}
+
+		dst->m_Transforms.CopyFrom(m_Transforms);
+
+		auto copyPool = [&]<typename T>(const entt::storage<T>& pool) {
+			auto& dstPool = dst->m_Registry.storage<T>();
+			dstPool.reserve(pool.size());
+
+			for (auto [handle, component] : pool.each()) {
+				dstPool.emplace(handle, Entity(dst, handle), component);
+			}
+			};
+
+		copyPool(m_Registry.storage<TransformComponent>());
+		copyPool(m_Registry.storage<StaticMeshComponent>());
+		copyPool(m_Registry.storage<LightComponent>());
+
+		// the owner goes along separately
 		{
+			auto& dstPool = dst->m_Registry.storage<HierarchyComponent>();
+			dstPool.reserve(m_Registry.storage<HierarchyComponent>().size());
+
+			for (auto [handle, hierarchy] : m_Registry.storage<HierarchyComponent>().each()) {
+				dstPool.emplace(handle, Entity(dst, handle), hierarchy, dst);
+			}
+		}
+
+		for (ComponentCloneFunc cloner : GetComponentCloners()) {
+			cloner(m_Registry, dst->m_Registry, dst);
+		}
+
+		auto remap = [dst](std::vector<Entity>& list) {
+			for (Entity& entity : list) {
+				entity = Entity(dst, entity.GetHandle());
+			}
+			};
+
+		dst->m_RootEntities = m_RootEntities;
+		dst->m_Entities = m_Entities;
+		remap(dst->m_RootEntities);
+		remap(dst->m_Entities);
+
+		dst->m_HierarchyLevels = m_HierarchyLevels;
+		dst->m_DirtyTransforms = m_DirtyTransforms;
+		dst->m_EntityMap = m_EntityMap;
+
+		dst->m_SpatialIndex = m_SpatialIndex;
+		dst->m_SpatialProxies = m_SpatialProxies;
+		dst->m_DirtyBounds = m_DirtyBounds;
+
+		dst->m_PendingDestroy = m_PendingDestroy;
+		dst->m_DestroyFlags = m_DestroyFlags;
+
+		// proxies of both worlds live on the render thread, records are copied there once everything queued so far ran
+		std::vector<std::pair<const StaticMeshProxy*, StaticMeshProxy*>> meshProxies{};
+		meshProxies.reserve(dst->m_Registry.storage<StaticMeshComponent>().size());
+
+		for (auto [handle, mesh] : dst->m_Registry.storage<StaticMeshComponent>().each()) {
+			meshProxies.emplace_back(m_Registry.get<StaticMeshComponent>(handle).m_Proxy, mesh.m_Proxy);
+		}
+
+		std::vector<std::pair<const LightProxy*, LightProxy*>> lightProxies{};
+		lightProxies.reserve(dst->m_Registry.storage<LightComponent>().size());
 
+		for (auto [handle, light] : dst->m_Registry.storage<LightComponent>().each()) {
+			lightProxies.emplace_back(m_Registry.get<LightComponent>(handle).m_Proxy, light.m_Proxy);
 		}
+
+		GFrameRenderer->SubmitToFrameQueue([src = m_Proxy, dstProxy = dst->m_Proxy, meshProxies = std::move(meshProxies), lightProxies = std::move(lightProxies)]() {
+			dstProxy->CopyRecordsFrom(*src);
+
+			for (auto& [source, copy] : meshProxies) {
+				copy->CopyRecords(*source);
+			}
+
+			for (auto& [source, copy] : lightProxies) {
+				copy->CopyRecords(*source);
+			}
+			});
+
+		return clone;
 	}
 
 	Entity World::CreateEntity(const std::string& name) {
@@ -128,8 +1251,11 @@ namespace Spike {
 		Entity entt(this, handle);
 
 		entt.AddComponent<TransformComponent>();
-		auto& h = entt.AddComponent<HierarchyComponent>(this);
+		auto& h = entt.AddComponent<HierarchyComponent>(UUID::Generate(), this);
 		h.SetName(name);
+		m_EntityMap.Insert(h.GetID(), handle);
+
+		InsertIntoLevel(entt, 0);
 
 		m_Entities.push_back(entt);
 		m_RootEntities.push_back(entt);
@@ -138,7 +1264,115 @@ namespace Spike {
 	}
 
 	void World::DestroyEntity(Entity entity) {
-		m_Registry.destroy(entity.GetHandle());
+		QueueDestroy(entity.GetHandle());
+	}
+
+	void World::DestroyEntities(const std::vector<entt::entity>& handles) {
+		m_PendingDestroy.reserve(m_PendingDestroy.size() + handles.size());
+
+		for (entt::entity handle : handles) {
+			QueueDestroy(handle);
+		}
+	}
+
+	void World::QueueDestroy(entt::entity handle) {
+		std::vector<entt::entity> stack{ handle };
+
+		while (!stack.empty()) {
+			entt::entity current = stack.back();
+			stack.pop_back();
+
+			if (!m_Registry.valid(current)) continue;
+
+			uint32_t idx = (uint32_t)entt::to_entity(current);
+			if (idx >= m_DestroyFlags.size()) m_DestroyFlags.resize(idx + 1, 0);
+
+			// already queued together with its subtree
+			if (m_DestroyFlags[idx]) continue;
+
+			m_DestroyFlags[idx] = 1;
+			m_PendingDestroy.push_back(current);
+
+			// entities loaded in steps can still be missing their components
+			if (auto* hierarchy = m_Registry.try_get<HierarchyComponent>(current)) {
+
+				// only if the id wasn't taken over by a duplicate that failed to register
+				if (const entt::entity* mapped = m_EntityMap.Find(hierarchy->GetID()); mapped && *mapped == current) {
+					m_EntityMap.Remove(hierarchy->GetID());
+				}
+
+				for (const Entity& child : hierarchy->m_Children) {
+					stack.push_back(child.GetHandle());
+				}
+			}
+		}
+	}
+
+	void World::FlushDestroyedEntities() {
+		if (m_PendingDestroy.empty()) return;
+
+		auto isQueued = [this](entt::entity handle) {
+			uint32_t idx = (uint32_t)entt::to_entity(handle);
+			return idx < m_DestroyFlags.size() && m_DestroyFlags[idx];
+			};
+
+		std::vector<StaticMeshProxy*> meshProxies{};
+		std::vector<LightProxy*> lightProxies{};
+
+		for (entt::entity handle : m_PendingDestroy) {
+			Entity entity(this, handle);
+
+			if (auto* hierarchy = m_Registry.try_get<HierarchyComponent>(handle)) {
+
+				// queued parents go away as a whole, only surviving ones need their children fixed up
+				if (Entity parent = hierarchy->m_Parent; parent && !isQueued(parent.GetHandle())) {
+					auto& children = m_Registry.get<HierarchyComponent>(parent.GetHandle()).m_Children;
+
+					for (uint32_t i = 0; i < (uint32_t)children.size(); i++) {
+						if (children[i] == entity) {
+							SwapDelete(children, i);
+							break;
+						}
+					}
+				}
+
+				RemoveFromLevel(entity);
+			}
+
+			uint32_t idx = (uint32_t)entt::to_entity(handle);
+			if (idx < m_SpatialProxies.size() && m_SpatialProxies[idx] != DynamicBVH::INVALID_PROXY) {
+				m_SpatialIndex.Remove(m_SpatialProxies[idx]);
+				m_SpatialProxies[idx] = DynamicBVH::INVALID_PROXY;
+			}
+
+			// taken from the components, so their destructors don't submit one release each
+			if (auto* mesh = m_Registry.try_get<StaticMeshComponent>(handle)) {
+				meshProxies.push_back(mesh->m_Proxy);
+				mesh->m_Proxy = nullptr;
+			}
+
+			if (auto* light = m_Registry.try_get<LightComponent>(handle)) {
+				lightProxies.push_back(light->m_Proxy);
+				light->m_Proxy = nullptr;
+			}
+		}
+
+		std::erase_if(m_RootEntities, [&](const Entity& entity) { return isQueued(entity.GetHandle()); });
+		std::erase_if(m_Entities, [&](const Entity& entity) { return isQueued(entity.GetHandle()); });
+
+		if (!meshProxies.empty() || !lightProxies.empty()) {
+			GFrameRenderer->SubmitToFrameQueue([proxy = m_Proxy, meshProxies = std::move(meshProxies), lightProxies = std::move(lightProxies)]() {
+				proxy->MeshProxyPool.Release(meshProxies.data(), meshProxies.size());
+				proxy->LightProxyPool.Release(lightProxies.data(), lightProxies.size());
+				});
+		}
+
+		for (entt::entity handle : m_PendingDestroy) {
+			m_DestroyFlags[(uint32_t)entt::to_entity(handle)] = 0;
+		}
+
+		m_Registry.destroy(m_PendingDestroy.begin(), m_PendingDestroy.end());
+		m_PendingDestroy.clear();
 	}
 
 	void World::SetEntityRoot(Entity entity) {
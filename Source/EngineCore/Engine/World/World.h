@@ -3,27 +3,57 @@
 #include <entt/entt.hpp>
 #include <Engine/Utils/MathUtils.h>
 #include <Engine/Renderer/Shader.h>
+#include <Engine/Renderer/Mesh.h>
 #include <Engine/Asset/UUID.h>
+#include <Engine/World/TransformStore.h>
+#include <Engine/World/DynamicBVH.h>
+#include <Engine/World/WorldSystem.h>
 
 namespace Spike {
 
+	// one per drawn submesh, everything shared with other instances lives in the group
 	struct alignas(16) ObjectGPUData {
 
-		Vec4 BoundsOrigin; // w - bounds radius
+		// rows of the world transform, the last one is always (0, 0, 0, 1)
+		Vec4 TransformRows[3];
+
+		uint32_t GroupIndex;
+		uint32_t VisibilityIdx;
+
+		// layers of the entity, views only draw instances sharing a layer with their mask
+		uint32_t LayerMask;
+
+		// first word of the instance's meshlet visibility bits, for groups drawn by meshlets
+		uint32_t MeshletVisibilityOffset;
+	};
 
-		Mat4x4 GlobalTransform;
-		Mat4x4 InverseTransform;
+	// instances of the same submesh and material, drawn with a single indirect command
+	struct alignas(16) InstanceGroupGPUData {
 
-		uint32_t FirstIndex;
-		uint32_t IndexCount;
+		Vec4 BoundsOrigin; // w - bounds radius
 
 		uint64_t IndexBufferAddress;
 		uint64_t VertexBufferAddress;
 
+		// index ranges from the finest to the coarsest lod, errors are relative to the bounds radius
+		uint32_t LodFirstIndex[MESH_MAX_LODS];
+		uint32_t LodIndexCount[MESH_MAX_LODS];
+		float LodErrors[MESH_MAX_LODS];
+		uint32_t LodCount;
+
 		uint32_t MaterialBufferIndex;
 		uint32_t DrawBatchID;
 
-		uint32_t VisibilityIdx;
+		// visible instances of the group are compacted into the visible instance buffer from this offset,
+		// split between the lods they're drawn with
+		uint32_t InstanceOffset;
+		uint32_t InstanceCount;
+
+		// meshlets of the submesh, the finest lod of groups with any is drawn by them
+		uint32_t MeshletCount;
+		uint64_t MeshletBufferAddress;
+		// only for shaders culling back faces, cones say nothing about the back side, one of MESHLET_CONES_*
+		uint32_t MeshletConeCulling;
 		float Padding0[3];
 	};
 
@@ -65,28 +95,97 @@ namespace Spike {
 
 		uint32_t LightsCount;
 		uint32_t ObjectsCount;
+		uint32_t GroupsCount;
 
-		float Padding0[5];
+		float Padding0[4];
+	};
+
+	// a view of the shared cull pass, every view culls into its own slice of the per view buffers
+	struct alignas(16) ViewCullGPUData {
+
+		Mat4x4 View;
+		Vec4 CameraPos;
+		Vec4 FrustumPlanes[6];
+
+		float P00;
+		float P11;
+		float CullZNear;
+		// projected lod errors are scaled by it into pixels over the allowed error
+		float LodErrorScale;
+
+		uint32_t PyramidSize;
+		uint32_t ViewMask;
+		// slice of the per view buffers
+		uint32_t ViewIndex;
+		float Padding0;
 	};
 
-	constexpr uint32_t MAX_DRAW_OBJECTS_PER_WORLD = 200000;
-	constexpr uint32_t MAX_LIGHTS_PER_WORLD = 5000;
+	// scene buffers grow and shrink in pages of records, small worlds stay at a single page
+	constexpr uint32_t OBJECTS_PAGE_SIZE = 1024;
+	constexpr uint32_t GROUPS_PAGE_SIZE = 256;
+	constexpr uint32_t LIGHTS_PAGE_SIZE = 64;
 	constexpr uint32_t MAX_SHADERS_PER_WORLD = 100;
 
+	// draw counts of a view, one per batch for whole draws followed by one per batch for meshlet draws
+	constexpr uint32_t VIEW_DRAW_COUNTS = MAX_SHADERS_PER_WORLD * 2;
+	constexpr uint32_t INVALID_MESHLET_VISIBILITY = UINT32_MAX;
+
+	// meshlet cones are built from counter clockwise triangles in mesh space
+	// the projection flips y, so clockwise front faces on screen match them and counter clockwise ones mirror them
+	constexpr uint32_t MESHLET_CONES_OFF = 0;
+	constexpr uint32_t MESHLET_CONES_FRONT = 1;
+	constexpr uint32_t MESHLET_CONES_MIRRORED = 2;
+
+	// views rendered from a world in one frame, they share the cull pass
+	constexpr uint32_t MAX_RENDER_VIEWS = 4;
+
+	// entities without any layer are in the default one, views see every layer unless asked otherwise
+	constexpr uint32_t DEFAULT_LAYER_MASK = 1u;
+	constexpr uint32_t ALL_LAYERS_MASK = UINT32_MAX;
+
+	// draws of every instance group using the shader, empty batches have no shader and are skipped
 	struct WorldDrawBatch {
 
+		// groups drawn with the shader, each has room for a command per lod, the batch is freed with its last group
 		uint32_t CommandsCount;
+		// first command of the batch in the draw commands buffer
+		uint32_t CommandOffset;
 		RHIShader* Shader;
+
+		// meshlets of every instance of the batch's meshlet groups, a command each at most
+		uint32_t MeshletCommandsCount;
+		// first command of the batch in the meshlet commands buffer
+		uint32_t MeshletCommandOffset;
 	};
 
+	class RHICommandBuffer;
+	class RHIMaterial;
+	class StaticMeshProxy;
+	class LightProxy;
+
 	class RHIWorldProxy : public RHIResource {
 	public:
 		RHIWorldProxy();
-		virtual ~RHIWorldProxy() override {};
+		virtual ~RHIWorldProxy() override;
 
 		virtual void InitRHI() override;
 		virtual void ReleaseRHI() override;
 
+		// resizes the scene buffers to their records and uploads records changed since the last call,
+		// does nothing for unchanged scenes
+		void UploadDirtyData(RHICommandBuffer* cmd);
+
+		// views rendered this frame, applied to the per view buffers by the next upload
+		void SetNumViews(uint32_t numViews);
+
+		// bulk copy of every record of another world proxy, render thread only
+		// component proxies of the copy take their indices from the source ones afterwards
+		void CopyRecordsFrom(const RHIWorldProxy& other);
+
+		// group of the submesh and material pair, created with the first instance and freed with the last one
+		uint32_t AcquireInstanceGroup(RHIMesh* mesh, uint32_t subMesh, RHIMaterial* material);
+		void ReleaseInstanceGroup(uint32_t group);
+
 	public:
 		struct {
 			Vec3 Direction{};
@@ -97,14 +196,106 @@ namespace Spike {
 		RHIBuffer* DrawCommandsBuffer;
 		RHIBuffer* DrawCountsBuffer;
 		RHIBuffer* VisibilityBuffer;
+		// gpu only, written by the scatter pass
 		RHIBuffer* ObjectsBuffer;
+		RHIBuffer* GroupsBuffer;
 		RHIBuffer* LightsBuffer;
 
+		// written by the cull pass, visible instances per group and lod and their compacted object offsets,
+		// slots keep the lod and place of every visible instance until the offsets of the lods are known
+		RHIBuffer* GroupCountsBuffer;
+		RHIBuffer* VisibleInstancesBuffer;
+		RHIBuffer* InstanceSlotsBuffer;
+
+		// meshlet cull stage, visible slots of the instances drawn by meshlets and the indirect dispatch over them,
+		// commands of the visible meshlets, and a visibility bit per meshlet of every instance kept between frames
+		RHIBuffer* MeshletQueueBuffer;
+		RHIBuffer* MeshletDispatchBuffer;
+		RHIBuffer* MeshletCommandsBuffer;
+		RHIBuffer* MeshletVisibilityBuffer;
+
+		// draw commands and counts, visibility and the buffers written by the cull pass hold a slice per view,
+		// these are the sizes of a single slice in records, visibility of a view is kept while its index is
+		uint32_t NumViews;
+		uint32_t ViewInstancesStride;
+		uint32_t ViewGroupLodsStride;
+		uint32_t ViewVisibilityStride;
+		uint32_t ViewMeshletCommandsStride;
+		uint32_t ViewMeshletVisibilityStride;
+
+		// cpu copies of the buffers above, writes are tracked and uploaded per record
 		DenseBuffer<ObjectGPUData> ObjectsVB;
 		DenseBuffer<LightGPUData> LightsVB;
 
+		// groups are never popped, so a group index is its offset in the gpu buffer,
+		// freed groups are left without instances and reused
+		DenseBuffer<InstanceGroupGPUData> GroupsVB;
+
+		// kept compact between frames, commands of the batches follow each other in their order
 		std::vector<WorldDrawBatch> Batches;
 		IndexQueue VisibilityQueue;
+		// words of the meshlet visibility buffer, a run per instance of a meshlet group
+		RangeQueue MeshletVisibilityQueue;
+
+		// component proxies are allocated on the main thread and released on the render thread
+		ObjectPool<StaticMeshProxy> MeshProxyPool;
+		ObjectPool<LightProxy> LightProxyPool;
+
+	private:
+		template<typename T>
+		void ScatterDirtyRecords(RHICommandBuffer* cmd, DenseBuffer<T>& records, RHIBuffer* dst);
+
+		// gpu buffers follow the capacity of the cpu records, kept contents are copied on the gpu
+		void ResizeSceneBuffers(RHICommandBuffer* cmd);
+
+		// lays out the visible instance ranges of the groups after their instance counts changed
+		void UpdateInstanceOffsets();
+
+		// meshlet command ranges of the batches follow their instance counts
+		void UpdateMeshletCommandOffsets();
+
+		uint32_t FindBatch(RHIShader* shader);
+		void RemoveFromBatch(uint32_t idx);
+
+		// moves live batches over the freed ones and points their groups at the new slots
+		void CompactBatches();
+		void UpdateBatchOffsets();
+
+	private:
+		struct InstanceGroupKey {
+			RHIMesh* Mesh;
+			uint32_t SubMesh;
+			RHIMaterial* Material;
+
+			bool operator==(const InstanceGroupKey& other) const = default;
+		};
+
+		struct InstanceGroupKeyHash {
+			size_t operator()(const InstanceGroupKey& key) const {
+				size_t hash = std::hash<void*>()(key.Mesh);
+				hash ^= std::hash<void*>()(key.Material) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				hash ^= std::hash<uint32_t>()(key.SubMesh) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		};
+
+		struct InstanceGroup {
+			InstanceGroupKey Key;
+			uint32_t NumInstances;
+		};
+
+		std::unordered_map<InstanceGroupKey, uint32_t, InstanceGroupKeyHash> m_GroupLookup;
+		std::vector<InstanceGroup> m_Groups;
+		std::vector<uint32_t> m_FreeGroups;
+		bool m_GroupCountsChanged;
+
+		std::unordered_map<RHIShader*, uint32_t> m_BatchLookup;
+		std::vector<uint32_t> m_FreeBatches;
+		bool m_BatchCountsChanged;
+		uint32_t m_MeshletCommandsCount;
+
+		std::vector<uint32_t> m_DirtyOffsets;
+		RHIShader* m_ScatterShader;
 	};
 
 	class Entity;
@@ -114,17 +305,67 @@ namespace Spike {
 		World();
 		~World();
 
-		void Tick();
+		// destroys queued entities, runs systems, then updates transforms and the spatial index
+		void Tick(float deltaTime = 0.f);
 		RHIWorldProxy* GetProxy() { return m_Proxy; }
 
-		static Ref<World> Create(BinaryReadStream& stream);
+		static Ref<World> Create();
+
+		// maps the file and builds all components in bulk, returns nullptr if the file is missing or invalid
+		static Ref<World> Create(const std::filesystem::path& path);
+		static Ref<World> Create(const uint8_t* data, size_t size);
+
+		// copy of the world with the same entity handles and ids, like for play in editor,
+		// pools are copied in bulk and gpu records are copied on the render thread, systems aren't copied
+		Ref<World> Clone();
+
+		// components the world doesn't know are copied only if registered,
+		// uses T(Entity, const T&) if there is one, so the copy can point at its new world
+		template<typename T>
+		static void RegisterClonableComponent();
+
+		// see WorldFormat.h for the layout
 		void SaveAs(const std::filesystem::path& path);
 
+		// writes only the given entities with their subtrees, used to split worlds into streamed cells
+		void SaveAs(const std::filesystem::path& path, const std::vector<Entity>& roots);
+
 		Entity CreateEntity(const std::string& name = "New Entity");
+
+		// the entity and its subtree are queued and destroyed in one batch at the start of the next tick,
+		// they stay valid until then, but can no longer be found by id
 		void DestroyEntity(Entity entity);
+		void DestroyEntities(const std::vector<entt::entity>& handles);
 		void SetEntityRoot(Entity entity);
 		void UnSetEntityRoot(Entity entity);
 
+		const std::vector<Entity>& GetRootEntities() const { return m_RootEntities; }
+
+		// null entity if no entity has the id
+		Entity GetEntityByID(UUID id) const;
+		bool IsEntityValid(entt::entity handle) const { return m_Registry.valid(handle); }
+
+		// systems run every tick in registration order, as far as their declared component access allows,
+		// systems that don't conflict run in parallel on workers
+		uint32_t RegisterSystem(const SystemDesc& desc, SystemScheduler::SystemFunc&& func);
+		void UnregisterSystem(uint32_t id);
+
+		void MarkTransformDirty(Entity entity);
+		TransformStore& GetTransformStore() { return m_Transforms; }
+
+		// puts the entity and its subtree into the levels matching their current depth
+		void UpdateHierarchyLevel(Entity entity);
+
+		// world space bounds of meshes and lights, user data is the entity handle
+		// updated once per frame after transforms, queries see the state of the last tick
+		const DynamicBVH& GetSpatialIndex() const { return m_SpatialIndex; }
+
+		// recomputes the entity's bounds on the next tick, for changes that don't move the entity
+		void MarkBoundsDirty(Entity entity);
+
+		// closest entity whose bounds are hit by the ray
+		Entity RaycastBounds(const Ray& ray, float maxDistance, float* outDistance = nullptr);
+
 		template<typename T, typename... Args>
 		T& RegisterEntityComponent(entt::entity handle, Args&&... args) {
 			return m_Registry.emplace<T>(handle, std::forward<Args>(args)...);
@@ -148,12 +389,71 @@ namespace Spike {
 
 		ASSET_CLASS_TYPE(EAssetType::EWorld)
 	private:
+		using ComponentCloneFunc = void(*)(const entt::registry& src, entt::registry& dst, World* dstWorld);
+		static std::vector<ComponentCloneFunc>& GetComponentCloners();
+
+		// recomposes dirty local matrices, then propagates world matrices level by level,
+		// every level is split across worker threads, parents are always done before their children
+		void UpdateTransforms();
+		void UpdateSpatialIndex();
+
+		// destroys everything queued by DestroyEntity, render proxies are released with one frame queue submit
+		void FlushDestroyedEntities();
+		void QueueDestroy(entt::entity handle);
+
+		// false if the entity has nothing with bounds
+		bool HasBounds(entt::entity handle) const;
+		AABB ComputeBounds(entt::entity handle) const;
+
+		// order must have parents before their children
+		void WriteEntities(const std::filesystem::path& path, const std::vector<entt::entity>& order);
+
+		void InsertIntoLevel(Entity entity, uint32_t depth);
+		void RemoveFromLevel(Entity entity);
+
+	private:
+		// declared before the registry, transform components release their slots on destruction
+		TransformStore m_Transforms;
+
 		entt::registry m_Registry;
+		std::vector<entt::entity> m_DirtyTransforms;
+
+		SystemScheduler m_Systems;
+
+		// set while systems run, dirty lists can be written from several threads then
+		bool m_RunningSystems = false;
+		std::mutex m_DirtyMutex;
+
+		// entities bucketed by hierarchy depth, slots are kept next to the entities for the update
+		struct HierarchyLevel {
+			std::vector<entt::entity> Entities;
+			std::vector<uint32_t> Slots;
+			std::vector<uint32_t> ParentSlots;
+		};
+		std::vector<HierarchyLevel> m_HierarchyLevels;
+
+		// by transform slot, set for every world matrix changed during the update
+		std::vector<uint8_t> m_WorldChanged;
+
+		DynamicBVH m_SpatialIndex;
+		std::vector<entt::entity> m_DirtyBounds;
+
+		// by entity index
+		std::vector<uint32_t> m_SpatialProxies;
+
+		// parents can come after their children
+		std::vector<entt::entity> m_PendingDestroy;
+
+		// by entity index, set while the entity is in the destroy queue
+		std::vector<uint8_t> m_DestroyFlags;
 
 		std::vector<Entity> m_RootEntities;
 		std::vector<Entity> m_Entities;
-		std::unordered_map<UUID, Entity> m_EntityMap;
+		// by the id of the entity's hierarchy component
+		FlatIDMap<entt::entity> m_EntityMap;
 
 		RHIWorldProxy* m_Proxy;
+
+		friend class WorldLoader;
 	};
 }
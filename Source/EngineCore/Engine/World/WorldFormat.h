@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Spike {
+
+	// world file layout:
+	// header, chunk table, then chunks, every chunk and every column inside a chunk is 16 byte aligned
+	// entities are stored parents first, so a single pass over them can build the hierarchy
+
+	constexpr uint32_t WORLD_FILE_MAGIC = 0x444C5753; // "SWLD"
+	constexpr uint32_t WORLD_FILE_VERSION = 1;
+	constexpr uint32_t WORLD_FILE_ALIGNMENT = 16;
+	constexpr uint32_t WORLD_FILE_INVALID_INDEX = UINT32_MAX;
+
+	enum class EWorldChunkType : uint32_t {
+
+		ENone = 0,
+
+		// uint64 entity uuid [entities]
+		EEntityIDs,
+
+		// uint64 asset uuid [assets], every asset the world depends on
+		EAssetIDs,
+
+		// Vec3 position [entities], Vec3 euler rotation [entities], Vec3 scale [entities]
+		ETransform,
+
+		// uint32 parent index [entities], uint32 layer mask [entities], uint32 name offset [entities + 1], char names [total]
+		EHierarchy,
+
+		// uint32 entity index [count], uint32 mesh asset index [count], uint32 first material [count + 1], uint32 material asset index [total]
+		EStaticMesh,
+
+		// uint32 entity index [count], uint32 type [count], Vec4 color [count],
+		// then float columns [count] intensity, range, constant, linear, quadratic, inner cone cos, outer cone cos
+		ELight
+	};
+
+	struct WorldFileHeader {
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t NumEntities;
+		uint32_t NumChunks;
+	};
+
+	struct WorldChunkDesc {
+
+		EWorldChunkType Type;
+		uint32_t Count;
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	// partition index layout:
+	// header, then one entry per cell, every cell is a regular world file named by its coordinates
+
+	constexpr uint32_t WORLD_PARTITION_MAGIC = 0x49505753; // "SWPI"
+	constexpr uint32_t WORLD_PARTITION_VERSION = 1;
+
+	struct WorldPartitionHeader {
+
+		uint32_t Magic;
+		uint32_t Version;
+		float CellSize;
+		uint32_t NumCells;
+	};
+
+	struct WorldPartitionCellDesc {
+
+		int32_t X;
+		int32_t Z;
+	};
+
+	// appends aligned columns to a chunk
+	class WorldChunkWriter {
+	public:
+		WorldChunkWriter(EWorldChunkType type, uint32_t count) : m_Type(type), m_Count(count) {}
+
+		template<typename T>
+		void Column(const T* data, size_t count) {
+			size_t offset = m_Data.size();
+
+			m_Data.resize(AlignUp(offset + sizeof(T) * count));
+			if (count > 0) memcpy(m_Data.data() + offset, data, sizeof(T) * count);
+		}
+
+		template<typename T>
+		void Column(const std::vector<T>& data) { Column(data.data(), data.size()); }
+
+		EWorldChunkType GetType() const { return m_Type; }
+		uint32_t GetCount() const { return m_Count; }
+		const std::vector<uint8_t>& GetData() const { return m_Data; }
+
+		static size_t AlignUp(size_t value) { return (value + WORLD_FILE_ALIGNMENT - 1) & ~(size_t)(WORLD_FILE_ALIGNMENT - 1); }
+
+	private:
+		EWorldChunkType m_Type;
+		uint32_t m_Count;
+		std::vector<uint8_t> m_Data;
+	};
+
+	// reads columns in the order they were written, straight from the mapped file
+	class WorldChunkReader {
+	public:
+		WorldChunkReader() : m_Data(nullptr), m_Size(0), m_Offset(0), m_Count(0) {}
+		WorldChunkReader(const uint8_t* data, size_t size, uint32_t count) : m_Data(data), m_Size(size), m_Offset(0), m_Count(count) {}
+
+		// returns nullptr if the chunk is too small
+		template<typename T>
+		const T* Column(size_t count) {
+			size_t size = sizeof(T) * count;
+			if (!m_Data || m_Offset + size > m_Size) return nullptr;
+
+			const T* column = (const T*)(m_Data + m_Offset);
+			m_Offset = WorldChunkWriter::AlignUp(m_Offset + size);
+
+			return column;
+		}
+
+		bool Valid() const { return m_Data != nullptr; }
+		uint32_t GetCount() const { return m_Count; }
+
+	private:
+		const uint8_t* m_Data;
+		size_t m_Size;
+		size_t m_Offset;
+		uint32_t m_Count;
+	};
+}
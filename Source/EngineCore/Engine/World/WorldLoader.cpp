@@ -0,0 +1,311 @@
+#include <Engine/World/WorldLoader.h>
+#include <Engine/World/World.h>
+#include <Engine/World/Entity.h>
+#include <Engine/World/Components.h>
+#include <Engine/Core/Application.h>
+
+#include <chrono>
+
+namespace Spike {
+
+	WorldLoader::WorldLoader(const uint8_t* data, size_t size) : m_Stage(EStage::EInvalid), m_Cursor(0) {
+
+		if (Parse(data, size)) {
+			m_Stage = EStage::EAssets;
+		}
+	}
+
+	WorldLoader::WorldLoader(std::vector<uint8_t>&& data) : m_Stage(EStage::EInvalid), m_Cursor(0), m_Storage(std::move(data)) {
+
+		if (Parse(m_Storage.data(), m_Storage.size())) {
+			m_Stage = EStage::EAssets;
+		}
+	}
+
+	bool WorldLoader::Parse(const uint8_t* data, size_t size) {
+
+		if (!data || size < sizeof(WorldFileHeader)) {
+			ENGINE_ERROR("World file is too small!");
+			return false;
+		}
+
+		WorldFileHeader header{};
+		memcpy(&header, data, sizeof(WorldFileHeader));
+
+		if (header.Magic != WORLD_FILE_MAGIC || header.Version != WORLD_FILE_VERSION) {
+			ENGINE_ERROR("Unsupported world file, version: {}", header.Version);
+			return false;
+		}
+
+		if (sizeof(WorldFileHeader) + sizeof(WorldChunkDesc) * (size_t)header.NumChunks > size) {
+			ENGINE_ERROR("World file chunk table is corrupted!");
+			return false;
+		}
+
+		const WorldChunkDesc* descs = (const WorldChunkDesc*)(data + sizeof(WorldFileHeader));
+
+		auto findChunk = [&](EWorldChunkType type) {
+			for (uint32_t i = 0; i < header.NumChunks; i++) {
+				const WorldChunkDesc& desc = descs[i];
+
+				if (desc.Type == type && desc.Offset <= size && desc.Size <= size - desc.Offset) {
+					return WorldChunkReader(data + desc.Offset, desc.Size, desc.Count);
+				}
+			}
+			return WorldChunkReader();
+			};
+
+		m_NumEntities = header.NumEntities;
+
+		WorldChunkReader idChunk = findChunk(EWorldChunkType::EEntityIDs);
+		WorldChunkReader transformChunk = findChunk(EWorldChunkType::ETransform);
+		WorldChunkReader hierarchyChunk = findChunk(EWorldChunkType::EHierarchy);
+
+		m_EntityIDs = idChunk.Column<uint64_t>(m_NumEntities);
+
+		m_Positions = transformChunk.Column<Vec3>(m_NumEntities);
+		m_Rotations = transformChunk.Column<Vec3>(m_NumEntities);
+		m_Scales = transformChunk.Column<Vec3>(m_NumEntities);
+
+		m_Parents = hierarchyChunk.Column<uint32_t>(m_NumEntities);
+		m_LayerMasks = hierarchyChunk.Column<uint32_t>(m_NumEntities);
+		m_NameOffsets = hierarchyChunk.Column<uint32_t>((size_t)m_NumEntities + 1);
+		m_Names = m_NameOffsets ? hierarchyChunk.Column<char>(m_NameOffsets[m_NumEntities]) : nullptr;
+
+		if (!m_EntityIDs || !m_Positions || !m_Rotations || !m_Scales || !m_Parents || !m_LayerMasks || !m_Names) {
+			ENGINE_ERROR("World file is missing entity data!");
+			return false;
+		}
+
+		WorldChunkReader assetChunk = findChunk(EWorldChunkType::EAssetIDs);
+		m_NumAssets = assetChunk.GetCount();
+		m_AssetIDs = assetChunk.Column<uint64_t>(m_NumAssets);
+
+		if (m_NumAssets > 0 && !m_AssetIDs) {
+			ENGINE_ERROR("World file asset table is corrupted!");
+			return false;
+		}
+
+		// broken component chunks only drop those components, entities are still loaded
+		m_NumMeshes = 0;
+
+		WorldChunkReader meshChunk = findChunk(EWorldChunkType::EStaticMesh);
+		if (meshChunk.Valid() && meshChunk.GetCount() > 0) {
+			uint32_t count = meshChunk.GetCount();
+
+			m_MeshEntities = meshChunk.Column<uint32_t>(count);
+			m_MeshAssets = meshChunk.Column<uint32_t>(count);
+			m_FirstMaterials = meshChunk.Column<uint32_t>((size_t)count + 1);
+			m_MaterialAssets = m_FirstMaterials ? meshChunk.Column<uint32_t>(m_FirstMaterials[count]) : nullptr;
+
+			if (m_MeshEntities && m_MeshAssets && m_MaterialAssets) {
+				m_NumMeshes = count;
+			}
+			else {
+				ENGINE_ERROR("World file static mesh chunk is corrupted!");
+			}
+		}
+
+		m_NumLights = 0;
+
+		WorldChunkReader lightChunk = findChunk(EWorldChunkType::ELight);
+		if (lightChunk.Valid() && lightChunk.GetCount() > 0) {
+			uint32_t count = lightChunk.GetCount();
+
+			m_LightEntities = lightChunk.Column<uint32_t>(count);
+			m_LightTypes = lightChunk.Column<uint32_t>(count);
+			m_LightColors = lightChunk.Column<Vec4>(count);
+
+			bool valid = m_LightEntities && m_LightTypes && m_LightColors;
+
+			for (auto& column : m_LightFloats) {
+				column = lightChunk.Column<float>(count);
+				valid &= column != nullptr;
+			}
+
+			if (valid) {
+				m_NumLights = count;
+			}
+			else {
+				ENGINE_ERROR("World file light chunk is corrupted!");
+			}
+		}
+
+		return true;
+	}
+
+	Task<void> WorldLoader::LoadAssetsAsync() {
+		if (m_Stage != EStage::EAssets || HasAssets()) co_return;
+
+		m_Assets.resize(m_NumAssets);
+
+		// every asset is started before any is awaited, so their file reads overlap
+		JobCounter counter{};
+		counter.Add(m_NumAssets);
+
+		for (uint32_t i = 0; i < m_NumAssets; i++) {
+			LoadAssetInto(m_Assets[i], UUID(m_AssetIDs[i]), counter).Detach();
+		}
+
+		co_await WaitForJobs(counter, EThreadType::EMain);
+
+		// Step skips straight past the asset stage
+		m_Cursor = m_NumAssets;
+	}
+
+	Task<void> WorldLoader::LoadAssetInto(Ref<Asset>& out, UUID id, JobCounter& counter) {
+		out = co_await GRegistry->LoadAssetAsync(id);
+		counter.Done();
+	}
+
+	bool WorldLoader::Step(World* world, float budgetMs) {
+		using Clock = std::chrono::steady_clock;
+
+		if (m_Stage == EStage::EInvalid || m_Stage == EStage::EDone) return m_Stage == EStage::EDone;
+
+		Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(budgetMs));
+
+		// the clock is checked once per batch, a single entity is much cheaper than reading it
+		const uint32_t checkInterval = 32;
+		uint32_t sinceCheck = 0;
+
+		auto outOfTime = [&]() {
+			if (budgetMs <= 0.f || ++sinceCheck < checkInterval) return false;
+
+			sinceCheck = 0;
+			return Clock::now() >= end;
+			};
+
+		// every stage runs over its own range, the cursor is reset between them
+		auto runStage = [&](uint32_t count, EStage next, auto&& func) {
+			while (m_Cursor < count) {
+				func(m_Cursor++);
+				if (outOfTime()) return false;
+			}
+
+			m_Cursor = 0;
+			m_Stage = next;
+			return true;
+			};
+
+		if (m_Stage == EStage::EAssets) {
+
+			// resolve dependencies once, before any component references them
+			m_Assets.resize(m_NumAssets);
+
+			bool done = runStage(m_NumAssets, EStage::EEntities, [&](uint32_t i) {
+				m_Assets[i] = GRegistry->LoadAsset(UUID(m_AssetIDs[i]));
+
+				// asset loads are slow enough to check every time
+				sinceCheck = checkInterval;
+				});
+
+			if (!done) return false;
+			CreateHandles(world);
+		}
+
+		if (m_Stage == EStage::EEntities) {
+			if (!runStage(m_NumEntities, EStage::EMeshes, [&](uint32_t i) { BuildEntity(world, i); })) return false;
+
+			if (m_NumMeshes > 0) world->m_Registry.storage<StaticMeshComponent>().reserve(world->m_Registry.storage<StaticMeshComponent>().size() + m_NumMeshes);
+		}
+
+		if (m_Stage == EStage::EMeshes) {
+			if (!runStage(m_NumMeshes, EStage::ELights, [&](uint32_t i) { BuildMesh(world, i); })) return false;
+
+			if (m_NumLights > 0) world->m_Registry.storage<LightComponent>().reserve(world->m_Registry.storage<LightComponent>().size() + m_NumLights);
+		}
+
+		if (m_Stage == EStage::ELights) {
+			if (!runStage(m_NumLights, EStage::EDone, [&](uint32_t i) { BuildLight(world, i); })) return false;
+
+			// components hold their own references now
+			m_Assets.clear();
+			m_Assets.shrink_to_fit();
+		}
+
+		return true;
+	}
+
+	void WorldLoader::CreateHandles(World* world) {
+
+		// handles are created in bulk up front, entities are then filled in over as many steps as needed
+		m_Handles.resize(m_NumEntities);
+		world->m_Registry.create(m_Handles.begin(), m_Handles.end());
+
+		auto& transforms = world->m_Registry.storage<TransformComponent>();
+		auto& hierarchies = world->m_Registry.storage<HierarchyComponent>();
+
+		transforms.reserve(transforms.size() + m_NumEntities);
+		hierarchies.reserve(hierarchies.size() + m_NumEntities);
+		world->m_Transforms.Reserve(m_NumEntities);
+		world->m_DirtyTransforms.reserve(world->m_DirtyTransforms.size() + m_NumEntities);
+		world->m_Entities.reserve(world->m_Entities.size() + m_NumEntities);
+		world->m_EntityMap.Reserve(world->m_EntityMap.Size() + m_NumEntities);
+	}
+
+	void WorldLoader::BuildEntity(World* world, uint32_t i) {
+		Entity entity(world, m_Handles[i]);
+
+		auto& transform = entity.AddComponent<TransformComponent>();
+		transform.SetPosition(m_Positions[i]);
+		transform.SetRotation(m_Rotations[i]);
+		transform.SetScale(m_Scales[i]);
+
+		auto& hierarchy = entity.AddComponent<HierarchyComponent>(UUID(m_EntityIDs[i]), world);
+		hierarchy.m_LayerMask = m_LayerMasks[i];
+
+		// the same cell loaded twice, references keep pointing at the first copy
+		if (!world->m_EntityMap.Insert(m_EntityIDs[i], m_Handles[i])) {
+			ENGINE_WARN("Entity id {} is already used in the world!", m_EntityIDs[i]);
+		}
+
+		uint32_t nameStart = std::min(m_NameOffsets[i], m_NameOffsets[m_NumEntities]);
+		uint32_t nameEnd = std::clamp(m_NameOffsets[i + 1], nameStart, m_NameOffsets[m_NumEntities]);
+		hierarchy.m_Name.assign(m_Names + nameStart, m_Names + nameEnd);
+
+		// parents are stored first, anything else is treated as a root
+		uint32_t depth = 0;
+		if (m_Parents[i] < i) {
+			Entity parent(world, m_Handles[m_Parents[i]]);
+			auto& parentHierarchy = parent.GetComponent<HierarchyComponent>();
+
+			hierarchy.m_Parent = parent;
+			parentHierarchy.m_Children.push_back(entity);
+			depth = parentHierarchy.m_Depth + 1;
+		}
+		else {
+			world->m_RootEntities.push_back(entity);
+		}
+
+		world->InsertIntoLevel(entity, depth);
+		world->m_Entities.push_back(entity);
+	}
+
+	void WorldLoader::BuildMesh(World* world, uint32_t i) {
+		if (m_MeshEntities[i] >= m_NumEntities) return;
+
+		auto& mesh = Entity(world, m_Handles[m_MeshEntities[i]]).AddComponent<StaticMeshComponent>();
+
+		for (uint32_t m = m_FirstMaterials[i]; m < std::min(m_FirstMaterials[i + 1], m_FirstMaterials[m_NumMeshes]); m++) {
+			if (Ref<Material> mat = GetAsset(m_MaterialAssets[m]).As<Material>(); mat.Valid()) mesh.PushMaterial(mat);
+		}
+
+		if (Ref<Mesh> meshAsset = GetAsset(m_MeshAssets[i]).As<Mesh>(); meshAsset.Valid()) mesh.SetMesh(meshAsset);
+	}
+
+	void WorldLoader::BuildLight(World* world, uint32_t i) {
+		if (m_LightEntities[i] >= m_NumEntities) return;
+
+		auto& light = Entity(world, m_Handles[m_LightEntities[i]]).AddComponent<LightComponent>();
+		light.SetType((ELightType)m_LightTypes[i]);
+		light.SetColor(m_LightColors[i]);
+		light.SetIntensity(m_LightFloats[0][i]);
+		light.SetRange(m_LightFloats[1][i]);
+		light.SetLightConstant(m_LightFloats[2][i]);
+		light.SetLightLinear(m_LightFloats[3][i]);
+		light.SetLightQuadratic(m_LightFloats[4][i]);
+		light.SetInnerConeCos(m_LightFloats[5][i]);
+		light.SetOuterConeCos(m_LightFloats[6][i]);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Engine/World/WorldFormat.h>
+#include <Engine/Utils/MathUtils.h>
+#include <Engine/Asset/Asset.h>
+#include <entt/entt.hpp>
+
+namespace Spike {
+
+	class World;
+
+	// builds entities from a world file into an existing world, in steps that fit a time budget
+	// parsing doesn't touch the world, so a loader can be created on any thread, Step must be called on the main thread
+	// assets are loaded by the first Step unless LoadAssetsAsync already resolved them
+	class WorldLoader {
+	public:
+		// data must outlive the loader
+		WorldLoader(const uint8_t* data, size_t size);
+
+		// takes ownership of the file contents
+		WorldLoader(std::vector<uint8_t>&& data);
+
+		WorldLoader(const WorldLoader& other) = delete;
+		WorldLoader& operator=(const WorldLoader& other) = delete;
+
+		bool IsValid() const { return m_Stage != EStage::EInvalid; }
+		bool IsDone() const { return m_Stage == EStage::EDone; }
+
+		// loads every referenced asset through the registry at once, file reads run on workers
+		// has to be started on the main thread, Step must not be called before it finished
+		Task<void> LoadAssetsAsync();
+		bool HasAssets() const { return m_Stage != EStage::EAssets || m_Cursor == m_NumAssets; }
+
+		// continues building until everything is created or budgetMs runs out, 0 - no limit
+		// returns true once the loader is done
+		bool Step(World* world, float budgetMs = 0.f);
+
+		// created entities, parents always before their children
+		const std::vector<entt::entity>& GetEntities() const { return m_Handles; }
+		uint32_t GetNumEntities() const { return m_NumEntities; }
+
+	private:
+		bool Parse(const uint8_t* data, size_t size);
+
+		void CreateHandles(World* world);
+		void BuildEntity(World* world, uint32_t idx);
+		void BuildMesh(World* world, uint32_t idx);
+		void BuildLight(World* world, uint32_t idx);
+
+		static Task<void> LoadAssetInto(Ref<Asset>& out, UUID id, JobCounter& counter);
+
+		Ref<Asset> GetAsset(uint32_t idx) const { return idx < m_Assets.size() ? m_Assets[idx] : Ref<Asset>(); }
+
+	private:
+		enum class EStage : uint8_t {
+
+			EInvalid = 0,
+			EAssets,
+			EEntities,
+			EMeshes,
+			ELights,
+			EDone
+		};
+
+		EStage m_Stage;
+		uint32_t m_Cursor;
+
+		std::vector<uint8_t> m_Storage;
+
+		uint32_t m_NumEntities;
+		const uint64_t* m_EntityIDs;
+		const Vec3* m_Positions;
+		const Vec3* m_Rotations;
+		const Vec3* m_Scales;
+		const uint32_t* m_Parents;
+		const uint32_t* m_LayerMasks;
+		const uint32_t* m_NameOffsets;
+		const char* m_Names;
+
+		uint32_t m_NumAssets;
+		const uint64_t* m_AssetIDs;
+
+		uint32_t m_NumMeshes;
+		const uint32_t* m_MeshEntities;
+		const uint32_t* m_MeshAssets;
+		const uint32_t* m_FirstMaterials;
+		const uint32_t* m_MaterialAssets;
+
+		uint32_t m_NumLights;
+		const uint32_t* m_LightEntities;
+		const uint32_t* m_LightTypes;
+		const Vec4* m_LightColors;
+		const float* m_LightFloats[7];
+
+		std::vector<Ref<Asset>> m_Assets;
+		std::vector<entt::entity> m_Handles;
+	};
+}
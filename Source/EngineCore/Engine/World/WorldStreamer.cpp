@@ -0,0 +1,305 @@
+#include <Engine/World/WorldStreamer.h>
+#include <Engine/World/World.h>
+#include <Engine/World/Entity.h>
+#include <Engine/World/Components.h>
+#include <Engine/Serialization/FileStream.h>
+#include <Engine/Core/Log.h>
+
+#include <fstream>
+#include <chrono>
+#include <map>
+
+namespace Spike {
+
+	WorldStreamer::WorldStreamer(World* world, const WorldStreamerDesc& desc) : m_World(world), m_Desc(desc), m_CellSize(0.f), m_LoadsInFlight(0) {
+
+		if (!ReadIndex()) {
+			ENGINE_ERROR("Failed to read world partition at: {}", desc.Directory.string());
+		}
+	}
+
+	WorldStreamer::~WorldStreamer() {
+
+		// workers hold a pointer to the streamer until their load is handed over
+		GJobSystem->Wait(m_LoadCounter);
+	}
+
+	bool WorldStreamer::ReadIndex() {
+		std::filesystem::path path = GetIndexPath(m_Desc.Directory);
+
+		std::error_code error{};
+		uintmax_t fileSize = std::filesystem::file_size(path, error);
+		if (error || fileSize < sizeof(WorldPartitionHeader)) return false;
+
+		BinaryReadStream stream(path);
+		if (!stream.IsOpen()) return false;
+
+		WorldPartitionHeader header{};
+		stream >> header;
+
+		if (header.Magic != WORLD_PARTITION_MAGIC || header.Version != WORLD_PARTITION_VERSION || !(header.CellSize > 0.f)) return false;
+		if (sizeof(WorldPartitionHeader) + sizeof(WorldPartitionCellDesc) * (uintmax_t)header.NumCells > fileSize) return false;
+
+		m_Cells.resize(header.NumCells);
+		for (Cell& cell : m_Cells) {
+
+			WorldPartitionCellDesc desc{};
+			stream >> desc;
+
+			cell.Coord = Vec2Int(desc.X, desc.Z);
+			cell.State = ECellState::EUnloaded;
+			cell.Distance = FLT_MAX;
+		}
+
+		m_CellSize = header.CellSize;
+		return true;
+	}
+
+	uint32_t WorldStreamer::AddSource(const Vec3& position) {
+
+		for (uint32_t i = 0; i < (uint32_t)m_Sources.size(); i++) {
+			if (!m_Sources[i].Active) {
+				m_Sources[i] = StreamingSource{ position, true };
+				return i;
+			}
+		}
+
+		m_Sources.push_back(StreamingSource{ position, true });
+		return (uint32_t)m_Sources.size() - 1;
+	}
+
+	void WorldStreamer::SetSourcePosition(uint32_t source, const Vec3& position) {
+		m_Sources[source].Position = position;
+	}
+
+	void WorldStreamer::RemoveSource(uint32_t source) {
+		m_Sources[source].Active = false;
+	}
+
+	float WorldStreamer::GetDistance(const Cell& cell) const {
+		Vec2 min = Vec2(cell.Coord) * m_CellSize;
+		Vec2 max = min + Vec2(m_CellSize);
+
+		float distance = FLT_MAX;
+
+		// to the closest point of the cell on the ground plane, so big cells don't load late
+		for (const StreamingSource& source : m_Sources) {
+			if (!source.Active) continue;
+
+			Vec2 pos(source.Position.x, source.Position.z);
+			Vec2 delta = glm::max(glm::max(min - pos, pos - max), Vec2(0.f));
+
+			distance = std::min(distance, glm::length(delta));
+		}
+
+		return distance;
+	}
+
+	void WorldStreamer::ScheduleLoad(uint32_t cellIdx) {
+		Cell& cell = m_Cells[cellIdx];
+
+		cell.State = ECellState::ELoading;
+		m_LoadsInFlight++;
+
+		GJobSystem->Schedule([this, cellIdx, path = GetCellPath(m_Desc.Directory, cell.Coord)]() {
+			std::unique_ptr<WorldLoader> loader{};
+
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (file.is_open()) {
+
+				std::vector<uint8_t> data((size_t)file.tellg());
+				file.seekg(0);
+				file.read((char*)data.data(), data.size());
+
+				loader = std::make_unique<WorldLoader>(std::move(data));
+			}
+			else {
+				ENGINE_ERROR("Failed to open world cell at: {}", path.string());
+			}
+
+			std::lock_guard<std::mutex> lock(m_CompletedMutex);
+			m_CompletedLoads.emplace_back(cellIdx, std::move(loader));
+			}, &m_LoadCounter);
+	}
+
+	Task<void> WorldStreamer::ResolveAssets(std::shared_ptr<WorldLoader> loader) {
+		co_await loader->LoadAssetsAsync();
+	}
+
+	void WorldStreamer::Tick() {
+		using Clock = std::chrono::steady_clock;
+
+		Clock::time_point start = Clock::now();
+
+		auto remainingMs = [&]() {
+			return m_Desc.FrameBudgetMs - std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+			};
+
+		std::vector<std::pair<uint32_t, std::unique_ptr<WorldLoader>>> completed{};
+		{
+			std::lock_guard<std::mutex> lock(m_CompletedMutex);
+			completed.swap(m_CompletedLoads);
+		}
+
+		for (auto& [cellIdx, loader] : completed) {
+			Cell& cell = m_Cells[cellIdx];
+			m_LoadsInFlight--;
+
+			// a missing or corrupted file won't get better by reading it again
+			if (!loader || !loader->IsValid()) {
+				ENGINE_WARN("World cell ({}, {}) failed to load, it won't be retried", cell.Coord.x, cell.Coord.y);
+				cell.State = ECellState::EFailed;
+				continue;
+			}
+
+			// sources could have moved away while the file was loading
+			if (GetDistance(cell) > m_Desc.UnloadRadius) {
+				cell.State = ECellState::EUnloaded;
+				continue;
+			}
+
+			// assets are read on workers and created between frames, merging only builds entities
+			cell.Loader = std::move(loader);
+			cell.State = ECellState::EResolving;
+
+			ResolveAssets(cell.Loader).Detach();
+		}
+
+		// collect cells that have work to do, closest first
+		m_SortedCells.clear();
+
+		for (uint32_t i = 0; i < (uint32_t)m_Cells.size(); i++) {
+			Cell& cell = m_Cells[i];
+			cell.Distance = GetDistance(cell);
+
+			switch (cell.State)
+			{
+			case ECellState::EUnloaded:
+				if (cell.Distance < m_Desc.LoadRadius) m_SortedCells.push_back(i);
+				break;
+			case ECellState::ELoaded:
+				if (cell.Distance > m_Desc.UnloadRadius) {
+
+					// queued as one batch, the world destroys it on its next tick
+					m_World->DestroyEntities(cell.Entities);
+
+					cell.Entities.clear();
+					cell.Entities.shrink_to_fit();
+					cell.State = ECellState::EUnloaded;
+				}
+				break;
+			case ECellState::EResolving:
+				if (cell.Distance > m_Desc.UnloadRadius) {
+
+					// the resolve keeps its own reference and finishes on its own
+					cell.Loader.reset();
+					cell.State = ECellState::EUnloaded;
+				}
+				else if (cell.Loader->HasAssets()) {
+					cell.State = ECellState::EMerging;
+					m_SortedCells.push_back(i);
+				}
+				break;
+			case ECellState::EMerging:
+				m_SortedCells.push_back(i);
+				break;
+			default:
+				break;
+			}
+		}
+
+		std::sort(m_SortedCells.begin(), m_SortedCells.end(), [this](uint32_t a, uint32_t b) {
+			return m_Cells[a].Distance < m_Cells[b].Distance;
+			});
+
+		for (uint32_t cellIdx : m_SortedCells) {
+			Cell& cell = m_Cells[cellIdx];
+
+			if (cell.State == ECellState::EUnloaded) {
+				if (m_LoadsInFlight < m_Desc.MaxConcurrentLoads) ScheduleLoad(cellIdx);
+				continue;
+			}
+
+			float remaining = remainingMs();
+			if (remaining <= 0.f) continue;
+
+			if (cell.State == ECellState::EMerging) {
+
+				if (cell.Loader->Step(m_World, remaining)) {
+					cell.Entities = cell.Loader->GetEntities();
+					cell.Loader.reset();
+					cell.State = ECellState::ELoaded;
+				}
+			}
+		}
+	}
+
+	uint32_t WorldStreamer::GetNumLoadedCells() const {
+		uint32_t count = 0;
+
+		for (const Cell& cell : m_Cells) {
+			if (cell.State == ECellState::ELoaded) count++;
+		}
+		return count;
+	}
+
+	bool WorldStreamer::BuildPartition(World* world, const std::filesystem::path& directory, float cellSize) {
+		if (!(cellSize > 0.f)) return false;
+
+		std::error_code error{};
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			ENGINE_ERROR("Failed to create world partition directory at: {}", directory.string());
+			return false;
+		}
+
+		// ordered, so the same world always produces the same files
+		std::map<std::pair<int32_t, int32_t>, std::vector<Entity>> cells{};
+
+		for (Entity root : world->GetRootEntities()) {
+			if (!root) continue;
+
+			// roots have no parent, so the local position is the world one
+			Vec3 position = root.GetComponent<TransformComponent>().GetPosition();
+
+			int32_t x = (int32_t)std::floor(position.x / cellSize);
+			int32_t z = (int32_t)std::floor(position.z / cellSize);
+
+			cells[{ x, z }].push_back(root);
+		}
+
+		BinaryWriteStream stream(GetIndexPath(directory));
+		if (!stream.IsOpen()) {
+			ENGINE_ERROR("Failed to create world partition index at: {}", directory.string());
+			return false;
+		}
+
+		WorldPartitionHeader header{};
+		header.Magic = WORLD_PARTITION_MAGIC;
+		header.Version = WORLD_PARTITION_VERSION;
+		header.CellSize = cellSize;
+		header.NumCells = (uint32_t)cells.size();
+
+		stream << header;
+
+		for (auto& [coord, roots] : cells) {
+			world->SaveAs(GetCellPath(directory, Vec2Int(coord.first, coord.second)), roots);
+
+			WorldPartitionCellDesc desc{};
+			desc.X = coord.first;
+			desc.Z = coord.second;
+
+			stream << desc;
+		}
+
+		return true;
+	}
+
+	std::filesystem::path WorldStreamer::GetCellPath(const std::filesystem::path& directory, const Vec2Int& coord) {
+		return directory / ("Cell_" + std::to_string(coord.x) + "_" + std::to_string(coord.y) + ".world");
+	}
+
+	std::filesystem::path WorldStreamer::GetIndexPath(const std::filesystem::path& directory) {
+		return directory / "Partition.index";
+	}
+}
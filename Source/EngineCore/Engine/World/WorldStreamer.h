@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Engine/World/WorldLoader.h>
+#include <Engine/Multithreading/JobSystem.h>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+namespace Spike {
+
+	struct WorldStreamerDesc {
+
+		// folder written by WorldStreamer::BuildPartition
+		std::filesystem::path Directory;
+
+		// cells closer than LoadRadius to any source are loaded, cells further than UnloadRadius are unloaded,
+		// the gap between them keeps cells on the border from loading and unloading every frame
+		float LoadRadius = 256.f;
+		float UnloadRadius = 320.f;
+
+		// main thread time spent on merging and unloading cells per tick
+		float FrameBudgetMs = 2.f;
+
+		uint32_t MaxConcurrentLoads = 4;
+	};
+
+	// streams grid cells of a partitioned world in and out around streaming sources
+	// files are read and parsed on workers, assets are resolved through the registry before merging,
+	// entities are created on the main thread within the frame budget, unloaded cells are handed to the world as one destroy batch
+	// cells that fail to read or parse are not retried
+	class WorldStreamer {
+	public:
+		WorldStreamer(World* world, const WorldStreamerDesc& desc);
+		~WorldStreamer();
+
+		WorldStreamer(const WorldStreamer& other) = delete;
+		WorldStreamer& operator=(const WorldStreamer& other) = delete;
+
+		bool IsValid() const { return m_CellSize > 0.f; }
+
+		uint32_t AddSource(const Vec3& position);
+		void SetSourcePosition(uint32_t source, const Vec3& position);
+		void RemoveSource(uint32_t source);
+
+		// call once per frame on the main thread, before the world tick
+		void Tick();
+
+		uint32_t GetNumLoadedCells() const;
+
+		// splits the world into cells by the position of every root entity, whole subtrees go to the cell of their root
+		// writes one world file per non empty cell and the partition index into directory
+		static bool BuildPartition(World* world, const std::filesystem::path& directory, float cellSize);
+
+	private:
+		enum class ECellState : uint8_t {
+
+			EUnloaded = 0,
+			ELoading,
+			EResolving,
+			EMerging,
+			ELoaded,
+			EFailed
+		};
+
+		struct Cell {
+
+			Vec2Int Coord;
+			ECellState State;
+
+			// shared with the asset resolve, which can outlive the streamer
+			std::shared_ptr<WorldLoader> Loader;
+
+			std::vector<entt::entity> Entities;
+
+			// distance to the closest source, updated every tick
+			float Distance;
+		};
+
+		struct StreamingSource {
+
+			Vec3 Position;
+			bool Active;
+		};
+
+		bool ReadIndex();
+		void ScheduleLoad(uint32_t cellIdx);
+
+		static Task<void> ResolveAssets(std::shared_ptr<WorldLoader> loader);
+
+		float GetDistance(const Cell& cell) const;
+
+		static std::filesystem::path GetCellPath(const std::filesystem::path& directory, const Vec2Int& coord);
+		static std::filesystem::path GetIndexPath(const std::filesystem::path& directory);
+
+	private:
+		World* m_World;
+		WorldStreamerDesc m_Desc;
+		float m_CellSize;
+
+		std::vector<Cell> m_Cells;
+		std::vector<StreamingSource> m_Sources;
+
+		// cells by distance, reused between ticks
+		std::vector<uint32_t> m_SortedCells;
+
+		// parsed cells handed back by the workers
+		std::mutex m_CompletedMutex;
+		std::vector<std::pair<uint32_t, std::unique_ptr<WorldLoader>>> m_CompletedLoads;
+
+		JobCounter m_LoadCounter;
+		uint32_t m_LoadsInFlight;
+	};
+}
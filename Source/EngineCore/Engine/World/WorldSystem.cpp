@@ -0,0 +1,163 @@
+#include <Engine/World/WorldSystem.h>
+#include <Engine/World/Entity.h>
+#include <Engine/Multithreading/JobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Spike {
+
+	void SystemContext::Defer(std::function<void()>&& func) {
+		std::lock_guard<std::mutex> lock(m_DeferredMutex);
+		m_Deferred.push_back(std::move(func));
+	}
+
+	bool SystemContext::CanRead(entt::id_type type) const {
+		return CanWrite(type) || std::find(m_Desc.Reads.begin(), m_Desc.Reads.end(), type) != m_Desc.Reads.end();
+	}
+
+	bool SystemContext::CanWrite(entt::id_type type) const {
+		return m_Desc.Exclusive || std::find(m_Desc.Writes.begin(), m_Desc.Writes.end(), type) != m_Desc.Writes.end();
+	}
+
+	void SystemContext::RunDeferred() {
+		for (auto& func : m_Deferred) {
+			func();
+		}
+		m_Deferred.clear();
+	}
+
+	void SystemContext::ParallelFor(uint32_t count, uint32_t minBatch, const std::function<void(uint32_t first, uint32_t last)>& func) {
+		if (GJobSystem) {
+			GJobSystem->ParallelFor(count, minBatch, func);
+		}
+		else if (count > 0) {
+			func(0, count);
+		}
+	}
+
+	uint32_t SystemScheduler::Add(const SystemDesc& desc, SystemFunc&& func, World* world, entt::registry& registry) {
+		System& system = m_Systems.emplace_back();
+
+		system.ID = m_NextID++;
+		system.Func = std::move(func);
+		system.Context = std::make_unique<SystemContext>(world, registry, desc);
+		system.NumDependencies = 0;
+
+		for (auto storage : desc.Storages) {
+			storage(registry);
+		}
+
+		m_GraphDirty = true;
+		return system.ID;
+	}
+
+	void SystemScheduler::Remove(uint32_t id) {
+		auto it = std::find_if(m_Systems.begin(), m_Systems.end(), [id](const System& system) { return system.ID == id; });
+		if (it == m_Systems.end()) return;
+
+		// order matters for the graph, so no swap delete
+		m_Systems.erase(it);
+		m_GraphDirty = true;
+	}
+
+	bool SystemScheduler::Conflicts(const SystemDesc& a, const SystemDesc& b) {
+		auto intersects = [](const std::vector<entt::id_type>& x, const std::vector<entt::id_type>& y) {
+			for (entt::id_type type : x) {
+				if (std::find(y.begin(), y.end(), type) != y.end()) return true;
+			}
+			return false;
+			};
+
+		return intersects(a.Writes, b.Writes) || intersects(a.Writes, b.Reads) || intersects(a.Reads, b.Writes);
+	}
+
+	void SystemScheduler::BuildGraph() {
+		for (System& system : m_Systems) {
+			system.Dependents.clear();
+			system.NumDependencies = 0;
+		}
+
+		// edges only within a segment, exclusive systems split the list
+		uint32_t segmentStart = 0;
+
+		for (uint32_t j = 0; j < (uint32_t)m_Systems.size(); j++) {
+			if (m_Systems[j].GetDesc().Exclusive) {
+				segmentStart = j + 1;
+				continue;
+			}
+
+			for (uint32_t i = segmentStart; i < j; i++) {
+				if (!Conflicts(m_Systems[i].GetDesc(), m_Systems[j].GetDesc())) continue;
+
+				m_Systems[i].Dependents.push_back(j);
+				m_Systems[j].NumDependencies++;
+			}
+		}
+
+		m_GraphDirty = false;
+	}
+
+	void SystemScheduler::Run(float deltaTime) {
+		if (m_Systems.empty()) return;
+		if (m_GraphDirty) BuildGraph();
+
+		for (System& system : m_Systems) {
+			system.Context->m_DeltaTime = deltaTime;
+		}
+
+		uint32_t segmentStart = 0;
+
+		for (uint32_t i = 0; i <= (uint32_t)m_Systems.size(); i++) {
+			if (i < (uint32_t)m_Systems.size() && !m_Systems[i].GetDesc().Exclusive) continue;
+
+			RunParallel(segmentStart, i);
+
+			if (i < (uint32_t)m_Systems.size()) {
+				m_Systems[i].Func(*m_Systems[i].Context);
+			}
+			segmentStart = i + 1;
+		}
+
+		for (System& system : m_Systems) {
+			system.Context->RunDeferred();
+		}
+	}
+
+	void SystemScheduler::RunParallel(uint32_t first, uint32_t last) {
+		if (first >= last) return;
+
+		// without workers, registration order is already a valid order
+		if (!GJobSystem || GJobSystem->GetNumWorkers() == 0 || last - first == 1) {
+			for (uint32_t i = first; i < last; i++) {
+				m_Systems[i].Func(*m_Systems[i].Context);
+			}
+			return;
+		}
+
+		std::vector<std::atomic<uint32_t>> remaining(last - first);
+		for (uint32_t i = first; i < last; i++) {
+			remaining[i - first].store(m_Systems[i].NumDependencies, std::memory_order_relaxed);
+		}
+
+		JobCounter counter{};
+
+		// finishing a system starts every dependent it was the last dependency of
+		std::function<void(uint32_t)> schedule = [&](uint32_t idx) {
+			GJobSystem->Schedule([&, idx]() {
+				System& system = m_Systems[idx];
+				system.Func(*system.Context);
+
+				for (uint32_t dependent : system.Dependents) {
+					if (remaining[dependent - first].fetch_sub(1, std::memory_order_acq_rel) == 1) schedule(dependent);
+				}
+				}, &counter);
+			};
+
+		for (uint32_t i = first; i < last; i++) {
+			if (m_Systems[i].NumDependencies == 0) schedule(i);
+		}
+
+		GJobSystem->Wait(counter);
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <entt/entt.hpp>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cassert>
+
+namespace Spike {
+
+	class World;
+	class Entity;
+
+	// component types a system reads and writes, systems that don't write anything the other one touches run in parallel
+	struct SystemDesc {
+
+		std::string Name;
+
+		// creates or destroys entities, or touches anything outside its declared components,
+		// runs alone on the main thread, after every system registered before it and before every one after
+		bool Exclusive = false;
+
+		template<typename... Components>
+		SystemDesc& Read() { (AddAccess<Components>(Reads), ...); return *this; }
+
+		template<typename... Components>
+		SystemDesc& Write() { (AddAccess<Components>(Writes), ...); return *this; }
+
+		std::vector<entt::id_type> Reads;
+		std::vector<entt::id_type> Writes;
+
+		// views create their component pools on first use, which isn't safe from workers,
+		// so pools of every declared type are created up front on the main thread
+		std::vector<void(*)(entt::registry&)> Storages;
+
+	private:
+		template<typename T>
+		void AddAccess(std::vector<entt::id_type>& set) {
+			using Type = std::remove_const_t<T>;
+
+			set.push_back(entt::type_hash<Type>::value());
+			Storages.push_back([](entt::registry& registry) { registry.storage<Type>(); });
+		}
+	};
+
+	class SystemContext {
+	public:
+		SystemContext(World* world, entt::registry& registry, const SystemDesc& desc) 
+			: m_World(world), m_Registry(registry), m_Desc(desc), m_DeltaTime(0.f) {}
+
+		World* GetWorld() const { return m_World; }
+		float GetDeltaTime() const { return m_DeltaTime; }
+		const SystemDesc& GetDesc() const { return m_Desc; }
+
+		// func(Entity, Components&...) for every entity with all the components, big views are split across workers
+		// const components only need read access, transforms can be set, but entities must not be created or destroyed
+		// and setters talking to the renderer have to be deferred
+		template<typename... Components, typename Func>
+		void ForEach(Func&& func, uint32_t minBatch = 256);
+
+		// runs on the main thread once all systems of the tick are done, in system registration order
+		// for anything touching the world structure or the renderer, safe to call from several threads
+		void Defer(std::function<void()>&& func);
+
+	private:
+		bool CanRead(entt::id_type type) const;
+		bool CanWrite(entt::id_type type) const;
+
+		void RunDeferred();
+
+		// the calling thread takes part in the loop
+		static void ParallelFor(uint32_t count, uint32_t minBatch, const std::function<void(uint32_t first, uint32_t last)>& func);
+
+	private:
+		World* m_World;
+		entt::registry& m_Registry;
+		SystemDesc m_Desc;
+		float m_DeltaTime;
+
+		std::vector<entt::entity> m_Entities;
+
+		std::mutex m_DeferredMutex;
+		std::vector<std::function<void()>> m_Deferred;
+
+		friend class SystemScheduler;
+	};
+
+	// orders systems into a graph where every system waits for the earlier ones it conflicts with,
+	// systems are started on workers as soon as everything they wait for is done
+	class SystemScheduler {
+	public:
+		using SystemFunc = std::function<void(SystemContext&)>;
+
+		uint32_t Add(const SystemDesc& desc, SystemFunc&& func, World* world, entt::registry& registry);
+		void Remove(uint32_t id);
+
+		void Run(float deltaTime);
+
+		uint32_t GetNumSystems() const { return (uint32_t)m_Systems.size(); }
+
+	private:
+		struct System {
+
+			uint32_t ID;
+			SystemFunc Func;
+
+			// keeps the desc, owned through a pointer, so it stays in place while the list changes
+			std::unique_ptr<SystemContext> Context;
+
+			const SystemDesc& GetDesc() const { return Context->GetDesc(); }
+
+			// indices of later systems in the same exclusive segment that wait for this one
+			std::vector<uint32_t> Dependents;
+			uint32_t NumDependencies;
+		};
+
+		static bool Conflicts(const SystemDesc& a, const SystemDesc& b);
+
+		void BuildGraph();
+
+		// systems [first, last) without exclusive ones
+		void RunParallel(uint32_t first, uint32_t last);
+
+	private:
+		std::vector<System> m_Systems;
+		uint32_t m_NextID = 0;
+		bool m_GraphDirty = false;
+	};
+
+	template<typename... Components, typename Func>
+	void SystemContext::ForEach(Func&& func, uint32_t minBatch) {
+		static_assert(sizeof...(Components) > 0, "ForEach needs at least one component!");
+
+		assert(((std::is_const_v<Components> ? CanRead(entt::type_hash<std::remove_const_t<Components>>::value())
+			: CanWrite(entt::type_hash<Components>::value())) && ...) && "Component access wasn't declared by the system!");
+
+		auto view = m_Registry.view<Components...>();
+
+		// views over several pools can't be indexed, so the entities are gathered first
+		m_Entities.clear();
+		for (entt::entity handle : view) {
+			m_Entities.push_back(handle);
+		}
+
+		ParallelFor((uint32_t)m_Entities.size(), minBatch, [&](uint32_t first, uint32_t last) {
+			for (uint32_t i = first; i < last; i++) {
+				entt::entity handle = m_Entities[i];
+				func(Entity(m_World, handle), view.template get<Components>(handle)...);
+			}
+			});
+	}
+}
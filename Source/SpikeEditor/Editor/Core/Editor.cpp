@@ -40,6 +40,11 @@ namespace Spike {
 
 		m_EditorLayer = new EditorLayer();
 		PushLayer(m_EditorLayer);
+
+		// the viewport world ticks on a worker while the editor layer draws imgui
+		m_WorldLayer = new WorldLayer();
+		m_WorldLayer->SetWorld(m_EditorLayer->GetViewportWorld());
+		PushLayer(m_WorldLayer);
 	}
 
 	SpikeEditor::~SpikeEditor() { Destroy(); delete GRegistry; }
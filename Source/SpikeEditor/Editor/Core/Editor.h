@@ -2,6 +2,7 @@
 
 #include <Engine/Spike.h>
 #include <Editor/Layers/EditorLayer.h>
+#include <Engine/Layers/WorldLayer.h>
 
 namespace Spike {
 
@@ -15,6 +16,7 @@ namespace Spike {
 
 	private:
 		EditorLayer* m_EditorLayer;
+		WorldLayer* m_WorldLayer;
 		std::filesystem::path m_ProjectPath;
 
 		static SpikeEditor* s_Instance;
@@ -15,6 +15,9 @@ namespace Spike {
 		virtual void OnDetach() override;
 
 		virtual void OnEvent(const GenericEvent& event) override;
+
+		const Ref<World>& GetViewportWorld() const { return m_WorldViewport.GetWorld(); }
+
 	private:
 		void ConfigImGui();
 
@@ -21,7 +21,7 @@ namespace Spike {
 		{
 			auto it = m_LoadedAssets.find(id);
 			if (it != m_LoadedAssets.end()) {
-				return m_LoadedAssets[id];
+				return it->second;
 			}
 		}
 		{
@@ -35,21 +35,11 @@ namespace Spike {
 					return nullptr;
 				}
 
-				switch (it->second.Type)
-				{
-				case EAssetType::ETexture2D:
-					return Texture2D::Create(stream, id).As<Asset>();
-				case EAssetType::ECubeTexture:
-					return CubeTexture::Create(stream, id).As<Asset>();
-				case EAssetType::EMaterial:
-					//return LoadMaterial(it->second.Path, id);
-					assert(false);
-				case EAssetType::EMesh:
-					return Mesh::Create(stream, id).As<Asset>();
-				default:
-					ENGINE_ERROR("Invalid asset type: {}", (uint64_t)id);
-					return nullptr;
-				}
+				// cached, so every user of the asset shares the same gpu resources
+				Ref<Asset> asset = CreateAsset(it->second.Type, stream, id);
+				if (asset.Valid()) m_LoadedAssets[id] = asset;
+
+				return asset;
 			}
 			else {
 				ENGINE_ERROR("Invalid UUID to load: {}", (uint64_t)id);
@@ -58,6 +48,61 @@ namespace Spike {
 		}
 	}
 
+	Task<Ref<Asset>> EditorRegistry::LoadAssetAsync(UUID id) {
+
+		{
+			auto it = m_LoadedAssets.find(id);
+			if (it != m_LoadedAssets.end()) {
+				co_return it->second;
+			}
+		}
+
+		auto it = m_Registry.find(id);
+		if (it == m_Registry.end()) {
+			ENGINE_ERROR("Invalid UUID to load: {}", (uint64_t)id);
+			co_return nullptr;
+		}
+
+		AssetInfo info = it->second;
+		std::vector<uint8_t> data = co_await ReadFileAsync(SpikeEditor::Get().GetProjectPath() / info.Path, EThreadType::EMain);
+
+		if (data.empty()) {
+			ENGINE_ERROR("Failed to open asset binary from: {}", info.Path.string());
+			co_return nullptr;
+		}
+
+		// another load of the same asset could have finished while this one was reading
+		if (auto loaded = m_LoadedAssets.find(id); loaded != m_LoadedAssets.end()) {
+			co_return loaded->second;
+		}
+
+		BinaryReadStream stream(data.data(), data.size());
+
+		Ref<Asset> asset = CreateAsset(info.Type, stream, id);
+		if (asset.Valid()) m_LoadedAssets[id] = asset;
+
+		co_return asset;
+	}
+
+	Ref<Asset> EditorRegistry::CreateAsset(EAssetType type, BinaryReadStream& stream, UUID id) {
+
+		switch (type)
+		{
+		case EAssetType::ETexture2D:
+			return Texture2D::Create(stream, id).As<Asset>();
+		case EAssetType::ECubeTexture:
+			return CubeTexture::Create(stream, id).As<Asset>();
+		case EAssetType::EMaterial:
+			//return LoadMaterial(it->second.Path, id);
+			assert(false);
+		case EAssetType::EMesh:
+			return Mesh::Create(stream, id).As<Asset>();
+		default:
+			ENGINE_ERROR("Invalid asset type: {}", (uint64_t)id);
+			return nullptr;
+		}
+	}
+
 	void EditorRegistry::UnloadAsset(UUID id) {
 
 		auto it = m_LoadedAssets.find(id);
@@ -115,6 +160,9 @@ static void ProcessAssimpNode(aiNode* node, const aiScene* scene, const std::fil
 		aiMesh* sMesh = scene->mMeshes[node->mMeshes[s]];
 		SubMesh subMesh{};
 		{
+			// submeshes share the vertex buffer, their indices are offset past the previous ones
+			uint32_t baseVertex = (uint32_t)meshDesc.Vertices.size();
+
 			for (uint32_t i = 0; i < sMesh->mNumVertices; i++) {
 
 				Vertex v{};
@@ -162,7 +210,7 @@ static void ProcessAssimpNode(aiNode* node, const aiScene* scene, const std::fil
 
 				aiFace face = sMesh->mFaces[i];
 				for (uint32_t f = 0; f < face.mNumIndices; f++) { 
-					meshDesc.Indices.push_back(face.mIndices[f]);
+					meshDesc.Indices.push_back(baseVertex + face.mIndices[f]);
 					subMesh.IndexCount++; 
 				}
 			}
@@ -173,10 +221,18 @@ static void ProcessAssimpNode(aiNode* node, const aiScene* scene, const std::fil
 
 	// import a mesh asset
 	if (meshDesc.Vertices.size() > 0 && meshDesc.Indices.size() > 0 && meshDesc.SubMeshes.size() > 0) {
+		std::string name = node->mName.C_Str();
+
+		MeshOptimizeStats stats = OptimizeMesh(meshDesc);
+		ENGINE_INFO("Optimized mesh: {}, vertices: {} -> {}, ACMR: {:.3f} -> {:.3f}, ATVR: {:.3f} -> {:.3f}", name,
+			stats.VerticesBefore, stats.VerticesAfter, stats.Before.ACMR, stats.After.ACMR, stats.Before.ATVR, stats.After.ATVR);
+
+		GenerateMeshlets(meshDesc);
+		GenerateMeshLODs(meshDesc);
+
 		EditorRegistry::AssetInfo info{};
 		info.Type = EAssetType::EMesh;
 
-		std::string name = node->mName.C_Str();
 		name += ".asset";
 
 		info.Path = std::filesystem::path(path / name);
@@ -189,7 +245,7 @@ static void ProcessAssimpNode(aiNode* node, const aiScene* scene, const std::fil
 			ENGINE_ERROR("Failed to create mesh asset stream! Path: {}", fullPath.string());
 			return;
 		}
-		stream << MESH_MAGIC << meshDesc.Vertices << meshDesc.Indices << meshDesc.SubMeshes;
+		stream << MESH_MESHLETS_MAGIC << meshDesc.Vertices << meshDesc.Indices << meshDesc.SubMeshes << meshDesc.LODs << meshDesc.Meshlets;
 		Application::Get().DispatchEvent<AssetImportedEvent>(info);
 	}
 
@@ -322,7 +378,11 @@ static void CalculateTextureMipData(std::vector<size_t>& mipSizes, std::vector<V
 	}
 }
 
-void Spike::AssetImporter::ImportTexture2D(const std::filesystem::path& sourcePath, const std::filesystem::path& assetPath, Texture2DImportDesc desc) {
+// utility
+static Task<void> ImportTexture2DTask(std::filesystem::path sourcePath, std::filesystem::path assetPath, Texture2DImportDesc desc) {
+
+	// decoding is the slow part, keep it off the main thread
+	co_await ResumeOn(EThreadType::EWorker);
 
 	void* rawData;
 	int width, height, numChannels;
@@ -346,120 +406,123 @@ void Spike::AssetImporter::ImportTexture2D(const std::filesystem::path& sourcePa
 		break;
 	default:
 		ENGINE_ERROR("Unsupported texture format for import!");
-		return;
+		co_return;
 	}
 
 	if (!rawData) {
 		ENGINE_ERROR("Failed to load texture from: {}", sourcePath.string());
-		return;
+		co_return;
 	}
 
-	SUBMIT_RENDER_COMMAND(([=]() {
+	co_await ResumeOn(EThreadType::ERender);
 
-		Texture2DHeader header{};
-		header.Width = width;
-		header.Height = height;
-		header.Format = desc.Format;
-		header.Filter = desc.Filter;
-		header.AddressU = desc.AddressU;
-		header.AddressV = desc.AddressV;
+	Texture2DHeader header{};
+	header.Width = width;
+	header.Height = height;
+	header.Format = desc.Format;
+	header.Filter = desc.Filter;
+	header.AddressU = desc.AddressU;
+	header.AddressV = desc.AddressV;
 
-		SamplerDesc samplDesc{};
-		samplDesc.Filter = ESamplerFilter::EBilinear;
-		samplDesc.AddressU = ESamplerAddress::EClamp;
-		samplDesc.AddressV = ESamplerAddress::EClamp;
-		samplDesc.AddressW = ESamplerAddress::EClamp;
+	SamplerDesc samplDesc{};
+	samplDesc.Filter = ESamplerFilter::EBilinear;
+	samplDesc.AddressU = ESamplerAddress::EClamp;
+	samplDesc.AddressV = ESamplerAddress::EClamp;
+	samplDesc.AddressW = ESamplerAddress::EClamp;
 
-		uint32_t numMips = desc.MipMap ? GetNumTextureMips(header.Width, header.Height) : 1;
+	uint32_t numMips = desc.MipMap ? GetNumTextureMips(header.Width, header.Height) : 1;
 
-		Texture2DDesc stagingTexDesc{};
-		stagingTexDesc.Width = width;
-		stagingTexDesc.Height = height;
-		stagingTexDesc.NumMips = numMips;
-		stagingTexDesc.Format = stagingFormat;
-		stagingTexDesc.UsageFlags = ETextureUsageFlags::ECopySrc | ETextureUsageFlags::ECopyDst | ETextureUsageFlags::ESampled;
-		stagingTexDesc.SamplerDesc = samplDesc;
+	Texture2DDesc stagingTexDesc{};
+	stagingTexDesc.Width = width;
+	stagingTexDesc.Height = height;
+	stagingTexDesc.NumMips = numMips;
+	stagingTexDesc.Format = stagingFormat;
+	stagingTexDesc.UsageFlags = ETextureUsageFlags::ECopySrc | ETextureUsageFlags::ECopyDst | ETextureUsageFlags::ESampled;
+	stagingTexDesc.SamplerDesc = samplDesc;
 
-		RHITexture2D* stagingTex = new RHITexture2D(stagingTexDesc);
-		stagingTex->InitRHI();
-		{
-			RHIDevice::SubResourceCopyRegion region{ 0, 0, 0 };
-			GRHIDevice->CopyDataToTexture(rawData, 0, stagingTex, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRVCompute, { region }, (size_t)stagingTexDesc.Width * stagingTexDesc.Height * TextureFormatToSize(stagingTexDesc.Format));
-			stbi_image_free(rawData);
+	RHITexture2D* stagingTex = new RHITexture2D(stagingTexDesc);
+	stagingTex->InitRHI();
+	{
+		RHIDevice::SubResourceCopyRegion region{ 0, 0, 0 };
+		GRHIDevice->CopyDataToTexture(rawData, 0, stagingTex, EGPUAccessFlags::ENone, EGPUAccessFlags::ESRVCompute, { region }, (size_t)stagingTexDesc.Width * stagingTexDesc.Height * TextureFormatToSize(stagingTexDesc.Format));
+		stbi_image_free(rawData);
 
-			if (desc.MipMap) {
-				GRHIDevice->ImmediateSubmit([&](RHICommandBuffer* cmd) {
-					GRHIDevice->MipMapTexture2D(cmd, stagingTex, EGPUAccessFlags::ESRVCompute, EGPUAccessFlags::ESRVCompute, numMips);
-					});
-			}
+		if (desc.MipMap) {
+			GRHIDevice->ImmediateSubmit([&](RHICommandBuffer* cmd) {
+				GRHIDevice->MipMapTexture2D(cmd, stagingTex, EGPUAccessFlags::ESRVCompute, EGPUAccessFlags::ESRVCompute, numMips);
+				});
 		}
+	}
+
+	std::vector<size_t> mipSizes{};
+	std::vector<Vec2Uint> mipExtents{};
+	CalculateTextureMipData(mipSizes, mipExtents, header.ByteSize, numMips, header.Format, { header.Width, header.Height });
 
-		std::vector<size_t> mipSizes{};
-		std::vector<Vec2Uint> mipExtents{};
-		CalculateTextureMipData(mipSizes, mipExtents, header.ByteSize, numMips, header.Format, { header.Width, header.Height });
+	BufferDesc mipBuffDesc{};
+	mipBuffDesc.Size = header.ByteSize;
+	mipBuffDesc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopyDst;
+	mipBuffDesc.MemUsage = EBufferMemUsage::ECPUOnly;
 
-		BufferDesc mipBuffDesc{};
-		mipBuffDesc.Size = header.ByteSize;
-		mipBuffDesc.UsageFlags = EBufferUsageFlags::EStorage | EBufferUsageFlags::ECopyDst;
-		mipBuffDesc.MemUsage = EBufferMemUsage::ECPUOnly;
+	RHIBuffer* mipBuffer = new RHIBuffer(mipBuffDesc);
+	mipBuffer->InitRHI();
 
-		RHIBuffer* mipBuffer = new RHIBuffer(mipBuffDesc);
-		mipBuffer->InitRHI();
+	bool compress = (header.Format == ETextureFormat::ERGBBC1 || header.Format == ETextureFormat::ERGBABC3 || header.Format == ETextureFormat::ERGBC5);
+	if (compress) {
+		CompressTexture(mipBuffer, stagingTex, mipSizes, mipExtents, 1, desc.Format);
+	}
+	else {
 
-		bool compress = (header.Format == ETextureFormat::ERGBBC1 || header.Format == ETextureFormat::ERGBABC3 || header.Format == ETextureFormat::ERGBC5);
-		if (compress) {
-			CompressTexture(mipBuffer, stagingTex, mipSizes, mipExtents, 1, desc.Format);
-		}
-		else {
+		GRHIDevice->ImmediateSubmit([&](RHICommandBuffer* cmd) {
 
-			GRHIDevice->ImmediateSubmit([&](RHICommandBuffer* cmd) {
+			size_t outOffset = 0;
+			GRHIDevice->BarrierTexture(cmd, stagingTex, EGPUAccessFlags::ESRVCompute, EGPUAccessFlags::ECopySrc);
 
-				size_t outOffset = 0;
-				GRHIDevice->BarrierTexture(cmd, stagingTex, EGPUAccessFlags::ESRVCompute, EGPUAccessFlags::ECopySrc);
+			for (uint32_t m = 0; m < numMips; m++) {
 
-				for (uint32_t m = 0; m < numMips; m++) {
+				RHIDevice::SubResourceCopyRegion region{};
+				region.ArrayLayer = 0;
+				region.DataOffset = outOffset;
+				region.MipLevel = m;
 
-					RHIDevice::SubResourceCopyRegion region{};
-					region.ArrayLayer = 0;
-					region.DataOffset = outOffset;
-					region.MipLevel = m;
+				GRHIDevice->CopyFromTextureToCPU(cmd, stagingTex, region, mipBuffer);
+				GRHIDevice->BarrierBuffer(cmd, mipBuffer, mipBuffer->GetSize(), 0, EGPUAccessFlags::ECopyDst, EGPUAccessFlags::ECopyDst);
 
-					GRHIDevice->CopyFromTextureToCPU(cmd, stagingTex, region, mipBuffer);
-					GRHIDevice->BarrierBuffer(cmd, mipBuffer, mipBuffer->GetSize(), 0, EGPUAccessFlags::ECopyDst, EGPUAccessFlags::ECopyDst);
+				outOffset += mipSizes[m];
+			}
+			});
+	}
 
-					outOffset += mipSizes[m];
-				}
-				});
-		}
+	stagingTex->ReleaseRHIImmediate();
+	delete stagingTex;
 
-		stagingTex->ReleaseRHIImmediate();
-		delete stagingTex;
+	// output processed texture onto bin asset file
+	{
+		std::filesystem::path fullPath = SpikeEditor::Get().GetProjectPath() / assetPath;
 
-		// output processed texture onto bin asset file
-		{
-			std::filesystem::path fullPath = SpikeEditor::Get().GetProjectPath() / assetPath;
+		std::filesystem::create_directories(fullPath.parent_path());
+		BinaryWriteStream stream(fullPath);
 
-			std::filesystem::create_directories(fullPath.parent_path());
-			BinaryWriteStream stream(fullPath);
+		if (!stream.IsOpen()) {
+			ENGINE_ERROR("Failed to create asset file for texture: {}", fullPath.string());
+		}
+		else {
+			stream << TEXTURE_2D_MAGIC << header << mipSizes;
+			stream.WriteRaw(mipBuffer->GetMappedData(), mipBuffer->GetSize());
+		}
 
-			if (!stream.IsOpen()) {
-				ENGINE_ERROR("Failed to create asset file for texture: {}", fullPath.string());
-			}
-			else {
-				stream << TEXTURE_2D_MAGIC << header << mipSizes;
-				stream.WriteRaw(mipBuffer->GetMappedData(), mipBuffer->GetSize());
-			}
+		EditorRegistry::AssetInfo info{};
+		info.Type = EAssetType::ETexture2D;
+		info.Path = assetPath;
 
-			EditorRegistry::AssetInfo info{};
-			info.Type = EAssetType::ETexture2D;
-			info.Path = assetPath;
+		Application::Get().DispatchEvent<AssetImportedEvent>(info);
+	}
 
-			Application::Get().DispatchEvent<AssetImportedEvent>(info);
-		}
+	mipBuffer->ReleaseRHIImmediate();
+	delete mipBuffer;
+}
 
-		mipBuffer->ReleaseRHIImmediate();
-		delete mipBuffer;
-		}));
+void Spike::AssetImporter::ImportTexture2D(const std::filesystem::path& sourcePath, const std::filesystem::path& assetPath, Texture2DImportDesc desc) {
+	ImportTexture2DTask(sourcePath, assetPath, desc).Detach();
 }
 
 // utility
@@ -29,6 +29,7 @@ namespace Spike {
 		};
 
 		virtual Ref<Asset> LoadAsset(UUID id) override;
+		virtual Task<Ref<Asset>> LoadAssetAsync(UUID id) override;
 		virtual void UnloadAsset(UUID id) override;
 		virtual void Save() override;
 		virtual void Deserialize() override;
@@ -36,6 +37,9 @@ namespace Spike {
 		void ImportAsset(const AssetInfo& info);
 		void RemoveAsset(UUID id);
 
+	private:
+		Ref<Asset> CreateAsset(EAssetType type, BinaryReadStream& stream, UUID id);
+
 	private:
 		std::unordered_map<UUID, AssetInfo, UUID::Hasher> m_Registry;
 		std::unordered_map<UUID, Ref<Asset>, UUID::Hasher> m_LoadedAssets;
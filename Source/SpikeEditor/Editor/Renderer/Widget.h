@@ -34,6 +34,9 @@ namespace Spike {
 
 		void Tick(float deltaTime);
 
+		// ticked by the editor's world layer, the widget only renders it
+		const Ref<World>& GetWorld() const { return m_World; }
+
 	private:
 		Ref<World> m_World;
 		RHITexture2D* m_Output;
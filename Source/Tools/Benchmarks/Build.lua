@@ -0,0 +1,49 @@
+project "Benchmarks"
+    location "%{wks.location}/Source/Tools/Benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+	staticruntime "on"
+
+    targetdir ("%{wks.location}/Binaries/" .. outputDir .. "/%{prj.name}")
+	objdir ("%{wks.location}/Intermediate/" .. outputDir .. "/%{prj.name}")
+
+	files
+	{
+		"**.h",
+		"**.cpp"
+	}
+
+	includedirs
+	{
+        "%{IncludeDir.GLM}",
+		"",
+		"%{wks.location}/Source/EngineCore"
+	}
+
+	links
+	{
+		"EngineCore"
+	}
+
+	filter("system:windows")
+		systemversion "latest"
+		buildoptions "/utf-8"
+
+		defines
+		{
+			"ENGINE_PLATFORM_WINDOWS",
+			"GLM_FORCE_DEPTH_ZERO_TO_ONE"
+		}
+
+	filter "configurations:Debug"
+		defines "ENGINE_BUILD_DEBUG"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "ENGINE_BUILD_RELEASE"
+		optimize "on"
+
+	filter "configurations:Distribution"
+		defines "ENGINE_BUILD_DISTRIBUTION"
+		optimize "on"
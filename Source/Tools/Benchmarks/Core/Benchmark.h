@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+namespace Benchmarks {
+
+	// wall time of a single run in nanoseconds
+	template<typename F>
+	double Measure(F&& func) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	}
+
+	// best of a few runs, the first one warms caches and thread startup
+	template<typename F>
+	double MeasureBest(F&& func, int runs = 5) {
+		double best = Measure(func);
+		for (int i = 1; i < runs; i++) {
+			double time = Measure(func);
+			if (time < best) best = time;
+		}
+		return best;
+	}
+
+	void RunQueueBenchmarks();
+	void RunTransformBenchmarks();
+}
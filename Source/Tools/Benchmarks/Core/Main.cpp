@@ -0,0 +1,9 @@
+#include <Core/Benchmark.h>
+
+int main() {
+
+	Benchmarks::RunQueueBenchmarks();
+	Benchmarks::RunTransformBenchmarks();
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <Core/Benchmark.h>
+
+#include <Engine/Multithreading/MPMCQueue.h>
+#include <Engine/Utils/Misc.h>
+
+#include <functional>
+#include <thread>
+
+namespace Benchmarks {
+
+	// same shape as the application event queue, many producers and the main thread draining
+	static constexpr size_t NumEvents = 1 << 20;
+
+	template<typename PushFunc, typename DrainFunc>
+	static double RunProducers(uint32_t numProducers, PushFunc&& push, DrainFunc&& drain) {
+		return MeasureBest([&]() {
+			std::vector<std::thread> producers{};
+			size_t perProducer = NumEvents / numProducers;
+
+			for (uint32_t p = 0; p < numProducers; p++) {
+				producers.emplace_back([&]() {
+					for (size_t i = 0; i < perProducer; i++) {
+						push(std::function<void()>([]() {}));
+					}
+					});
+			}
+
+			size_t received = 0;
+			while (received < perProducer * numProducers) {
+				size_t count = drain();
+				if (count == 0) std::this_thread::yield();
+
+				received += count;
+			}
+
+			for (std::thread& thread : producers) {
+				thread.join();
+			}
+			}) / (double)NumEvents;
+	}
+
+	void RunQueueBenchmarks() {
+		std::printf("event queue, %zu events, ns per event\n", NumEvents);
+		std::printf("%-10s %-12s %-12s\n", "producers", "mpmc", "mutex");
+
+		for (uint32_t numProducers : { 1u, 4u, 16u }) {
+
+			Spike::MPMCQueue<std::function<void()>> ring{};
+			std::vector<std::function<void()>> ringOut{};
+
+			double ringTime = RunProducers(numProducers,
+				[&](std::function<void()>&& event) {
+					while (!ring.TryPush(std::move(event))) std::this_thread::yield();
+				},
+				[&]() {
+					size_t count = ring.PopBatch(ringOut, ring.GetCapacity());
+					for (auto& func : ringOut) func();
+					ringOut.clear();
+					return count;
+				});
+
+			Spike::ThreadSafeQueue<std::function<void()>> locked{};
+			std::vector<std::function<void()>> lockedOut{};
+
+			double lockedTime = RunProducers(numProducers,
+				[&](std::function<void()>&& event) {
+					locked.Push(std::move(event));
+				},
+				[&]() {
+					locked.PopAll(lockedOut);
+					size_t count = lockedOut.size();
+					for (auto& func : lockedOut) func();
+					lockedOut.clear();
+					return count;
+				});
+
+			std::printf("%-10u %-12.1f %-12.1f\n", numProducers, ringTime, lockedTime);
+		}
+	}
+}
@@ -0,0 +1,119 @@
+#include <Core/Benchmark.h>
+
+#include <Engine/Utils/SimdMath.h>
+
+#include <random>
+
+namespace Benchmarks {
+
+	using namespace Spike;
+
+	static float MaxError(const std::vector<Mat4x4>& a, const std::vector<Mat4x4>& b) {
+		float maxError = 0.f;
+		for (size_t i = 0; i < a.size(); i++) {
+			for (int c = 0; c < 4; c++) {
+				for (int r = 0; r < 4; r++) {
+					maxError = std::max(maxError, std::abs(a[i][c][r] - b[i][c][r]));
+				}
+			}
+		}
+		return maxError;
+	}
+
+	static void PrintRow(const char* name, uint32_t count, double scalarTime, double simdTime, float maxError) {
+		std::printf("%-20s %-10u %-12.2f %-12.2f %g\n", name, count, scalarTime / count, simdTime / count, maxError);
+	}
+
+	// two level hierarchy, the first half are roots and every other entity has one of them as parent
+	static void RunTransformBenchmark(uint32_t numTransforms) {
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+		std::vector<float> soaData(numTransforms * 10);
+		TransformSoA soa{};
+		float** arrays[] = { &soa.PositionX, &soa.PositionY, &soa.PositionZ, &soa.RotationX, &soa.RotationY, &soa.RotationZ, &soa.RotationW, &soa.ScaleX, &soa.ScaleY, &soa.ScaleZ };
+		for (uint32_t a = 0; a < 10; a++) {
+			*arrays[a] = soaData.data() + a * numTransforms;
+		}
+
+		std::vector<uint32_t> allSlots(numTransforms);
+		for (uint32_t i = 0; i < numTransforms; i++) {
+			Quaternion rotation = glm::normalize(Quaternion(dist(random), dist(random), dist(random), dist(random)));
+			float scale = 1.f + dist(random) * 0.5f;
+
+			soa.PositionX[i] = dist(random) * 100.f; soa.PositionY[i] = dist(random) * 100.f; soa.PositionZ[i] = dist(random) * 100.f;
+			soa.RotationX[i] = rotation.x; soa.RotationY[i] = rotation.y; soa.RotationZ[i] = rotation.z; soa.RotationW[i] = rotation.w;
+			soa.ScaleX[i] = scale; soa.ScaleY[i] = scale; soa.ScaleZ[i] = scale;
+
+			allSlots[i] = i;
+		}
+
+		// composition
+		std::vector<Mat4x4> scalarLocals(numTransforms), locals(numTransforms);
+
+		double scalarCompose = MeasureBest([&]() {
+			for (uint32_t i = 0; i < numTransforms; i++) {
+				Quaternion rotation(soa.RotationW[i], soa.RotationX[i], soa.RotationY[i], soa.RotationZ[i]);
+				scalarLocals[i] = glm::translate(Mat4x4(1.f), Vec3(soa.PositionX[i], soa.PositionY[i], soa.PositionZ[i]))
+					* glm::toMat4(rotation) * glm::scale(Mat4x4(1.f), Vec3(soa.ScaleX[i], soa.ScaleY[i], soa.ScaleZ[i]));
+			}
+			});
+
+		double simdCompose = MeasureBest([&]() {
+			SimdMath::ComposeTRS(soa, allSlots.data(), numTransforms, locals.data());
+			});
+
+		PrintRow("compose trs", numTransforms, scalarCompose, simdCompose, MaxError(scalarLocals, locals));
+
+		// parents
+		std::vector<Mat4x4> scalarWorlds(numTransforms), simdWorlds(numTransforms);
+		std::vector<uint32_t> slots{}, parents{};
+
+		// roots first so their worlds are ready when children read them
+		for (uint32_t i = 0; i < numTransforms / 2; i++) {
+			scalarWorlds[i] = simdWorlds[i] = locals[i];
+		}
+		for (uint32_t i = numTransforms / 2; i < numTransforms; i++) {
+			slots.push_back(i);
+			parents.push_back(random() % (numTransforms / 2));
+		}
+
+		uint32_t numChildren = (uint32_t)slots.size();
+
+		double scalarParents = MeasureBest([&]() {
+			for (uint32_t i = 0; i < numChildren; i++) {
+				scalarWorlds[slots[i]] = scalarWorlds[parents[i]] * locals[slots[i]];
+			}
+			});
+
+		double simdParents = MeasureBest([&]() {
+			SimdMath::MultiplyByParents(simdWorlds.data(), locals.data(), slots.data(), parents.data(), numChildren);
+			});
+
+		PrintRow("multiply by parents", numChildren, scalarParents, simdParents, MaxError(scalarWorlds, simdWorlds));
+
+		// inverse
+		std::vector<Mat4x4> scalarInverses(numTransforms), inverses(numTransforms);
+
+		double scalarInverse = MeasureBest([&]() {
+			for (uint32_t i = 0; i < numTransforms; i++) {
+				scalarInverses[i] = glm::inverse(simdWorlds[i]);
+			}
+			});
+
+		double simdInverse = MeasureBest([&]() {
+			SimdMath::InverseAffine(simdWorlds.data(), inverses.data(), numTransforms);
+			});
+
+		PrintRow("inverse affine", numTransforms, scalarInverse, simdInverse, MaxError(scalarInverses, inverses));
+	}
+
+	void RunTransformBenchmarks() {
+		std::printf("\ntransforms, simd width %u, ns per transform\n", SimdMath::GetBatchWidth());
+		std::printf("%-20s %-10s %-12s %-12s %s\n", "kernel", "count", "scalar", "simd", "max error");
+
+		for (uint32_t numTransforms : { 100000u, 1000000u }) {
+			RunTransformBenchmark(numTransforms);
+		}
+	}
+}
@@ -20,4 +20,5 @@ include "Source/ThirdParty/vk-bootstrap/Build.lua"
 -- Core
 include "Source/EngineCore/Build.lua"
 include "Source/SpikeEditor/Build.lua"
-include "Source/Tools/ShaderCompiler/Build.lua"
\ No newline at end of file
+include "Source/Tools/ShaderCompiler/Build.lua"
+include "Source/Tools/Benchmarks/Build.lua"
\ No newline at end of file